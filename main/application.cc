@@ -2,10 +2,14 @@
 #include "board.h"
 #include "display.h"
 #include "system_info.h"
-#include "ml307_ssl_transport.h"
 #include "audio_codec.h"
-#include "mqtt_protocol.h"
+#if CONFIG_CONNECTION_TYPE_WEBSOCKET
 #include "websocket_protocol.h"
+#elif CONFIG_CONNECTION_TYPE_LOOPBACK
+#include "loopback_protocol.h"
+#else
+#include "mqtt_protocol.h"
+#endif
 #include "font_awesome_symbols.h"
 #include "iot/thing_manager.h"
 #include "assets/lang_config.h"
@@ -13,9 +17,10 @@
 #include <cstring>
 #include <esp_log.h>
 #include <cJSON.h>
-#include <driver/gpio.h>
 #include <arpa/inet.h>
+#if !CONFIG_CONNECTION_TYPE_LOOPBACK
 #include <esp_app_desc.h>
+#endif
 
 #define TAG "Application"
 
@@ -35,7 +40,13 @@ static const char* const STATE_STRINGS[] = {
 };
 
 // 构造函数，初始化应用程序
-Application::Application() {
+// 解码队列按 Kconfig 配置的字节数一次性预分配，满时淘汰最旧的数据包
+Application::Application()
+    : audio_decode_queue_(CONFIG_AUDIO_DECODE_QUEUE_SIZE * 1024, AudioPacketRing::kOverflowDropOldest)
+#if CONFIG_USE_WAKE_WORD_DETECT
+    , uplink_backlog_(CONFIG_AUDIO_UPLINK_BACKLOG_SIZE * 1024, AudioPacketRing::kOverflowDropOldest)
+#endif
+{
     // 创建事件组，用于任务间通信
     event_group_ = xEventGroupCreate();
     // 创建后台任务，栈大小为4096 * 8字节
@@ -52,6 +63,22 @@ Application::Application() {
         .name = "clock_timer"
     };
     esp_timer_create(&clock_timer_args, &clock_timer_handle_);
+
+#if CONFIG_SPECULATIVE_PRECONNECT
+    // 预连接窗口定时器，到期后回到主循环释放未使用的连接
+    esp_timer_create_args_t preconnect_timer_args = {
+        .callback = [](void* arg) {
+            Application* app = (Application*)arg;
+            app->Schedule([app]() {
+                app->FinishPreConnect(false);
+            });
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "preconnect_timer"
+    };
+    esp_timer_create(&preconnect_timer_args, &preconnect_timer_);
+#endif
 }
 
 // 析构函数，释放资源
@@ -140,14 +167,11 @@ void Application::CheckNewVersion() {
                 codec->EnableInput(false);
                 // 关闭音频编解码器的输出功能，避免升级过程中有音频操作
                 codec->EnableOutput(false);
-                {
-                    // 使用互斥锁保护对音频解码队列的访问
-                    std::lock_guard<std::mutex> lock(mutex_);
-                    // 清空音频解码队列
-                    audio_decode_queue_.clear();
-                }
                 // 等待所有后台任务完成
                 background_task_->WaitForCompletion();
+                // 清空音频解码队列和播放缓冲区
+                audio_decode_queue_.Clear();
+                audio_player_->Clear();
                 // 删除后台任务对象
                 delete background_task_;
                 // 将后台任务指针置为 nullptr
@@ -320,18 +344,10 @@ void Application::PlaySound(const std::string_view& sound) {
 
         // 从 BinaryProtocol3 结构体中获取有效负载的大小，并将其从网络字节序转换为主机字节序
         auto payload_size = ntohs(p3->payload_size);
-        // 创建一个存储 Opus 音频数据的向量，并调整其大小以容纳有效负载
-        std::vector<uint8_t> opus;
-        opus.resize(payload_size);
-        // 将有效负载数据复制到 Opus 向量中
-        memcpy(opus.data(), p3->payload, payload_size);
+        // 将 Opus 音频数据直接拷贝进解码队列，等待后续解码和播放
+        audio_decode_queue_.Push(p3->payload, payload_size);  // 将音频数据加入解码队列
         // 指针向后移动有效负载的大小
         p += payload_size;
-
-        // 使用互斥锁保护对音频解码队列的访问，确保线程安全
-        std::lock_guard<std::mutex> lock(mutex_);
-        // 将 Opus 音频数据移动到音频解码队列中，等待后续解码和播放
-        audio_decode_queue_.emplace_back(std::move(opus));  // 将音频数据加入解码队列
     }
 }
 
@@ -430,9 +446,10 @@ void Application::Start() {
     // 设置 Opus 解码的采样率为音频编解码器的输出采样率
     opus_decode_sample_rate_ = codec->output_sample_rate();  // 设置解码采样率
     // 创建一个 Opus 解码器包装器对象，使用指定的解码采样率和单声道配置
-    opus_decoder_ = std::make_unique<OpusDecoderWrapper>(opus_decode_sample_rate_, 1);  // 创建Opus解码器
-    // 创建一个 Opus 编码器包装器对象，使用 16000Hz 采样率、单声道和指定的帧持续时间
-    opus_encoder_ = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS);  // 创建Opus编码器
+    opus_decoder_pool_ = std::make_unique<OpusDecoderPool>(codec->output_sample_rate(), CONFIG_OPUS_DECODER_POOL_SIZE);
+    opus_decoder_ = opus_decoder_pool_->Acquire(opus_decode_sample_rate_);  // 创建Opus解码器
+    // 创建上行 Opus 编码器，使用 16000Hz 采样率、单声道和指定的帧持续时间，编码时只读取帧池中的缓冲区
+    opus_encoder_ = std::make_unique<OpusFrameEncoder>(16000, 1, OPUS_FRAME_DURATION_MS);  // 创建Opus编码器
     // 根据开发板类型设置 Opus 编码器的复杂度
     // 对于 ML307 开发板，设置编码复杂度为 5 以节省带宽
     if (board.GetBoardType() == "ml307") {
@@ -449,11 +466,32 @@ void Application::Start() {
 
     // 如果音频编解码器的输入采样率不是 16000Hz，需要进行重采样处理
     if (codec->input_sample_rate() != 16000) {
-        // 配置输入重采样器，将输入采样率转换为 16000Hz
-        input_resampler_.Configure(codec->input_sample_rate(), 16000);
-        // 配置参考重采样器，将输入采样率转换为 16000Hz
-        reference_resampler_.Configure(codec->input_sample_rate(), 16000);
+        // 配置输入重采样器，将输入采样率转换为 16000Hz，双声道时参考通道一起处理
+        input_resampler_.Configure(codec->input_sample_rate(), 16000, codec->input_channels());
     }
+
+    // 按最大帧长预留采集缓冲区与帧池：一次采集的原始帧（默认与 AFE 喂入块对齐，含所有通道）与一个编码帧（16kHz 单声道）取较大者
+    size_t frame_samples = std::max<size_t>(AudioCodec::DefaultInputFrameSamples(codec->input_sample_rate()) * codec->input_channels(),
+        16000 / 1000 * OPUS_FRAME_DURATION_MS);
+    audio_frame_pool_.Initialize(CONFIG_AUDIO_FRAME_POOL_SIZE, frame_samples);
+    for (auto buffer : {&input_buffer_, &resampled_input_}) {
+        buffer->reserve(frame_samples);
+    }
+
+    // 创建播放缓冲区和 I2S 写入任务，缓冲低于解码领先量时触发下一次解码
+    audio_player_ = std::make_unique<AudioPlayer>(codec, CONFIG_AUDIO_DECODE_AHEAD_MS, CONFIG_AUDIO_PLAYBACK_PREBUFFER_MS);
+    audio_player_->OnLowWater([this]() {
+        ScheduleDecode();
+    });
+    // 播放缓冲区排空时检查 TTS 是否已经结束，状态切换放回主循环执行
+    audio_player_->OnDrained([this]() {
+        if (tts_stop_pending_) {
+            Schedule([this]() {
+                FinishSpeakingIfDrained();
+            });
+        }
+    });
+
     // 设置音频编解码器的输入就绪回调函数
     codec->OnInputReady([this, codec]() {
         // 用于标记是否有更高优先级的任务被唤醒
@@ -497,44 +535,59 @@ void Application::Start() {
 #ifdef CONFIG_CONNECTION_TYPE_WEBSOCKET
     // 创建 WebSocket 协议对象
     protocol_ = std::make_unique<WebsocketProtocol>();  // 使用WebSocket协议
+#elif CONFIG_CONNECTION_TYPE_LOOPBACK
+    // 本地回环协议，上行音频原样作为 TTS 下发，不需要服务器
+    protocol_ = std::make_unique<LoopbackProtocol>();
 #else
     // 创建 MQTT 协议对象
     protocol_ = std::make_unique<MqttProtocol>();  // 使用MQTT协议
 #endif
+    // 创建上行编码任务，编码后的数据包在编码任务中直接通过协议发送，不再经过主循环
+    audio_encoder_task_ = std::make_unique<AudioEncoderTask>(opus_encoder_.get(), &audio_frame_pool_,
+        CONFIG_AUDIO_ENCODER_QUEUE_SIZE, CONFIG_AUDIO_ENCODER_TASK_CORE);
+    audio_encoder_task_->OnPacket([this](const std::vector<uint8_t>& opus, int64_t capture_time_us) {
+#if CONFIG_USE_WAKE_WORD_DETECT
+        // 唤醒后音频通道尚未打开，数据包先排队；加锁后再确认一次，保证与排空时的发送顺序一致
+        if (uplink_buffering_) {
+            std::lock_guard<std::mutex> lock(uplink_backlog_mutex_);
+            if (uplink_buffering_) {
+                uplink_backlog_.Push(opus.data(), opus.size(), capture_time_us);
+                return;
+            }
+        }
+#endif
+        protocol_->SendAudio(opus, capture_time_us);
+    });
     // 设置协议对象的网络错误回调函数
     protocol_->OnNetworkError([this](const std::string& message) {
-        // 当发生网络错误时，将设备状态设置为空闲状态
-        SetDeviceState(kDeviceStateIdle);  // 设置为空闲状态
-        // 弹出警告框，显示错误信息
-        Alert(Lang::Strings::ERROR, message.c_str(), "sad", Lang::Sounds::P3_EXCLAMATION);  // 显示错误信息
+        // 音频通道可能在独立任务中打开，统一回到主循环中切换状态
+        Schedule([this, message]() {
+            // 当发生网络错误时，将设备状态设置为空闲状态
+            SetDeviceState(kDeviceStateIdle);  // 设置为空闲状态
+            // 弹出警告框，显示错误信息
+            Alert(Lang::Strings::ERROR, message.c_str(), "sad", Lang::Sounds::P3_EXCLAMATION);  // 显示错误信息
+        });
     });
     // 设置协议对象的音频数据接收回调函数
     protocol_->OnIncomingAudio([this](std::vector<uint8_t>&& data) {
-        // 使用互斥锁保护对音频解码队列的访问
-        std::lock_guard<std::mutex> lock(mutex_);
         // 当设备处于说话状态时，将接收到的音频数据加入解码队列
+        // 解码队列的生产端不与 Schedule 共用 mutex_，网络回调不会被主任务队列阻塞
+        // 空数据包表示抖动缓冲区判定该帧丢失，同样入队，解码时执行丢包补偿
         if (device_state_ == kDeviceStateSpeaking) {
-            audio_decode_queue_.emplace_back(std::move(data));  // 将音频数据加入解码队列
+            audio_decode_queue_.Push(data.data(), data.size(), esp_timer_get_time());  // 将音频数据加入解码队列，附带收包时间
+            // 立即触发解码，首包不必等待下一次 I2S 输出就绪事件
+            ScheduleDecode();
         }
     });
-    // 设置协议对象的音频通道打开回调函数
-    protocol_->OnAudioChannelOpened([this, codec, &board]() {
-        // 当音频通道打开时，关闭设备的省电模式
-        board.SetPowerSaveMode(false);  // 关闭省电模式
-        // 检查服务器的采样率和设备的输出采样率是否一致
-        if (protocol_->server_sample_rate() != codec->output_sample_rate()) {
-            // 如果不一致，记录警告日志，提示可能会因重采样导致失真
-            ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
-                protocol_->server_sample_rate(), codec->output_sample_rate());
+    // 设置协议对象的音频通道打开回调函数，在调用 OpenAudioChannel 的任务中执行
+    protocol_->OnAudioChannelOpened([this]() {
+#if CONFIG_USE_WAKE_WORD_DETECT
+        // 唤醒后的通道在 open_channel 任务中打开，由主循环中的 OnWakeWordChannelOpened 处理
+        if (channel_opening_async_) {
+            return;
         }
-        // 设置 Opus 解码的采样率为服务器的采样率
-        SetDecodeSampleRate(protocol_->server_sample_rate());  // 设置解码采样率
-        // 清空上次的 IoT 设备状态信息
-        last_iot_states_.clear();
-        // 获取 IoT 设备管理器的单例对象
-        auto& thing_manager = iot::ThingManager::GetInstance();
-        // 发送 IoT 设备的描述信息到服务器
-        protocol_->SendIotDescriptors(thing_manager.GetDescriptorsJson());
+#endif
+        OnAudioChannelOpened();
     });
     // 设置协议对象的音频通道关闭回调函数
     protocol_->OnAudioChannelClosed([this, &board]() {
@@ -551,108 +604,16 @@ void Application::Start() {
         });
     });
     // 设置协议对象的 JSON 数据接收回调函数
-    protocol_->OnIncomingJson([this, display](const cJSON* root) {
-        // 从 JSON 数据中获取 "type" 字段的值
-        auto type = cJSON_GetObjectItem(root, "type");
-        // 处理文本转语音（TTS）类型的 JSON 数据
-        if (strcmp(type->valuestring, "tts") == 0) {  // 文本转语音
-            // 从 JSON 数据中获取 "state" 字段的值
-            auto state = cJSON_GetObjectItem(root, "state");
-            // 处理 TTS 开始状态
-            if (strcmp(state->valuestring, "start") == 0) {
-                // 安排一个任务来处理 TTS 开始事件
-                Schedule([this]() {
-                    // 标记未中止说话
-                    aborted_ = false;
-                    // 如果设备处于空闲状态或监听状态，将设备状态设置为说话状态
-                    if (device_state_ == kDeviceStateIdle || device_state_ == kDeviceStateListening) {
-                        SetDeviceState(kDeviceStateSpeaking);  // 设置为说话状态
-                    }
-                });
-            } 
-            // 处理 TTS 停止状态
-            else if (strcmp(state->valuestring, "stop") == 0) {
-                // 安排一个任务来处理 TTS 停止事件
-                Schedule([this]() {
-                    // 如果设备处于说话状态
-                    if (device_state_ == kDeviceStateSpeaking) {
-                        // 等待后台任务完成
-                        background_task_->WaitForCompletion();  // 等待后台任务完成
-                        // 如果需要继续监听
-                        if (keep_listening_) {
-                            // 发送开始监听的请求
-                            protocol_->SendStartListening(kListeningModeAutoStop);  // 开始监听
-                            // 将设备状态设置为监听状态
-                            SetDeviceState(kDeviceStateListening);  // 设置为监听状态
-                        } else {
-                            // 将设备状态设置为空闲状态
-                            SetDeviceState(kDeviceStateIdle);  // 设置为空闲状态
-                        }
-                    }
-                });
-            } 
-            // 处理 TTS 句子开始状态
-            else if (strcmp(state->valuestring, "sentence_start") == 0) {
-                // 从 JSON 数据中获取 "text" 字段的值
-                auto text = cJSON_GetObjectItem(root, "text");
-                // 如果 "text" 字段存在
-                if (text != NULL) {
-                    // 记录日志，显示接收到的文本信息
-                    ESP_LOGI(TAG, "<< %s", text->valuestring);
-                    // 安排一个任务来显示助手的聊天消息
-                    Schedule([this, display, message = std::string(text->valuestring)]() {
-                        display->SetChatMessage("assistant", message.c_str());  // 显示助手消息
-                    });
-                }
-            }
-        } 
-        // 处理语音转文本（STT）类型的 JSON 数据
-        else if (strcmp(type->valuestring, "stt") == 0) {  // 语音转文本
-            // 从 JSON 数据中获取 "text" 字段的值
-            auto text = cJSON_GetObjectItem(root, "text");
-            // 如果 "text" 字段存在
-            if (text != NULL) {
-                // 记录日志，显示接收到的文本信息
-                ESP_LOGI(TAG, ">> %s", text->valuestring);
-                // 安排一个任务来显示用户的聊天消息
-                Schedule([this, display, message = std::string(text->valuestring)]() {
-                    display->SetChatMessage("user", message.c_str());  // 显示用户消息
-                });
-            }
-        } 
-        // 处理大语言模型（LLM）类型的 JSON 数据
-        else if (strcmp(type->valuestring, "llm") == 0) {  // 大语言模型
-            // 从 JSON 数据中获取 "emotion" 字段的值
-            auto emotion = cJSON_GetObjectItem(root, "emotion");
-            // 如果 "emotion" 字段存在
-            if (emotion != NULL) {
-                // 安排一个任务来设置显示设备的表情状态
-                Schedule([this, display, emotion_str = std::string(emotion->valuestring)]() {
-                    display->SetEmotion(emotion_str.c_str());  // 设置表情
-                });
-            }
-        } 
-        // 处理 IoT 设备类型的 JSON 数据
-        else if (strcmp(type->valuestring, "iot") == 0) {  // IoT设备
-            // 从 JSON 数据中获取 "commands" 字段的值
-            auto commands = cJSON_GetObjectItem(root, "commands");
-            // 如果 "commands" 字段存在
-            if (commands != NULL) {
-                // 获取 IoT 设备管理器的单例对象
-                auto& thing_manager = iot::ThingManager::GetInstance();
-                // 遍历命令数组
-                for (int i = 0; i < cJSON_GetArraySize(commands); ++i) {
-                    // 获取数组中的每个命令
-                    auto command = cJSON_GetArrayItem(commands, i);
-                    // 调用 IoT 设备管理器执行命令
-                    thing_manager.Invoke(command);  // 执行IoT命令
-                }
-            }
-        }
+    protocol_->OnIncomingJson([this](const JsonObject& root) {
+        OnIncomingMessage(root);
     });
     // 启动协议对象，使其开始工作
     protocol_->Start();  // 启动协议
 
+#if CONFIG_CONNECTION_TYPE_LOOPBACK
+    // 回环模式没有服务器，跳过版本检查与激活，直接进入空闲状态
+    SetDeviceState(kDeviceStateIdle);
+#else
     // 检查新固件版本或获取MQTT代理地址
     // 设置 OTA（Over-the-Air）更新检查的版本 URL
     ota_.SetCheckVersionUrl(CONFIG_OTA_VERSION_URL);
@@ -677,35 +638,83 @@ void Application::Start() {
         // 删除当前任务
         vTaskDelete(NULL);
     }, "check_new_version", 4096 * 2, this, 2, nullptr);
+#endif
 
 #if CONFIG_USE_AUDIO_PROCESSOR
+    // 处理后音频的输出回调，共享前端模式下设置给唤醒词检测的 AFE
+    auto on_afe_output = [this](const std::vector<int16_t>& data) {
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+        // 持续静音时不编码也不发送，本帧存入预录；闸门关闭时通知服务端
+        auto action = uplink_gate_.Process(data);
+        if (action == UplinkGate::kActionGate || action == UplinkGate::kActionClose) {
+            afe_traces_.Consume(data.size(), [](LatencyTrace& trace) {});
+            if (action == UplinkGate::kActionClose) {
+                Schedule([this]() {
+                    if (device_state_ == kDeviceStateListening) {
+                        protocol_->SendSilenceMarker();
+                    }
+                });
+            }
+            return;
+        }
+#endif
+        // 从帧池取一帧拷贝处理后的数据，池耗尽时丢弃本帧
+        auto frame = audio_frame_pool_.Acquire();
+        if (frame == nullptr) {
+            return;
+        }
+        frame->pcm.assign(data.begin(), data.end());
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+        if (action == UplinkGate::kActionOpen) {
+            // 重新检测到人声，预录放在本帧之前一起发送
+            uplink_gate_.TakePreroll(frame->pcm);
+        }
+#endif
+        // 取回本帧首个样本所在输入帧的时延记录
+        frame->trace = LatencyTrace();
+        afe_traces_.Consume(data.size(), [frame](LatencyTrace& trace) {
+            if (frame->trace.origin_us == 0) {
+                frame->trace = trace;
+                frame->trace.Stamp(kLatencyAfeFetch);
+            }
+        });
+        // 交给上行编码任务，队列已满时帧会被归还并计数
+        audio_encoder_task_->Push(frame);
+    };
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+    uplink_gate_.Configure(16000, CONFIG_AUDIO_UPLINK_GATE_PREROLL_MS, CONFIG_AUDIO_UPLINK_GATE_HANGOVER_MS);
+#endif
+#if !CONFIG_USE_SHARED_AUDIO_FRONTEND
     // 如果配置了使用音频处理器，则进行初始化
     // 初始化音频处理器，传入音频输入通道数和输入参考信息
     audio_processor_.Initialize(codec->input_channels(), codec->input_reference());
     // 设置音频处理器的输出回调函数
-    audio_processor_.OnOutput([this](std::vector<int16_t>&& data) {
-        // 安排一个后台任务来处理音频处理器的输出数据
-        background_task_->Schedule([this, data = std::move(data)]() mutable {
-            // 使用 Opus 编码器对音频数据进行编码
-            opus_encoder_->Encode(std::move(data), [this](std::vector<uint8_t>&& opus) {
-                // 安排一个任务来发送编码后的音频数据
-                Schedule([this, opus = std::move(opus)]() {
-                    // 通过协议对象发送编码后的音频数据
-                    protocol_->SendAudio(opus);  // 发送音频数据
-                });
-            });
-        });
-    });
+    audio_processor_.OnOutput(on_afe_output);
+#endif
 #endif
 
 #if CONFIG_USE_WAKE_WORD_DETECT
     // 如果配置了使用唤醒词检测，则进行初始化
     // 初始化唤醒词检测模块，传入音频输入通道数和输入参考信息
     wake_word_detect_.Initialize(codec->input_channels(), codec->input_reference());
+#if CONFIG_USE_SHARED_AUDIO_FRONTEND
+    // 共享前端：语音通信不再单独创建 AFE，监听状态下直接取唤醒词检测 AFE 的输出
+    wake_word_detect_.OnOutput(on_afe_output);
+#endif
     // 设置唤醒词检测模块的语音活动检测（VAD）状态变化回调函数
     wake_word_detect_.OnVadStateChange([this](bool speaking) {
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+        // 闸门在 AFE 输出任务中逐帧判断，直接更新，不经过主循环
+        uplink_gate_.SetVoiceActive(speaking);
+#endif
         // 安排一个任务来处理 VAD 状态变化事件
         Schedule([this, speaking]() {
+#if CONFIG_SPECULATIVE_PRECONNECT
+            // 空闲时检测到人声，可能紧接着就是唤醒词
+            if (speaking && device_state_ == kDeviceStateIdle) {
+                StartPreConnect();
+            }
+#endif
             // 当设备处于监听状态时
             if (device_state_ == kDeviceStateListening) {
                 // 如果检测到正在说话
@@ -733,31 +742,21 @@ void Application::Start() {
             if (device_state_ == kDeviceStateIdle) {
                 // 将设备状态设置为连接状态
                 SetDeviceState(kDeviceStateConnecting);  // 设置为连接状态
-                // 对唤醒词数据进行编码
-                wake_word_detect_.EncodeWakeWordData();  // 编码唤醒词数据
+                // 封存预录，预录在后台已持续编码
+                wake_word_detect_.EncodeWakeWordData();
 
-                // 尝试打开音频通道，如果打开失败
-                if (!protocol_->OpenAudioChannel()) {  // 打开音频通道
-                    // 重新开始唤醒词检测
-                    wake_word_detect_.StartDetection();  // 开始检测
-                    return;
-                }
-                
-                // 用于存储编码后的唤醒词音频数据
-                std::vector<uint8_t> opus;
-                // 循环获取编码后的唤醒词音频数据并发送到服务器
-                while (wake_word_detect_.GetWakeWordOpus(opus)) {
-                    // 通过协议对象发送编码后的音频数据
-                    protocol_->SendAudio(opus);
+                // 连接和等待 hello 期间继续采集编码，上行数据包先在本地排队，通道打开后与预录一起发出
+                {
+                    std::lock_guard<std::mutex> lock(uplink_backlog_mutex_);
+                    uplink_backlog_.Clear();
+                    uplink_buffering_ = true;
                 }
-                // 向服务器发送唤醒词检测到的消息
-                protocol_->SendWakeWordDetected(wake_word);
-                // 记录日志，显示检测到的唤醒词
-                ESP_LOGI(TAG, "Wake word detected: %s", wake_word.c_str());
-                // 标记需要继续监听
-                keep_listening_ = true;
-                // 将设备状态设置为监听状态
-                SetDeviceState(kDeviceStateListening);  // 设置为监听状态
+                uplink_started_early_ = true;
+                StartUplinkCapture();
+                pending_wake_word_ = wake_word;
+                // 通道打开后由 OnWakeWordChannelOpened 发送数据并恢复唤醒词检测
+                OpenAudioChannelAsync();
+                return;
             } 
             // 如果设备当前处于说话状态
             else if (device_state_ == kDeviceStateSpeaking) {
@@ -778,12 +777,194 @@ void Application::Start() {
     wake_word_detect_.StartDetection();  // 开始唤醒词检测
 #endif
 
+#if CONFIG_AUDIO_CAPTURE_FRAME_MS == 0 && (CONFIG_USE_AUDIO_PROCESSOR || CONFIG_USE_WAKE_WORD_DETECT)
+    // 按实际创建的 AFE 校正采集帧长，每次读取正好喂入一块（喂入块按 16kHz 计，换算到输入采样率）
+#if CONFIG_USE_AUDIO_PROCESSOR && !CONFIG_USE_SHARED_AUDIO_FRONTEND
+    size_t feed_size = audio_processor_.GetFeedSize();
+#else
+    size_t feed_size = wake_word_detect_.GetFeedSize();
+#endif
+    int capture_frame_samples = feed_size * codec->input_sample_rate() / 16000;
+    if (capture_frame_samples != AudioCodec::DefaultInputFrameSamples(codec->input_sample_rate())) {
+        ESP_LOGW(TAG, "AFE feed chunk %zu does not match the I2S DMA frame, capture reads are no longer aligned", feed_size);
+    }
+    codec->SetInputFrameSamples(capture_frame_samples);
+#endif
+
     // 将设备状态设置为空闲状态，表明初始化完成，进入待机状态
     SetDeviceState(kDeviceStateIdle);  // 设置为空闲状态
     // 启动一个周期性的时钟定时器，定时器周期为 1 秒
     esp_timer_start_periodic(clock_timer_handle_, 1000000);  // 启动时钟定时器
 }
 
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+// 输出本次监听会话中上行 VAD 闸门的效果，节省量按本会话实际发送部分的平均码率与编码开销估算
+void Application::LogUplinkGateStats() {
+    auto stats = uplink_gate_.GetStats();
+    auto totals = audio_encoder_task_->GetTotals();
+    uint64_t samples = totals.samples - uplink_totals_.samples;
+    uint64_t bytes = totals.bytes - uplink_totals_.bytes;
+    uint64_t encode_us = totals.encode_us - uplink_totals_.encode_us;
+    uint64_t gated_samples = (uint64_t)stats.gated_ms * 16000 / 1000;
+    uint32_t saved_bytes = samples > 0 ? bytes * gated_samples / samples : 0;
+    uint32_t saved_encode_ms = samples > 0 ? encode_us * gated_samples / samples / 1000 : 0;
+    ESP_LOGI(TAG, "Uplink gate: sent %lu ms, gated %lu ms in %lu pauses, saved ~%lu bytes and ~%lu ms encode",
+        stats.passed_ms, stats.gated_ms, stats.closes, saved_bytes, saved_encode_ms);
+}
+#endif
+
+// 服务端消息类型与处理函数的对应表，hello/goodbye 由协议层处理
+const Application::MessageHandler Application::kMessageHandlers[] = {
+    {"tts", &Application::HandleTtsMessage},          // 文本转语音
+    {"stt", &Application::HandleSttMessage},          // 语音转文本
+    {"llm", &Application::HandleLlmMessage},          // 大语言模型
+    {"iot", &Application::HandleIotMessage},          // IoT设备
+    {"latency", &Application::HandleLatencyMessage},  // 帧级时延统计
+    {"capture_frame", &Application::HandleCaptureFrameMessage},  // 采集帧长
+};
+
+// 在协议的接收任务中调用，只做字段判断与 Schedule，message 在返回后失效
+void Application::OnIncomingMessage(const JsonObject& message) {
+    auto type = message["type"].view();
+    for (auto& entry : kMessageHandlers) {
+        if (entry.type == type) {
+            (this->*entry.handler)(message);
+            return;
+        }
+    }
+}
+
+void Application::HandleTtsMessage(const JsonObject& message) {
+    auto& state = message["state"];
+    // 处理 TTS 开始状态
+    if (state.Equals("start")) {
+        // 从最后一个上行包发出到首个 TTS 样本播放，计为一次响应时延
+        LatencyTracer::GetInstance().ArmResponse();
+        // 安排一个任务来处理 TTS 开始事件
+        Schedule([this]() {
+            // 标记未中止说话
+            aborted_ = false;
+            // 如果设备处于空闲状态或监听状态，将设备状态设置为说话状态
+            if (device_state_ == kDeviceStateIdle || device_state_ == kDeviceStateListening) {
+                SetDeviceState(kDeviceStateSpeaking);  // 设置为说话状态
+            }
+        });
+    }
+    // 处理 TTS 停止状态
+    else if (state.Equals("stop")) {
+        // 安排一个任务来处理 TTS 停止事件
+        Schedule([this]() {
+            // 如果设备处于说话状态，剩余的音频播放完毕后再切换状态，主循环不在这里等待
+            if (device_state_ == kDeviceStateSpeaking) {
+                tts_stop_pending_ = true;
+                FinishSpeakingIfDrained();
+            }
+        });
+    }
+    // 处理 TTS 句子开始状态
+    else if (state.Equals("sentence_start")) {
+        auto& text = message["text"];
+        if (text.IsString()) {
+            // 文本要跨任务显示，这里是唯一一次复制（同时完成反转义）
+            auto content = text.ToString();
+            ESP_LOGI(TAG, "<< %s", content.c_str());
+            // 安排一个任务来显示助手的聊天消息
+            Schedule([this, message = std::move(content)]() {
+                Board::GetInstance().GetDisplay()->SetChatMessage("assistant", message.c_str());  // 显示助手消息
+            });
+        }
+    }
+}
+
+void Application::HandleSttMessage(const JsonObject& message) {
+    auto& text = message["text"];
+    if (text.IsString()) {
+        auto content = text.ToString();
+        ESP_LOGI(TAG, ">> %s", content.c_str());
+        // 安排一个任务来显示用户的聊天消息
+        Schedule([this, message = std::move(content)]() {
+            Board::GetInstance().GetDisplay()->SetChatMessage("user", message.c_str());  // 显示用户消息
+        });
+    }
+}
+
+void Application::HandleLlmMessage(const JsonObject& message) {
+    auto& emotion = message["emotion"];
+    if (emotion.IsString()) {
+        // 安排一个任务来设置显示设备的表情状态
+        Schedule([this, emotion_str = emotion.ToString()]() {
+            Board::GetInstance().GetDisplay()->SetEmotion(emotion_str.c_str());  // 设置表情
+        });
+    }
+}
+
+// IoT 命令很少出现且结构不定，只有这里把 "commands" 数组交给 cJSON 解析
+void Application::HandleIotMessage(const JsonObject& message) {
+    auto& commands_json = message["commands"];
+    if (!commands_json.IsArray()) {
+        return;
+    }
+    auto commands = cJSON_ParseWithLength(commands_json.raw.data(), commands_json.raw.size());
+    if (commands == nullptr) {
+        return;
+    }
+    // 获取 IoT 设备管理器的单例对象
+    auto& thing_manager = iot::ThingManager::GetInstance();
+    // 遍历命令数组
+    for (int i = 0; i < cJSON_GetArraySize(commands); ++i) {
+        // 获取数组中的每个命令
+        auto command = cJSON_GetArrayItem(commands, i);
+        // 调用 IoT 设备管理器执行命令
+        thing_manager.Invoke(command);  // 执行IoT命令
+    }
+    cJSON_Delete(commands);
+}
+
+// 音频通道打开后的处理，只在主循环中调用
+void Application::OnAudioChannelOpened() {
+    auto& board = Board::GetInstance();
+    auto codec = board.GetAudioCodec();
+    // 当音频通道打开时，关闭设备的省电模式
+    board.SetPowerSaveMode(false);  // 关闭省电模式
+    // 检查服务器的采样率和设备的输出采样率是否一致
+    if (protocol_->server_sample_rate() != codec->output_sample_rate()) {
+        // 如果不一致，记录警告日志，提示可能会因重采样导致失真
+        ESP_LOGW(TAG, "Server sample rate %d does not match device output sample rate %d, resampling may cause distortion",
+            protocol_->server_sample_rate(), codec->output_sample_rate());
+    }
+    // 设置 Opus 解码的采样率为服务器的采样率
+    SetDecodeSampleRate(protocol_->server_sample_rate());  // 设置解码采样率
+    // 清空上次的 IoT 设备状态信息
+    last_iot_states_.clear();
+    // 获取 IoT 设备管理器的单例对象
+    auto& thing_manager = iot::ThingManager::GetInstance();
+    // 发送 IoT 设备的描述信息到服务器
+    protocol_->SendIotDescriptors(thing_manager.GetDescriptorsJson());
+}
+
+// 查询帧级时延统计，{"type":"latency","reset":true} 在返回后清零
+void Application::HandleLatencyMessage(const JsonObject& message) {
+    auto& tracer = LatencyTracer::GetInstance();
+    tracer.Dump();
+    bool reset = message["reset"].IsTrue();
+    protocol_->SendLatencyReport(tracer.GetJson(reset));
+}
+
+// 切换每次采集读取的帧长，{"type":"capture_frame","ms":20}，0 恢复默认
+// 用于对比不同帧长下的时延与 CPU 占用，与时延查询分开，查询本身不改变采集行为
+void Application::HandleCaptureFrameMessage(const JsonObject& message) {
+    int ms = message["ms"].ToInt(-1);
+    if (ms >= 0 && ms <= 64) {
+        Schedule([this, ms]() {
+            auto codec = Board::GetInstance().GetAudioCodec();
+            codec->SetInputFrameSamples(ms > 0 ? codec->input_sample_rate() / 1000 * ms : 0);
+            input_reads_ = 0;
+            input_samples_ = 0;
+            input_busy_us_ = 0;
+        });
+    }
+}
+
 // 时钟定时器回调函数
 // 这是 Application 类的 OnClockTimer 方法，用于处理时钟定时器相关的逻辑
 void Application::OnClockTimer() {
@@ -801,6 +982,53 @@ void Application::OnClockTimer() {
         int min_free_sram = heap_caps_get_minimum_free_size(MALLOC_CAP_INTERNAL);
         // 使用 ESP_LOGI 宏记录日志，打印内部 SRAM 的可用大小和最小可用大小
         ESP_LOGI(TAG, "Free internal: %u minimal internal: %u", free_sram, min_free_sram);
+        // 打印解码队列的占用情况，用于按开发板调整 CONFIG_AUDIO_DECODE_QUEUE_SIZE
+        auto stats = audio_decode_queue_.GetStats();
+        ESP_LOGI(TAG, "Decode queue: pushed %lu popped %lu dropped %lu evicted %lu, used %zu peak %zu / %zu bytes",
+            stats.pushed, stats.popped, stats.dropped, stats.evicted, stats.used_bytes, stats.peak_bytes, stats.capacity_bytes);
+        // 打印帧池的使用情况，用于按开发板调整 CONFIG_AUDIO_FRAME_POOL_SIZE
+        auto pool_stats = audio_frame_pool_.GetStats();
+        ESP_LOGI(TAG, "Frame pool: acquired %lu exhausted %lu refilled %lu, in use %zu peak %zu / %zu",
+            pool_stats.acquired, pool_stats.exhausted, pool_stats.refilled, pool_stats.in_use, pool_stats.peak_in_use, pool_stats.frame_count);
+        // 打印播放缓冲区的状态，用于调整 CONFIG_AUDIO_DECODE_AHEAD_MS 与 CONFIG_AUDIO_PLAYBACK_PREBUFFER_MS
+        if (audio_player_) {
+            auto player_stats = audio_player_->GetStats();
+            ESP_LOGI(TAG, "Player: underruns %lu overruns %lu, buffered %d peak %d / %d ms, start latency %d ms",
+                player_stats.underruns, player_stats.overruns, player_stats.buffered_ms, player_stats.peak_ms,
+                player_stats.capacity_ms, player_stats.start_latency_ms);
+        }
+        // 打印上行编码各阶段的延迟：排队、编码、发送
+        if (audio_encoder_task_) {
+            auto encoder_stats = audio_encoder_task_->GetStats(true);
+            ESP_LOGI(TAG, "Encoder: frames %lu packets %lu dropped %lu, queue %lu/%lu us, encode %lu/%lu us, send %lu/%lu us (avg/max)",
+                encoder_stats.frames, encoder_stats.packets, encoder_stats.dropped,
+                encoder_stats.queue_avg_us, encoder_stats.queue_max_us, encoder_stats.encode_avg_us, encoder_stats.encode_max_us,
+                encoder_stats.send_avg_us, encoder_stats.send_max_us);
+        }
+        // 打印采集帧长与采集处理（重采样、喂入 AFE 或交给编码任务）的 CPU 开销，换算为每秒音频的耗时
+        auto codec = Board::GetInstance().GetAudioCodec();
+        uint32_t input_samples = input_samples_.exchange(0);
+        uint32_t input_reads = input_reads_.exchange(0);
+        uint32_t input_busy_us = input_busy_us_.exchange(0);
+        if (input_samples > 0) {
+            int capture_frame = codec->input_frame_samples();
+            ESP_LOGI(TAG, "Capture: frame %d samples (%d ms), %lu reads, %llu us cpu per second of audio",
+                capture_frame, capture_frame * 1000 / codec->input_sample_rate(), input_reads,
+                (uint64_t)input_busy_us * codec->input_sample_rate() / input_samples);
+        }
+        // 打印控制消息的扫描分发开销，TTS 较多的会话中每句话有两条消息
+        if (protocol_) {
+            auto json_stats = protocol_->GetJsonStats(true);
+            if (json_stats.messages > 0 || json_stats.errors > 0) {
+                ESP_LOGI(TAG, "Control JSON: %lu messages (%lu bytes), %lu errors, dispatch %lu/%lu us (avg/max)",
+                    json_stats.messages, json_stats.bytes, json_stats.errors, json_stats.parse_avg_us, json_stats.parse_max_us);
+            }
+        }
+
+        // 每分钟在控制台输出一次帧级时延统计
+        if (clock_ticks_ % 60 == 0) {
+            LatencyTracer::GetInstance().Dump();
+        }
 
         // 如果已同步服务器时间，设置状态为时钟 "HH:MM"
         // 检查 ota_ 对象是否已经获取到了服务器时间
@@ -879,11 +1107,90 @@ void Application::MainLoop() {
     }
 }
 
+// 安排一次解码，已有解码任务在排队时不再重复安排
+// 由主循环（I2S 输出就绪）、网络回调（收到数据包）和写入任务（缓冲低于领先量）调用
+void Application::ScheduleDecode() {
+    if (background_task_ == nullptr || decode_scheduled_.exchange(true)) {
+        return;
+    }
+    background_task_->Schedule([this]() {
+        DecodeAhead();
+    });
+}
+
+// 连续解码数据包，直到播放缓冲区领先 CONFIG_AUDIO_DECODE_AHEAD_MS 或解码队列为空，在后台任务中执行
+// 后台任务是解码队列唯一的消费者，解码过程不会阻塞在 I2S 写入上
+void Application::DecodeAhead() {
+    while (audio_player_->BufferedMs() < CONFIG_AUDIO_DECODE_AHEAD_MS) {
+        // 取出一个数据包到复用的 decode_packet_ 中，队列可能已被清空
+        int64_t received_us = 0;
+        if (!audio_decode_queue_.Pop(decode_packet_, &received_us)) {
+            break;
+        }
+        // 如果说话已被中止，丢弃该数据包
+        if (aborted_) {
+            continue;
+        }
+
+        // Decode 只读取数据包内容，decode_packet_ 与 decode_pcm_ 的容量会被保留给下一次使用
+        // 空数据包会以 NULL/0 传给 opus_decode，由 Opus 生成一帧丢包补偿（PLC）音频
+        // 每个数据包只读取一次当前解码器，切换采样率时解码器与重采样器总是成对使用
+        // 本地提示音入队时没有收包时间，不计入时延统计
+        LatencyTrace trace;
+        trace.Begin(received_us);
+        trace.Stamp(kLatencyReceive);
+        auto decoder = opus_decoder_.load();
+        if (!decoder->decoder->Decode(std::move(decode_packet_), decode_pcm_)) {  // 解码音频数据
+            continue;
+        }
+
+        // 解码采样率与输出采样率不同时先重采样
+        if (decoder->resampler) {
+            resampled_pcm_.resize(decoder->resampler->GetOutputSamples(decode_pcm_.size()));
+            resampled_pcm_.resize(decoder->resampler->Process(decode_pcm_.data(), decode_pcm_.size(), resampled_pcm_.data()));
+            trace.Stamp(kLatencyDecode);
+            audio_player_->Write(resampled_pcm_.data(), resampled_pcm_.size(), &trace);
+        } else {
+            trace.Stamp(kLatencyDecode);
+            audio_player_->Write(decode_pcm_.data(), decode_pcm_.size(), &trace);
+        }
+    }
+    decode_scheduled_ = false;
+    // 最后的数据包没有产生新的 PCM（解码失败或已中止）时不会再有排空通知，在这里补一次检查
+    if (tts_stop_pending_ && audio_decode_queue_.Empty() && audio_player_->IsDrained()) {
+        Schedule([this]() {
+            FinishSpeakingIfDrained();
+        });
+    }
+}
+
+// TTS 已结束且解码队列、播放缓冲区都已排空时，结束说话状态，只在主循环中调用
+// 尚未排空时直接返回，等待写入任务的排空通知或解码结束后再次检查
+void Application::FinishSpeakingIfDrained() {
+    if (!tts_stop_pending_ || device_state_ != kDeviceStateSpeaking) {
+        return;
+    }
+    if (!audio_decode_queue_.Empty() || decode_scheduled_ || !audio_player_->IsDrained()) {
+        return;
+    }
+    tts_stop_pending_ = false;
+    // 如果需要继续监听
+    if (keep_listening_) {
+        // 发送开始监听的请求
+        protocol_->SendStartListening(kListeningModeAutoStop);  // 开始监听
+        // 将设备状态设置为监听状态
+        SetDeviceState(kDeviceStateListening);  // 设置为监听状态
+    } else {
+        // 将设备状态设置为空闲状态
+        SetDeviceState(kDeviceStateIdle);  // 设置为空闲状态
+    }
+}
+
 // 重置解码器
 void Application::ResetDecoder() {
-    std::lock_guard<std::mutex> lock(mutex_);
-    opus_decoder_->ResetState();  // 重置解码器状态
-    audio_decode_queue_.clear();  // 清空音频解码队列
+    opus_decoder_.load()->decoder->ResetState();  // 重置解码器状态
+    audio_decode_queue_.Clear();  // 清空音频解码队列
+    audio_player_->Clear();  // 丢弃尚未播放的 PCM
     last_output_time_ = std::chrono::steady_clock::now();
 }
 
@@ -898,10 +1205,8 @@ void Application::OutputAudio() {
     // 定义最大静音时间为 10 秒
     const int max_silence_seconds = 10;  // 最大静音时间
 
-    // 使用互斥锁保护对音频解码队列的访问
-    std::unique_lock<std::mutex> lock(mutex_);
     // 检查音频解码队列是否为空
-    if (audio_decode_queue_.empty()) {
+    if (audio_decode_queue_.Empty()) {
         // 如果设备处于空闲状态且长时间没有音频数据
         if (device_state_ == kDeviceStateIdle) {
             // 计算距离上次输出音频的时间间隔（以秒为单位）
@@ -919,51 +1224,16 @@ void Application::OutputAudio() {
     // 检查设备状态是否为监听状态
     if (device_state_ == kDeviceStateListening) {
         // 如果设备处于监听状态，清空音频解码队列
-        audio_decode_queue_.clear();  // 清空音频解码队列
+        audio_decode_queue_.Clear();  // 清空音频解码队列
         // 清空队列后返回，结束本次音频输出处理
         return;
     }
 
     // 更新上次输出音频的时间为当前时间
     last_output_time_ = now;
-    // 从音频解码队列中取出第一个元素（即要处理的音频数据）
-    auto opus = std::move(audio_decode_queue_.front());
-    // 将取出的元素从队列中移除
-    audio_decode_queue_.pop_front();
-    // 解锁互斥锁，释放对音频解码队列的独占访问
-    lock.unlock();
-
-    // 安排一个后台任务来处理音频数据的解码和输出
-    background_task_->Schedule([this, codec, opus = std::move(opus)]() mutable {
-        // 检查任务是否已被中止
-        if (aborted_) {
-            // 如果任务已被中止，直接返回，不进行后续处理
-            return;
-        }
-
-        // 定义一个用于存储解码后 PCM 音频数据的向量
-        std::vector<int16_t> pcm;
-        // 使用 Opus 解码器对音频数据进行解码
-        // 如果解码失败，直接返回，不进行后续处理
-        if (!opus_decoder_->Decode(std::move(opus), pcm)) {  // 解码音频数据
-            return;
-        }
 
-        // 检查解码后的音频数据采样率与音频编解码器的输出采样率是否不同
-        if (opus_decode_sample_rate_ != codec->output_sample_rate()) {
-            // 计算重采样后音频数据的目标大小
-            int target_size = output_resampler_.GetOutputSamples(pcm.size());
-            // 定义一个用于存储重采样后音频数据的向量
-            std::vector<int16_t> resampled(target_size);
-            // 使用重采样器对音频数据进行重采样处理
-            output_resampler_.Process(pcm.data(), pcm.size(), resampled.data());
-            // 将重采样后的数据移动到 pcm 向量中
-            pcm = std::move(resampled);
-        }
-
-        // 将处理后的音频数据发送到音频编解码器进行输出
-        codec->OutputData(pcm);  // 输出音频数据
-    });
+    // 解码在后台任务中进行，PCM 写入播放缓冲区后由写入任务送入 I2S
+    ScheduleDecode();
 }
 
 // 输入音频
@@ -972,60 +1242,45 @@ void Application::InputAudio() {
     // 获取音频编解码器实例
     // 通过 Board 单例对象获取音频编解码器，后续用于音频数据的输入和处理
     auto codec = Board::GetInstance().GetAudioCodec();
-    // 定义一个存储音频数据的向量，数据类型为 int16_t
-    std::vector<int16_t> data;
+    // 采集缓冲区与重采样缓冲区都是成员变量，容量已在 Start 中预留，稳态下不产生堆分配
     // 从音频编解码器获取音频输入数据
     // 如果获取数据失败，直接返回，结束本次音频输入处理
-    if (!codec->InputData(data)) {  // 获取音频输入数据
+    LatencyTrace trace;
+    trace.Begin();
+    if (!codec->InputData(input_buffer_)) {  // 获取音频输入数据
         return;
     }
+    trace.Stamp(kLatencyCapture);
+    int64_t process_start = esp_timer_get_time();
+    input_reads_++;
+    input_samples_ += input_buffer_.size() / codec->input_channels();
 
     // 检查音频输入的采样率是否为 16000
-    // 如果不是 16000，需要进行重采样处理
-    if (codec->input_sample_rate() != 16000) {
-        // 检查音频输入的通道数是否为 2（立体声）
-        if (codec->input_channels() == 2) {
-            // 分离立体声数据为麦克风通道和参考通道
-            // 初始化麦克风通道和参考通道的向量，大小为原始数据的一半
-            auto mic_channel = std::vector<int16_t>(data.size() / 2);
-            auto reference_channel = std::vector<int16_t>(data.size() / 2);
-            // 遍历原始数据，将奇数索引的数据存入麦克风通道，偶数索引的数据存入参考通道
-            for (size_t i = 0, j = 0; i < mic_channel.size(); ++i, j += 2) {
-                mic_channel[i] = data[j];
-                reference_channel[i] = data[j + 1];
-            }
-            // 对麦克风通道和参考通道的数据进行重采样
-            // 初始化重采样后的麦克风通道和参考通道的向量，大小根据重采样器计算得出
-            auto resampled_mic = std::vector<int16_t>(input_resampler_.GetOutputSamples(mic_channel.size()));
-            auto resampled_reference = std::vector<int16_t>(reference_resampler_.GetOutputSamples(reference_channel.size()));
-            // 使用重采样器对麦克风通道和参考通道的数据进行重采样处理
-            input_resampler_.Process(mic_channel.data(), mic_channel.size(), resampled_mic.data());
-            reference_resampler_.Process(reference_channel.data(), reference_channel.size(), resampled_reference.data());
-            // 合并重采样后的麦克风通道和参考通道的数据
-            // 调整 data 向量的大小，以容纳重采样后的数据
-            data.resize(resampled_mic.size() + resampled_reference.size());
-            // 将重采样后的麦克风通道和参考通道的数据合并回 data 向量
-            for (size_t i = 0, j = 0; i < resampled_mic.size(); ++i, j += 2) {
-                data[j] = resampled_mic[i];
-                data[j + 1] = resampled_reference[i];
-            }
-        } else {
-            // 单声道数据的重采样
-            // 初始化重采样后的向量，大小根据重采样器计算得出
-            auto resampled = std::vector<int16_t>(input_resampler_.GetOutputSamples(data.size()));
-            // 使用重采样器对单声道数据进行重采样处理
-            input_resampler_.Process(data.data(), data.size(), resampled.data());
-            // 将重采样后的数据移动到 data 向量中
-            data = std::move(resampled);
-        }
+    // 如果不是 16000，需要进行重采样处理；立体声数据（麦克风+参考）保持交织格式一起重采样
+    if (input_resampler_.enabled()) {
+        resampled_input_.resize(input_resampler_.GetOutputSamples(input_buffer_.size()));
+        size_t samples = input_resampler_.Process(input_buffer_.data(), input_buffer_.size(), resampled_input_.data());
+        resampled_input_.resize(samples);
+        input_buffer_.swap(resampled_input_);
+        trace.Stamp(kLatencyResample);
     }
 
+    #if CONFIG_USE_SHARED_AUDIO_FRONTEND
+    // 共享前端：同一个 AFE 只喂入一次，唤醒词检测与上行音频都取自它的输出
+    if (wake_word_detect_.IsRunning()) {
+        if (wake_word_detect_.IsOutputRunning()) {
+            afe_traces_.Push(input_buffer_.size() / codec->input_channels(), trace);
+        }
+        wake_word_detect_.Feed(input_buffer_);
+        trace.Stamp(kLatencyAfeFeed);
+    }
+    #else
     // 如果配置了使用唤醒词检测功能
     #if CONFIG_USE_WAKE_WORD_DETECT
     // 检查唤醒词检测是否正在运行
     if (wake_word_detect_.IsDetectionRunning()) {
         // 将音频数据喂入唤醒词检测模块进行检测
-        wake_word_detect_.Feed(data);  // 喂入音频数据到唤醒词检测
+        wake_word_detect_.Feed(input_buffer_);  // 喂入音频数据到唤醒词检测
     }
     #endif
 
@@ -1033,27 +1288,29 @@ void Application::InputAudio() {
     #if CONFIG_USE_AUDIO_PROCESSOR
     // 检查音频处理器是否正在运行
     if (audio_processor_.IsRunning()) {
+        // 先登记时延记录再送入，AFE 的取数任务可能在 Input 返回前就输出这一帧
+        afe_traces_.Push(input_buffer_.size() / codec->input_channels(), trace);
         // 将音频数据输入到音频处理器进行处理
-        audio_processor_.Input(data);  // 处理音频数据
+        audio_processor_.Input(input_buffer_);  // 处理音频数据
+        trace.Stamp(kLatencyAfeFeed);
     }
-    // 如果没有配置使用音频处理器
+    // 如果音频处理器没有运行
     else {
         // 检查设备状态是否为监听状态
-        if (device_state_ == kDeviceStateListening) {
-            // 安排一个后台任务来处理音频数据
-            background_task_->Schedule([this, data = std::move(data)]() mutable {
-                // 使用 Opus 编码器对音频数据进行编码
-                opus_encoder_->Encode(std::move(data), [this](std::vector<uint8_t>&& opus) {
-                    // 安排一个任务来发送编码后的音频数据
-                    Schedule([this, opus = std::move(opus)]() {
-                        // 通过协议对象发送编码后的音频数据
-                        protocol_->SendAudio(opus);  // 发送音频数据
-                    });
-                });
-            });
+        if (device_state_ == kDeviceStateListening || uplink_started_early_) {
+            // 从帧池取一帧，池耗尽时丢弃本帧（计入 exhausted 统计）
+            auto frame = audio_frame_pool_.Acquire();
+            if (frame != nullptr) {
+                // 与采集缓冲区交换，零拷贝地把本帧交给编码任务，采集缓冲区换成帧池中已预留容量的缓冲区
+                frame->pcm.swap(input_buffer_);
+                frame->trace = trace;
+                audio_encoder_task_->Push(frame);
+            }
         }
     }
     #endif
+    #endif
+    input_busy_us_ += esp_timer_get_time() - process_start;
 }
 
 // 中止说话
@@ -1063,6 +1320,8 @@ void Application::AbortSpeaking(AbortReason reason) {
     ESP_LOGI(TAG, "Abort speaking");
     // 将 aborted_ 标志设置为 true，表示说话操作已被中止
     aborted_ = true;
+    // 丢弃已解码但尚未播放的 PCM，立即停止播放
+    audio_player_->Clear();
     // 通过协议对象向服务器发送中止说话的命令，并携带中止原因
     protocol_->SendAbortSpeaking(reason);  // 发送中止说话命令
 }
@@ -1082,11 +1341,22 @@ void Application::SetDeviceState(DeviceState state) {
     auto previous_state = device_state_;
     // 将设备状态更新为传入的状态
     device_state_ = state;
+    // 任何状态切换都使之前等待中的 TTS stop 失效（例如播放中被打断）
+    tts_stop_pending_ = false;
     // 记录日志，显示设备状态的变化，STATE_STRINGS 是一个存储状态字符串的数组
     ESP_LOGI(TAG, "STATE: %s", STATE_STRINGS[device_state_]);  // 记录状态变化
     // 当设备状态发生变化时，等待所有后台任务完成
     // 确保在状态改变前，之前的后台任务都已结束，避免冲突
     background_task_->WaitForCompletion();
+    // 同样等待上行编码任务处理完已提交的帧，之后才能重置编码器状态
+    if (audio_encoder_task_) {
+        audio_encoder_task_->WaitForCompletion();
+    }
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+    if (previous_state == kDeviceStateListening) {
+        LogUplinkGateStats();
+    }
+#endif
 
     // 获取 Board 类的单例对象，用于访问硬件相关的功能
     auto& board = Board::GetInstance();
@@ -1108,12 +1378,17 @@ void Application::SetDeviceState(DeviceState state) {
             // 在显示设备上设置表情为中性表情
             display->SetEmotion("neutral");  // 设置表情为中性
             // 如果配置了使用音频处理器，则停止音频处理器的工作
-#if CONFIG_USE_AUDIO_PROCESSOR
+#if CONFIG_USE_SHARED_AUDIO_FRONTEND
+            wake_word_detect_.StopOutput();  // 共享前端切回唤醒词角色
+#elif CONFIG_USE_AUDIO_PROCESSOR
             audio_processor_.Stop();  // 停止音频处理器
 #endif
             break;
         // 连接状态
         case kDeviceStateConnecting:
+#if CONFIG_SPECULATIVE_PRECONNECT
+            FinishPreConnect(true);
+#endif
             // 在显示设备上设置状态信息为连接中
             display->SetStatus(Lang::Strings::CONNECTING);  // 设置状态为连接中
             // 在显示设备上设置表情为中性表情
@@ -1129,17 +1404,17 @@ void Application::SetDeviceState(DeviceState state) {
             display->SetEmotion("neutral");  // 设置表情为中性
             // 重置解码器，清除解码器的内部状态
             ResetDecoder();  // 重置解码器
-            // 重置编码器的状态，以便重新开始编码操作
-            opus_encoder_->ResetState();  // 重置编码器状态
-            // 如果配置了使用音频处理器，则启动音频处理器
-#if CONFIG_USE_AUDIO_PROCESSOR
-            audio_processor_.Start();  // 启动音频处理器
-#endif
+            if (uplink_started_early_) {
+                // 唤醒后连接期间已开始采集编码，沿用同一路编码状态，不打断已排队的数据
+                uplink_started_early_ = false;
+            } else {
+                StartUplinkCapture();
+            }
             // 更新 IoT 设备的状态信息
             UpdateIotStates();  // 更新IoT状态
             // 如果之前的状态是说话状态
             if (previous_state == kDeviceStateSpeaking) {
-                // FIXME: 等待扬声器清空缓冲区，这里使用 vTaskDelay 进行短暂延迟
+                // FIXME: 等待 I2S DMA 中剩余的数据播放完毕，这里使用 vTaskDelay 进行短暂延迟
                 vTaskDelay(pdMS_TO_TICKS(120));
             }
             break;
@@ -1152,7 +1427,9 @@ void Application::SetDeviceState(DeviceState state) {
             // 启用音频编解码器的输出功能
             codec->EnableOutput(true);  // 启用音频输出
             // 如果配置了使用音频处理器，则停止音频处理器的工作
-#if CONFIG_USE_AUDIO_PROCESSOR
+#if CONFIG_USE_SHARED_AUDIO_FRONTEND
+            wake_word_detect_.StopOutput();  // 共享前端切回唤醒词角色
+#elif CONFIG_USE_AUDIO_PROCESSOR
             audio_processor_.Stop();  // 停止音频处理器
 #endif
             break;
@@ -1164,6 +1441,184 @@ void Application::SetDeviceState(DeviceState state) {
     }
 }
 
+// 开始上行：重置编码器状态与 VAD 闸门，启动语音通信前端
+void Application::StartUplinkCapture() {
+    // 重置编码器的状态，以便重新开始编码操作
+    opus_encoder_->ResetState();  // 重置编码器状态
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+    uplink_gate_.Reset();
+    uplink_totals_ = audio_encoder_task_->GetTotals();
+#endif
+    // 如果配置了使用音频处理器，则启动音频处理器
+#if CONFIG_USE_SHARED_AUDIO_FRONTEND
+    afe_traces_.Clear();
+    wake_word_detect_.StartOutput();  // 共享前端切换到语音通信角色
+#elif CONFIG_USE_AUDIO_PROCESSOR
+    afe_traces_.Clear();
+    audio_processor_.Start();  // 启动音频处理器
+#endif
+}
+
+#if CONFIG_USE_WAKE_WORD_DETECT
+// 在独立任务中建立连接并等待服务端 hello，主循环继续处理采集，完成后回到主循环继续
+void Application::OpenAudioChannelAsync() {
+    channel_open_start_time_ = esp_timer_get_time();
+    channel_opening_async_ = true;
+    xTaskCreate([](void* arg) {
+        Application* app = (Application*)arg;
+        bool success = app->protocol_->OpenAudioChannel();
+        app->Schedule([app, success]() {
+            app->OnWakeWordChannelOpened(success);
+        });
+        vTaskDelete(NULL);
+    }, "open_channel", 4096 * 2, this, 3, nullptr);
+}
+
+// 依次发送唤醒词预录、唤醒词消息和连接期间排队的数据包，之后编码任务直接发送
+void Application::OnWakeWordChannelOpened(bool success) {
+    int64_t opened_time = esp_timer_get_time();
+    channel_opening_async_ = false;
+    if (!success || device_state_ != kDeviceStateConnecting) {
+        // 连接失败时网络错误回调已切回空闲状态，丢弃排队的数据包
+        {
+            std::lock_guard<std::mutex> lock(uplink_backlog_mutex_);
+            uplink_buffering_ = false;
+            uplink_backlog_.Clear();
+        }
+        uplink_started_early_ = false;
+        if (success) {
+            protocol_->CloseAudioChannel();
+        }
+        if (device_state_ == kDeviceStateConnecting) {
+            SetDeviceState(kDeviceStateIdle);
+        }
+        wake_word_detect_.StartDetection();
+        return;
+    }
+    OnAudioChannelOpened();
+
+    std::vector<uint8_t> opus;
+    int64_t first_packet_time = 0;
+    int preroll_packets = 0;
+    // 预录数据包在检测到唤醒词之前采集，没有逐包的采集时间
+    while (wake_word_detect_.GetWakeWordOpus(opus)) {
+        protocol_->SendAudio(opus, 0);
+        if (preroll_packets++ == 0) {
+            first_packet_time = esp_timer_get_time();
+        }
+    }
+    protocol_->SendWakeWordDetected(pending_wake_word_);
+    ESP_LOGI(TAG, "Wake word detected: %s", pending_wake_word_.c_str());
+
+    int queued_packets = 0;
+    {
+        std::lock_guard<std::mutex> lock(uplink_backlog_mutex_);
+        int64_t capture_time_us = 0;
+        while (uplink_backlog_.Pop(opus, &capture_time_us)) {
+            protocol_->SendAudio(opus, capture_time_us);
+            if (first_packet_time == 0) {
+                first_packet_time = esp_timer_get_time();
+            }
+            queued_packets++;
+        }
+        uplink_buffering_ = false;
+    }
+    if (first_packet_time != 0) {
+        ESP_LOGI(TAG, "Wake word to first uplink packet: %lld ms (channel open %lld ms), pre-roll %d packets, queued %d packets",
+            (first_packet_time - wake_word_detect_.GetLastDetectedTime()) / 1000,
+            (opened_time - channel_open_start_time_) / 1000, preroll_packets, queued_packets);
+    }
+
+    // 标记需要继续监听
+    keep_listening_ = true;
+    // 将设备状态设置为监听状态
+    SetDeviceState(kDeviceStateListening);  // 设置为监听状态
+    // 恢复唤醒词检测
+    wake_word_detect_.StartDetection();
+}
+#endif
+
+// 早期对话意图（例如按键按下、尚未判定为单击），可在任意任务中调用
+void Application::PreConnect() {
+#if CONFIG_SPECULATIVE_PRECONNECT
+    Schedule([this]() {
+        StartPreConnect();
+    });
+#endif
+}
+
+#if CONFIG_SPECULATIVE_PRECONNECT
+// 空闲状态下在后台提前建立连接，窗口内开始对话时 OpenAudioChannel 直接复用
+void Application::StartPreConnect() {
+    if (device_state_ != kDeviceStateIdle || !protocol_ || preconnect_pending_ || preconnect_in_flight_) {
+        return;
+    }
+    preconnect_pending_ = true;
+    preconnect_in_flight_ = true;
+    preconnect_start_time_ = esp_timer_get_time();
+    preconnect_stats_.attempts++;
+    esp_timer_start_once(preconnect_timer_, CONFIG_SPECULATIVE_PRECONNECT_WINDOW_MS * 1000LL);
+
+    xTaskCreate([](void* arg) {
+        Application* app = (Application*)arg;
+        int64_t start_time = esp_timer_get_time();
+        bool success = app->protocol_->PreConnect();
+        // 握手耗时为负表示连接失败
+        int64_t elapsed = esp_timer_get_time() - start_time;
+        int64_t handshake_us = success ? elapsed : -elapsed;
+        app->Schedule([app, handshake_us]() {
+            app->OnPreConnectHandshakeDone(handshake_us);
+        });
+        vTaskDelete(NULL);
+    }, "preconnect", 4096 * 2, this, 2, nullptr);
+}
+
+// 预连接窗口结束：hit 为 true 表示窗口内开始了对话，否则窗口到期
+// 握手仍在进行时只记下结果，等握手完成后再释放连接并记录统计
+void Application::FinishPreConnect(bool hit) {
+    if (!preconnect_pending_) {
+        return;
+    }
+    preconnect_pending_ = false;
+    preconnect_hit_ = hit;
+    esp_timer_stop(preconnect_timer_);
+    if (!preconnect_in_flight_) {
+        RecordPreConnect();
+    }
+}
+
+// 预连接任务结束，窗口已经结束时补上释放与统计
+void Application::OnPreConnectHandshakeDone(int64_t handshake_us) {
+    preconnect_in_flight_ = false;
+    preconnect_handshake_us_ = handshake_us;
+    if (!preconnect_pending_) {
+        RecordPreConnect();
+    }
+}
+
+// 窗口结束原因与握手结果都已知：窗口到期时释放未使用的连接，并记录一次统计
+void Application::RecordPreConnect() {
+    int64_t handshake_us = preconnect_handshake_us_;
+    if (handshake_us < 0) {
+        preconnect_stats_.failures++;
+        handshake_us = -handshake_us;
+    } else if (preconnect_hit_) {
+        preconnect_stats_.hits++;
+    } else {
+        preconnect_stats_.misses++;
+        int64_t held_us = esp_timer_get_time() - preconnect_start_time_ - handshake_us;
+        preconnect_stats_.unused_ms += held_us > 0 ? held_us / 1000 : 0;
+        protocol_->ReleasePreConnect();
+    }
+    preconnect_stats_.handshake_ms += handshake_us / 1000;
+
+    auto& stats = preconnect_stats_;
+    ESP_LOGI(TAG, "Pre-connect %s: %lu attempts, %lu hits (%lu%%), %lu misses, %lu failures, handshake %llu ms total, unused connection %llu ms",
+        preconnect_hit_ ? "hit" : "miss", stats.attempts, stats.hits, stats.hits * 100 / stats.attempts,
+        stats.misses, stats.failures, stats.handshake_ms, stats.unused_ms);
+}
+#endif
+
 // 设置解码采样率
 // 设置解码采样率的方法
 void Application::SetDecodeSampleRate(int sample_rate) {
@@ -1174,20 +1629,8 @@ void Application::SetDecodeSampleRate(int sample_rate) {
 
     // 更新当前的解码采样率为传入的采样率
     opus_decode_sample_rate_ = sample_rate;
-    // 重置 Opus 解码器智能指针，释放之前的解码器资源
-    opus_decoder_.reset();
-    // 创建一个新的 Opus 解码器实例，使用新的解码采样率和单声道配置
-    opus_decoder_ = std::make_unique<OpusDecoderWrapper>(opus_decode_sample_rate_, 1);  // 创建新的解码器
-
-    // 获取 Board 单例对象的音频编解码器实例
-    auto codec = Board::GetInstance().GetAudioCodec();
-    // 检查新的解码采样率和音频编解码器的输出采样率是否不一致
-    if (opus_decode_sample_rate_ != codec->output_sample_rate()) {
-        // 记录日志，显示需要将音频从新的解码采样率重采样到编解码器的输出采样率
-        ESP_LOGI(TAG, "Resampling audio from %d to %d", opus_decode_sample_rate_, codec->output_sample_rate());
-        // 配置输出重采样器，将新的解码采样率转换为编解码器的输出采样率
-        output_resampler_.Configure(opus_decode_sample_rate_, codec->output_sample_rate());  // 配置重采样器
-    }
+    // 从解码器池中取出该采样率的解码器（含输出重采样器），已缓存时只重置状态，不重新分配内存
+    opus_decoder_ = opus_decoder_pool_->Acquire(sample_rate);
 }
 
 // 更新 IoT 状态的方法
@@ -7,8 +7,10 @@
 #include <esp_timer.h>
 
 #include <string>
+#include <string_view>
 #include <mutex>
 #include <list>
+#include <atomic>
 
 #include <opus_encoder.h>
 #include <opus_decoder.h>
@@ -17,11 +19,19 @@
 #include "protocol.h"
 #include "ota.h"
 #include "background_task.h"
+#include "audio_packet_ring.h"
+#include "audio_frame_pool.h"
+#include "audio_encoder_task.h"
+#include "audio_player.h"
+#include "opus_decoder_pool.h"
+#include "audio_resampler.h"
+#include "latency_tracer.h"
+#include "uplink_gate.h"
 
 #if CONFIG_USE_WAKE_WORD_DETECT
 #include "wake_word_detect.h"
 #endif
-#if CONFIG_USE_AUDIO_PROCESSOR
+#if CONFIG_USE_AUDIO_PROCESSOR && !CONFIG_USE_SHARED_AUDIO_FRONTEND
 #include "audio_processor.h"
 #endif
 
@@ -68,6 +78,7 @@ public:
     void UpdateIotStates();
     void Reboot();
     void WakeWordInvoke(const std::string& wake_word);
+    void PreConnect();
     void PlaySound(const std::string_view& sound);
     bool CanEnterSleepMode();
 
@@ -78,7 +89,7 @@ private:
 #if CONFIG_USE_WAKE_WORD_DETECT
     WakeWordDetect wake_word_detect_;
 #endif
-#if CONFIG_USE_AUDIO_PROCESSOR
+#if CONFIG_USE_AUDIO_PROCESSOR && !CONFIG_USE_SHARED_AUDIO_FRONTEND
     AudioProcessor audio_processor_;
 #endif
     Ota ota_;
@@ -97,24 +108,107 @@ private:
     // Audio encode / decode
     BackgroundTask* background_task_ = nullptr;
     std::chrono::steady_clock::time_point last_output_time_;
-    std::list<std::vector<uint8_t>> audio_decode_queue_;
-
-    std::unique_ptr<OpusEncoderWrapper> opus_encoder_;
-    std::unique_ptr<OpusDecoderWrapper> opus_decoder_;
+    AudioPacketRing audio_decode_queue_;
+    std::vector<uint8_t> decode_packet_;
+    std::vector<int16_t> decode_pcm_;
+    std::vector<int16_t> resampled_pcm_;
+    std::unique_ptr<AudioPlayer> audio_player_;
+#if CONFIG_USE_WAKE_WORD_DETECT
+    // 唤醒后异步打开音频通道，连接与等待 hello 期间编码出的上行数据包先在这里排队
+    AudioPacketRing uplink_backlog_;
+    std::mutex uplink_backlog_mutex_;
+    std::atomic<bool> uplink_buffering_{false};
+    std::string pending_wake_word_;
+    int64_t channel_open_start_time_ = 0;
+    // 通道在 open_channel 任务中打开，通道打开后的处理推迟到主循环的 OnWakeWordChannelOpened
+    std::atomic<bool> channel_opening_async_{false};
+#endif
+    bool uplink_started_early_ = false;  // 进入监听状态前已开始采集编码
+#if CONFIG_SPECULATIVE_PRECONNECT
+    // 推测性预连接，状态只在主循环中访问，握手结果由预连接任务通过 Schedule 交回主循环
+    struct PreConnectStats {
+        uint32_t attempts;   // 发起的预连接次数
+        uint32_t hits;       // 窗口内开始了对话
+        uint32_t misses;     // 窗口到期被释放
+        uint32_t failures;   // 连接失败
+        uint64_t handshake_ms;  // 累计握手耗时
+        uint64_t unused_ms;     // 未被使用的连接累计保持时长，用于估算耗电
+    };
+    PreConnectStats preconnect_stats_ = {};
+    esp_timer_handle_t preconnect_timer_ = nullptr;
+    bool preconnect_pending_ = false;    // 预连接窗口未结束
+    bool preconnect_in_flight_ = false;  // 预连接任务仍在握手
+    bool preconnect_hit_ = false;        // 窗口结束的原因，握手结果也已知时才记录统计
+    int64_t preconnect_start_time_ = 0;
+    int64_t preconnect_handshake_us_ = 0;  // 为负表示连接失败
+#endif
+    std::atomic<bool> decode_scheduled_{false};
+    // 收到 TTS stop 后等待解码队列与播放缓冲区排空，再切换到监听或空闲状态
+    std::atomic<bool> tts_stop_pending_{false};
+
+    std::unique_ptr<OpusFrameEncoder> opus_encoder_;
+    // 按采样率缓存的解码器，opus_decoder_ 指向当前使用的条目（含输出重采样器）
+    std::unique_ptr<OpusDecoderPool> opus_decoder_pool_;
+    std::atomic<OpusDecoderPool::Entry*> opus_decoder_{nullptr};
+    std::unique_ptr<AudioEncoderTask> audio_encoder_task_;
+
+    // 音频采集缓冲区，容量在 Start 中按编解码器参数预留，每帧复用
+    AudioFramePool audio_frame_pool_;
+    std::vector<int16_t> input_buffer_;
+    std::vector<int16_t> resampled_input_;
+    // 采集处理的 CPU 开销统计，在主循环中累加，时钟定时器中读取并清零
+    std::atomic<uint32_t> input_reads_ = 0;
+    std::atomic<uint32_t> input_samples_ = 0;
+    std::atomic<uint32_t> input_busy_us_ = 0;
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+    UplinkGate uplink_gate_;
+    AudioEncoderTask::Totals uplink_totals_ = {};  // 监听会话开始时的编码累计值
+#endif
+    LatencyTraceFifo afe_traces_;  // 送入 AFE 的各帧时延记录，AFE 输出时按样本位置取回
 
     int opus_decode_sample_rate_ = -1;
-    OpusResampler input_resampler_;
-    OpusResampler reference_resampler_;
-    OpusResampler output_resampler_;
+    AudioResampler input_resampler_;  // 双声道（麦克风+参考）时两路一起重采样
 
     void MainLoop();
     void InputAudio();
     void OutputAudio();
+    void ScheduleDecode();
+    void DecodeAhead();
     void ResetDecoder();
+    void FinishSpeakingIfDrained();
     void SetDecodeSampleRate(int sample_rate);
     void CheckNewVersion();
     void ShowActivationCode();
     void OnClockTimer();
+    void StartUplinkCapture();
+
+    // 服务端控制消息按 type 查表分发，处理函数拿到的字段直接指向接收缓冲区
+    struct MessageHandler {
+        std::string_view type;
+        void (Application::*handler)(const JsonObject& message);
+    };
+    static const MessageHandler kMessageHandlers[];
+    void OnIncomingMessage(const JsonObject& message);
+    void HandleTtsMessage(const JsonObject& message);
+    void HandleSttMessage(const JsonObject& message);
+    void HandleLlmMessage(const JsonObject& message);
+    void HandleIotMessage(const JsonObject& message);
+    void HandleLatencyMessage(const JsonObject& message);
+    void HandleCaptureFrameMessage(const JsonObject& message);
+    void OnAudioChannelOpened();
+#if CONFIG_SPECULATIVE_PRECONNECT
+    void StartPreConnect();
+    void FinishPreConnect(bool hit);
+    void OnPreConnectHandshakeDone(int64_t handshake_us);
+    void RecordPreConnect();
+#endif
+#if CONFIG_USE_WAKE_WORD_DETECT
+    void OpenAudioChannelAsync();
+    void OnWakeWordChannelOpened(bool success);
+#endif
+#if CONFIG_AUDIO_UPLINK_VAD_GATE
+    void LogUplinkGateStats();
+#endif
 };
 
 #endif // _APPLICATION_H_
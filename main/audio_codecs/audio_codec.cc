@@ -4,10 +4,19 @@
 
 #include <esp_log.h>
 #include <cstring>
+#if !CONFIG_IDF_TARGET_LINUX
 #include <driver/i2s_common.h>
+#endif
 
 #define TAG "AudioCodec"
 
+// AFE 喂入块为 16kHz 下 512 个采样
+#define AFE_FEED_CHUNK_MS 32
+// 单个 DMA 缓冲区不超过 4092 字节，按每帧 8 字节（双声道 32 位或 TDM 四通道 16 位）计算
+#define MAX_DMA_FRAME_NUM 511
+// DMA 缓冲区总共容纳的采集帧数
+#define DMA_BUFFERED_FRAMES 3
+
 AudioCodec::AudioCodec() {
 }
 
@@ -37,10 +46,9 @@ void AudioCodec::OutputData(std::vector<int16_t>& data) {
 // 定义一个名为 InputData 的成员函数，用于读取音频输入数据
 // 参数 data 是一个存储音频数据的向量，用于接收读取到的数据
 bool AudioCodec::InputData(std::vector<int16_t>& data) {
-    // 定义音频输入的时长为 30 毫秒
-    int duration = 30;
-    // 计算输入音频帧的大小
-    int input_frame_size = input_sample_rate_ / 1000 * duration * input_channels_;
+    // 计算输入音频帧的大小，未单独设置时与 DMA 缓冲区按同一帧长对齐
+    int frame_samples = input_frame_samples_ > 0 ? input_frame_samples_ : DefaultInputFrameSamples(input_sample_rate_);
+    int input_frame_size = frame_samples * input_channels_;
 
     // 调整 data 向量的大小以适应输入音频帧的大小
     data.resize(input_frame_size);
@@ -54,6 +62,42 @@ bool AudioCodec::InputData(std::vector<int16_t>& data) {
     return false;
 }
 
+void AudioCodec::SetInputFrameSamples(int samples) {
+    if (samples == input_frame_samples_) {
+        return;
+    }
+    input_frame_samples_ = samples;
+    ESP_LOGI(TAG, "Set input frame to %d samples (%d ms), DMA %lu x %lu frames",
+        samples, samples * 1000 / input_sample_rate_, DmaDescNum(input_sample_rate_), DmaFrameNum(input_sample_rate_));
+}
+
+int AudioCodec::DefaultInputFrameSamples(int sample_rate) {
+#if CONFIG_AUDIO_CAPTURE_FRAME_MS > 0
+    return sample_rate / 1000 * CONFIG_AUDIO_CAPTURE_FRAME_MS;
+#else
+    return sample_rate / 1000 * AFE_FEED_CHUNK_MS;
+#endif
+}
+
+// 取能整除采集帧、且不超过单个 DMA 缓冲区上限的最少份数，每次 DMA 中断正好完成采集帧的一部分
+static uint32_t DmaSplitCount(int sample_rate) {
+    uint32_t frame = AudioCodec::DefaultInputFrameSamples(sample_rate);
+    uint32_t count = 2;
+    while (frame / count > MAX_DMA_FRAME_NUM || frame % count != 0) {
+        count++;
+    }
+    return count;
+}
+
+uint32_t AudioCodec::DmaFrameNum(int sample_rate) {
+    return AudioCodec::DefaultInputFrameSamples(sample_rate) / DmaSplitCount(sample_rate);
+}
+
+uint32_t AudioCodec::DmaDescNum(int sample_rate) {
+    return DmaSplitCount(sample_rate) * DMA_BUFFERED_FRAMES;
+}
+
+#if !CONFIG_IDF_TARGET_LINUX
 // 定义一个名为 on_sent 的静态成员函数，作为 I2S 发送完成事件的回调函数
 // IRAM_ATTR 表示该函数应放在内部 RAM 中执行，以提高执行速度
 // 参数 handle 是 I2S 通道句柄，event 是 I2S 事件数据，user_ctx 是用户上下文指针
@@ -84,6 +128,8 @@ IRAM_ATTR bool AudioCodec::on_recv(i2s_chan_handle_t handle, i2s_event_data_t *e
     return false;
 }
 
+#endif
+
 // 定义一个名为 Start 的成员函数，用于启动音频编解码功能
 void AudioCodec::Start() {
     // 创建一个名为 "audio" 的设置对象，不自动保存设置
@@ -91,6 +137,7 @@ void AudioCodec::Start() {
     // 从设置中获取输出音量，如果设置中不存在，则使用默认的输出音量
     output_volume_ = settings.GetInt("output_volume", output_volume_);
 
+#if !CONFIG_IDF_TARGET_LINUX
     // 注册音频数据接收回调
     i2s_event_callbacks_t rx_callbacks = {};
     // 将 on_recv 函数作为接收完成事件的回调函数
@@ -109,6 +156,7 @@ void AudioCodec::Start() {
     ESP_ERROR_CHECK(i2s_channel_enable(tx_handle_));
     // 启用 I2S 接收通道
     ESP_ERROR_CHECK(i2s_channel_enable(rx_handle_));
+#endif
 
     // 启用音频输入
     EnableInput(true);
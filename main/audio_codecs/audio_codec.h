@@ -1,9 +1,12 @@
 #ifndef _AUDIO_CODEC_H
 #define _AUDIO_CODEC_H
 
+#include <sdkconfig.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#if !CONFIG_IDF_TARGET_LINUX
 #include <driver/i2s_std.h>
+#endif
 
 #include <vector>
 #include <string>
@@ -20,7 +23,7 @@ public:
     virtual void EnableInput(bool enable);
     virtual void EnableOutput(bool enable);
 
-    void Start();
+    virtual void Start();
     void OutputData(std::vector<int16_t>& data);
     bool InputData(std::vector<int16_t>& data);
     void OnOutputReady(std::function<bool()> callback);
@@ -34,16 +37,31 @@ public:
     inline int output_channels() const { return output_channels_; }
     inline int output_volume() const { return output_volume_; }
 
+    // 每次 InputData 读取的帧数（每通道），运行时可调，不影响已创建的 DMA 缓冲区
+    void SetInputFrameSamples(int samples);
+    inline int input_frame_samples() const { return input_frame_samples_; }
+
+    // 默认采集帧长：CONFIG_AUDIO_CAPTURE_FRAME_MS 为 0 时取 AFE 喂入块的时长（32ms）
+    static int DefaultInputFrameSamples(int sample_rate);
+    // I2S DMA 参数：每个 DMA 缓冲区是默认采集帧的整数分之一，共缓冲 3 个采集帧
+    static uint32_t DmaFrameNum(int sample_rate);
+    static uint32_t DmaDescNum(int sample_rate);
+
 private:
-    std::function<bool()> on_input_ready_;
-    std::function<bool()> on_output_ready_;
-    
+#if !CONFIG_IDF_TARGET_LINUX
     IRAM_ATTR static bool on_recv(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
     IRAM_ATTR static bool on_sent(i2s_chan_handle_t handle, i2s_event_data_t *event, void *user_ctx);
+#endif
 
 protected:
+    // 不经过 I2S 的编解码器（如主机上的 WavFileAudioCodec）在 Start 中自行驱动这两个回调
+    std::function<bool()> on_input_ready_;
+    std::function<bool()> on_output_ready_;
+
+#if !CONFIG_IDF_TARGET_LINUX
     i2s_chan_handle_t tx_handle_ = nullptr;
     i2s_chan_handle_t rx_handle_ = nullptr;
+#endif
 
     bool duplex_ = false;
     bool input_reference_ = false;
@@ -54,6 +72,7 @@ protected:
     int input_channels_ = 1;
     int output_channels_ = 1;
     int output_volume_ = 70;
+    int input_frame_samples_ = 0;  // 0 表示按 DefaultInputFrameSamples 取值
 
     virtual int Read(int16_t* dest, int samples) = 0;
     virtual int Write(const int16_t* data, int samples) = 0;
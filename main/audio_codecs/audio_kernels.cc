@@ -0,0 +1,198 @@
+#include "audio_kernels.h"
+
+#include <sdkconfig.h>
+#include <algorithm>
+
+#if CONFIG_AUDIO_KERNELS_USE_PIE
+static inline bool IsAligned16(const void* p) {
+    return (reinterpret_cast<uintptr_t>(p) & 15) == 0;
+}
+#endif
+
+static inline int16_t SaturateSymmetric16(int32_t value) {
+    return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(value, -INT16_MAX), INT16_MAX));
+}
+
+static inline int16_t Saturate16(int32_t value) {
+    return static_cast<int16_t>(std::min<int32_t>(std::max<int32_t>(value, INT16_MIN), INT16_MAX));
+}
+
+// ---- 标量参考实现，保持与原有逐样本循环完全相同的语义 ----
+
+void AudioKernels::DeinterleaveReference(const int16_t* input, int16_t* left, int16_t* right, size_t frames) {
+    for (size_t i = 0; i < frames; i++) {
+        left[i] = input[i * 2];
+        right[i] = input[i * 2 + 1];
+    }
+}
+
+void AudioKernels::InterleaveReference(const int16_t* left, const int16_t* right, int16_t* output, size_t frames) {
+    for (size_t i = 0; i < frames; i++) {
+        output[i * 2] = left[i];
+        output[i * 2 + 1] = right[i];
+    }
+}
+
+void AudioKernels::Int32ToInt16Reference(const int32_t* input, int16_t* output, size_t samples, int shift) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t value = input[i] >> shift;
+        output[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value;
+    }
+}
+
+void AudioKernels::GainToInt32Reference(const int16_t* input, int32_t* output, size_t samples, int32_t gain_q16) {
+    for (size_t i = 0; i < samples; i++) {
+        int64_t temp = int64_t(input[i]) * gain_q16;
+        if (temp > INT32_MAX) {
+            output[i] = INT32_MAX;
+        } else if (temp < INT32_MIN) {
+            output[i] = INT32_MIN;
+        } else {
+            output[i] = static_cast<int32_t>(temp);
+        }
+    }
+}
+
+void AudioKernels::MixReference(const int16_t* a, const int16_t* b, int16_t* output, size_t samples) {
+    for (size_t i = 0; i < samples; i++) {
+        int32_t sum = int32_t(a[i]) + int32_t(b[i]);
+        output[i] = (sum > INT16_MAX) ? INT16_MAX : (sum < INT16_MIN) ? INT16_MIN : (int16_t)sum;
+    }
+}
+
+// ---- 默认实现 ----
+
+void AudioKernels::Deinterleave(const int16_t* input, int16_t* left, int16_t* right, size_t frames) {
+    size_t i = 0;
+#if CONFIG_AUDIO_KERNELS_USE_PIE
+    if (IsAligned16(input) && IsAligned16(left) && IsAligned16(right)) {
+        // 每次处理 8 帧：读入两个 128 位寄存器，按 16 位拆分奇偶元素后分别写出
+        const int16_t* in = input;
+        int16_t* l = left;
+        int16_t* r = right;
+        for (size_t blocks = frames / 8; blocks > 0; blocks--) {
+            asm volatile (
+                "ee.vld.128.ip q0, %0, 16\n"
+                "ee.vld.128.ip q1, %0, 16\n"
+                "ee.vunzip.16 q0, q1\n"
+                "ee.vst.128.ip q0, %1, 16\n"
+                "ee.vst.128.ip q1, %2, 16\n"
+                : "+r"(in), "+r"(l), "+r"(r)
+                :
+                : "memory");
+        }
+        i = frames & ~size_t(7);
+    }
+#endif
+    // 展开 4 次，让编译器把两路存储合并进同一个循环体
+    for (; i + 4 <= frames; i += 4) {
+        left[i] = input[i * 2];
+        right[i] = input[i * 2 + 1];
+        left[i + 1] = input[i * 2 + 2];
+        right[i + 1] = input[i * 2 + 3];
+        left[i + 2] = input[i * 2 + 4];
+        right[i + 2] = input[i * 2 + 5];
+        left[i + 3] = input[i * 2 + 6];
+        right[i + 3] = input[i * 2 + 7];
+    }
+    for (; i < frames; i++) {
+        left[i] = input[i * 2];
+        right[i] = input[i * 2 + 1];
+    }
+}
+
+void AudioKernels::Interleave(const int16_t* left, const int16_t* right, int16_t* output, size_t frames) {
+    size_t i = 0;
+#if CONFIG_AUDIO_KERNELS_USE_PIE
+    if (IsAligned16(left) && IsAligned16(right) && IsAligned16(output)) {
+        const int16_t* l = left;
+        const int16_t* r = right;
+        int16_t* out = output;
+        for (size_t blocks = frames / 8; blocks > 0; blocks--) {
+            asm volatile (
+                "ee.vld.128.ip q0, %0, 16\n"
+                "ee.vld.128.ip q1, %1, 16\n"
+                "ee.vzip.16 q0, q1\n"
+                "ee.vst.128.ip q0, %2, 16\n"
+                "ee.vst.128.ip q1, %2, 16\n"
+                : "+r"(l), "+r"(r), "+r"(out)
+                :
+                : "memory");
+        }
+        i = frames & ~size_t(7);
+    }
+#endif
+    for (; i + 4 <= frames; i += 4) {
+        output[i * 2] = left[i];
+        output[i * 2 + 1] = right[i];
+        output[i * 2 + 2] = left[i + 1];
+        output[i * 2 + 3] = right[i + 1];
+        output[i * 2 + 4] = left[i + 2];
+        output[i * 2 + 5] = right[i + 2];
+        output[i * 2 + 6] = left[i + 3];
+        output[i * 2 + 7] = right[i + 3];
+    }
+    for (; i < frames; i++) {
+        output[i * 2] = left[i];
+        output[i * 2 + 1] = right[i];
+    }
+}
+
+// PIE 没有带饱和的 32→16 位窄化指令，这里用 Xtensa 的 MIN/MAX 指令做无分支饱和
+void AudioKernels::Int32ToInt16(const int32_t* input, int16_t* output, size_t samples, int shift) {
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        output[i] = SaturateSymmetric16(input[i] >> shift);
+        output[i + 1] = SaturateSymmetric16(input[i + 1] >> shift);
+        output[i + 2] = SaturateSymmetric16(input[i + 2] >> shift);
+        output[i + 3] = SaturateSymmetric16(input[i + 3] >> shift);
+    }
+    for (; i < samples; i++) {
+        output[i] = SaturateSymmetric16(input[i] >> shift);
+    }
+}
+
+void AudioKernels::GainToInt32(const int16_t* input, int32_t* output, size_t samples, int32_t gain_q16) {
+    // 增益不超过 1.0 时 |input * gain| <= 2^31，32 位乘法不会溢出，也不需要饱和
+    if (gain_q16 < 0 || gain_q16 > 65536) {
+        GainToInt32Reference(input, output, samples, gain_q16);
+        return;
+    }
+    // 唯一的边界情况 -32768 * 65536 恰好等于 INT32_MIN，用无符号乘法避免有符号溢出的未定义行为
+    size_t i = 0;
+    for (; i + 4 <= samples; i += 4) {
+        output[i] = static_cast<int32_t>(uint32_t(int32_t(input[i])) * uint32_t(gain_q16));
+        output[i + 1] = static_cast<int32_t>(uint32_t(int32_t(input[i + 1])) * uint32_t(gain_q16));
+        output[i + 2] = static_cast<int32_t>(uint32_t(int32_t(input[i + 2])) * uint32_t(gain_q16));
+        output[i + 3] = static_cast<int32_t>(uint32_t(int32_t(input[i + 3])) * uint32_t(gain_q16));
+    }
+    for (; i < samples; i++) {
+        output[i] = static_cast<int32_t>(uint32_t(int32_t(input[i])) * uint32_t(gain_q16));
+    }
+}
+
+void AudioKernels::Mix(const int16_t* a, const int16_t* b, int16_t* output, size_t samples) {
+    size_t i = 0;
+#if CONFIG_AUDIO_KERNELS_USE_PIE
+    if (IsAligned16(a) && IsAligned16(b) && IsAligned16(output)) {
+        // 每次处理 8 个样本，ee.vadds.s16 为带饱和的 16 位加法
+        const int16_t* pa = a;
+        const int16_t* pb = b;
+        int16_t* out = output;
+        for (size_t blocks = samples / 8; blocks > 0; blocks--) {
+            asm volatile (
+                "ee.vld.128.ip q0, %0, 16\n"
+                "ee.vld.128.ip q1, %1, 16\n"
+                "ee.vadds.s16 q2, q0, q1\n"
+                "ee.vst.128.ip q2, %2, 16\n"
+                : "+r"(pa), "+r"(pb), "+r"(out)
+                :
+                : "memory");
+        }
+        i = samples & ~size_t(7);
+    }
+#endif
+    for (; i < samples; i++) {
+        output[i] = Saturate16(int32_t(a[i]) + int32_t(b[i]));
+    }
+}
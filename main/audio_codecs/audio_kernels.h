@@ -0,0 +1,31 @@
+#ifndef _AUDIO_KERNELS_H_
+#define _AUDIO_KERNELS_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// 音频采集/播放路径上的逐样本运算内核
+// 每个内核都有一个可移植的标量参考实现（*Reference），默认实现必须与其逐位一致
+// ESP32-S3 上在指针 16 字节对齐时使用 PIE 128 位向量指令，其余情况回退到展开的无分支标量实现
+// 与参考实现的比对见 test/host（标量路径）与 test/target（PIE 路径及每样本周期数）
+class AudioKernels {
+public:
+    // 将交织的双声道数据拆分为两个单声道缓冲区，frames 为每个声道的样本数
+    static void Deinterleave(const int16_t* input, int16_t* left, int16_t* right, size_t frames);
+    // 将两个单声道缓冲区合并为交织的双声道数据
+    static void Interleave(const int16_t* left, const int16_t* right, int16_t* output, size_t frames);
+    // 32 位样本算术右移 shift 位后饱和到 [-INT16_MAX, INT16_MAX]
+    static void Int32ToInt16(const int32_t* input, int16_t* output, size_t samples, int shift);
+    // 16 位样本乘以 Q16 增益（0-65536）后写出 32 位样本，结果饱和到 int32 范围
+    static void GainToInt32(const int16_t* input, int32_t* output, size_t samples, int32_t gain_q16);
+    // 两路 16 位样本饱和相加
+    static void Mix(const int16_t* a, const int16_t* b, int16_t* output, size_t samples);
+
+    static void DeinterleaveReference(const int16_t* input, int16_t* left, int16_t* right, size_t frames);
+    static void InterleaveReference(const int16_t* left, const int16_t* right, int16_t* output, size_t frames);
+    static void Int32ToInt16Reference(const int32_t* input, int16_t* output, size_t samples, int shift);
+    static void GainToInt32Reference(const int16_t* input, int32_t* output, size_t samples, int32_t gain_q16);
+    static void MixReference(const int16_t* a, const int16_t* b, int16_t* output, size_t samples);
+};
+
+#endif // _AUDIO_KERNELS_H_
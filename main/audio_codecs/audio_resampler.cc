@@ -0,0 +1,86 @@
+#include "audio_resampler.h"
+#include "audio_kernels.h"
+
+#include <esp_log.h>
+#include <sdkconfig.h>
+
+#define TAG "AudioResampler"
+
+AudioResampler::Engine AudioResampler::DefaultEngine() {
+#if CONFIG_AUDIO_RESAMPLER_POLYPHASE
+    return kEnginePolyphase;
+#else
+    return kEngineOpus;
+#endif
+}
+
+// 配置重采样器，重复调用会清空滤波器状态
+void AudioResampler::Configure(int input_sample_rate, int output_sample_rate, int channels, Engine engine) {
+    channels_ = channels;
+    enabled_ = input_sample_rate != output_sample_rate;
+    if (!enabled_) {
+        return;
+    }
+
+    engine_ = engine;
+    if (engine_ == kEnginePolyphase && !polyphase_.Configure(input_sample_rate, output_sample_rate, channels)) {
+        ESP_LOGW(TAG, "Polyphase engine does not support %d -> %d Hz x%d, using opus resampler",
+            input_sample_rate, output_sample_rate, channels);
+        engine_ = kEngineOpus;
+    }
+    if (engine_ == kEngineOpus) {
+        for (int i = 0; i < channels_ && i < PolyphaseResampler::kMaxChannels; i++) {
+            opus_[i].Configure(input_sample_rate, output_sample_rate);
+        }
+    }
+    ESP_LOGI(TAG, "Resampling %d -> %d Hz x%d with %s engine", input_sample_rate, output_sample_rate, channels,
+        engine_ == kEnginePolyphase ? "polyphase" : "opus");
+}
+
+size_t AudioResampler::GetOutputSamples(size_t input_samples) {
+    if (engine_ == kEnginePolyphase) {
+        return polyphase_.GetOutputFrames(input_samples / channels_) * channels_;
+    }
+    return opus_[0].GetOutputSamples(input_samples / channels_) * channels_;
+}
+
+size_t AudioResampler::Process(const int16_t* input, size_t input_samples, int16_t* output) {
+    if (engine_ == kEnginePolyphase) {
+        return polyphase_.Process(input, input_samples / channels_, output) * channels_;
+    }
+
+    size_t frames = input_samples / channels_;
+    if (channels_ == 1) {
+        opus_[0].Process(input, frames, output);
+        return opus_[0].GetOutputSamples(frames);
+    }
+
+    // Opus 引擎只处理单声道：拆分为各路分别重采样后再交织，拆分缓冲区的容量在首次使用后保留
+    size_t output_frames = opus_[0].GetOutputSamples(frames);
+    for (int i = 0; i < channels_; i++) {
+        split_[i].resize(frames);
+        resampled_[i].resize(output_frames);
+    }
+    if (channels_ == 2) {
+        AudioKernels::Deinterleave(input, split_[0].data(), split_[1].data(), frames);
+    } else {
+        for (size_t i = 0; i < frames; i++) {
+            for (int c = 0; c < channels_; c++) {
+                split_[c][i] = input[i * channels_ + c];
+            }
+        }
+    }
+    for (int i = 0; i < channels_; i++) {
+        opus_[i].Process(split_[i].data(), frames, resampled_[i].data());
+    }
+    if (channels_ == 2) {
+        AudioKernels::Interleave(resampled_[0].data(), resampled_[1].data(), output, output_frames);
+    } else {
+        for (size_t i = 0; i < output_frames; i++) {
+            for (int c = 0; c < channels_; c++) {
+                output[i * channels_ + c] = resampled_[c][i];
+            }
+        }
+    }
+    return output_frames * channels_;
+}
@@ -0,0 +1,42 @@
+#ifndef _AUDIO_RESAMPLER_H_
+#define _AUDIO_RESAMPLER_H_
+
+#include "polyphase_resampler.h"
+
+#include <opus_resampler.h>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 重采样器封装，可按实例选择引擎：
+// - kEnginePolyphase：定点多相 FIR，多声道一次处理，仅支持固定的几种比例
+// - kEngineOpus：OpusResampler，任意比例，多声道时拆分为各路分别处理
+// 选择多相引擎但比例不受支持时自动回退到 Opus 引擎
+class AudioResampler {
+public:
+    enum Engine {
+        kEngineOpus,
+        kEnginePolyphase,
+    };
+
+    static Engine DefaultEngine();
+
+    void Configure(int input_sample_rate, int output_sample_rate, int channels, Engine engine = DefaultEngine());
+    inline bool enabled() const { return enabled_; }
+    inline Engine engine() const { return engine_; }
+
+    // 输入/输出样本数均包含所有通道
+    size_t GetOutputSamples(size_t input_samples);
+    size_t Process(const int16_t* input, size_t input_samples, int16_t* output);
+
+private:
+    bool enabled_ = false;
+    Engine engine_ = kEngineOpus;
+    int channels_ = 1;
+    PolyphaseResampler polyphase_;
+    OpusResampler opus_[PolyphaseResampler::kMaxChannels];
+    std::vector<int16_t> split_[PolyphaseResampler::kMaxChannels];
+    std::vector<int16_t> resampled_[PolyphaseResampler::kMaxChannels];
+};
+
+#endif // _AUDIO_RESAMPLER_H_
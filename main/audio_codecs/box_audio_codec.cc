@@ -7,6 +7,10 @@
 // 定义日志标签
 static const char TAG[] = "BoxAudioCodec";
 
+// ES7210 的 TDM 时隙：时隙 0 为第一路麦克风，时隙 1 为回采参考，时隙 2、3 为其余麦克风
+static const int kMicSlots[] = {0, 2, 3};
+static const int kReferenceSlot = 1;
+
 // 构造函数，初始化 BoxAudioCodec 对象
 // 参数说明：
 // i2c_master_handle: I2C 主设备句柄
@@ -21,15 +25,20 @@ static const char TAG[] = "BoxAudioCodec";
 // es8311_addr: ES8311 编解码芯片的 I2C 地址
 // es7210_addr: ES7210 编解码芯片的 I2C 地址
 // input_reference: 是否使用参考输入以实现回声消除
+// input_mics: 送给 AFE 的麦克风路数，多于 1 路时由 AFE 做多麦克风的波束/盲源分离处理
 BoxAudioCodec::BoxAudioCodec(void* i2c_master_handle, int input_sample_rate, int output_sample_rate,
     gpio_num_t mclk, gpio_num_t bclk, gpio_num_t ws, gpio_num_t dout, gpio_num_t din,
-    gpio_num_t pa_pin, uint8_t es8311_addr, uint8_t es7210_addr, bool input_reference) {
+    gpio_num_t pa_pin, uint8_t es8311_addr, uint8_t es7210_addr, bool input_reference, int input_mics) {
     // 设置是否为双工模式
     duplex_ = true; 
     // 设置是否使用参考输入以实现回声消除
     input_reference_ = input_reference; 
-    // 根据是否使用参考输入确定输入通道数
-    input_channels_ = input_reference_ ? 2 : 1; 
+    // 选出麦克风与参考所在的时隙，输入通道数为麦克风路数加参考通道
+    input_map_.Configure(kMicSlots, sizeof(kMicSlots) / sizeof(kMicSlots[0]), input_mics, input_reference_ ? kReferenceSlot : -1);
+    input_channels_ = input_map_.channels();
+    for (int i = 0; i < input_channels_; i++) {
+        input_channel_mask_ |= ESP_CODEC_DEV_MAKE_CHANNEL_MASK(input_map_.read_slot(i));
+    }
     // 设置输入音频采样率
     input_sample_rate_ = input_sample_rate;
     // 设置输出音频采样率
@@ -115,7 +124,7 @@ BoxAudioCodec::BoxAudioCodec(void* i2c_master_handle, int input_sample_rate, int
     assert(input_dev_ != NULL);
 
     // 记录初始化完成日志
-    ESP_LOGI(TAG, "BoxAudioDevice initialized");
+    ESP_LOGI(TAG, "BoxAudioDevice initialized, %d mic(s)%s", input_map_.mics(), input_reference_ ? " + reference" : "");
 }
 
 // 析构函数，释放 BoxAudioCodec 对象占用的资源
@@ -158,8 +167,8 @@ void BoxAudioCodec::CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gpio_
     i2s_chan_config_t chan_cfg = {
         .id = I2S_NUM_0,
         .role = I2S_ROLE_MASTER,
-        .dma_desc_num = 6,
-        .dma_frame_num = 240,
+        .dma_desc_num = DmaDescNum(input_sample_rate_),
+        .dma_frame_num = DmaFrameNum(input_sample_rate_),
         .auto_clear_after_cb = true,
         .auto_clear_before_cb = false,
         .intr_priority = 0,
@@ -264,21 +273,20 @@ void BoxAudioCodec::EnableInput(bool enable) {
     }
     if (enable) {
         // 配置输入采样信息
+        // 选中的麦克风通道与参考通道（构造时按麦克风路数计算）
         esp_codec_dev_sample_info_t fs = {
             .bits_per_sample = 16,
             .channel = 4,
-            .channel_mask = ESP_CODEC_DEV_MAKE_CHANNEL_MASK(0),
+            .channel_mask = input_channel_mask_,
             .sample_rate = (uint32_t)output_sample_rate_,
             .mclk_multiple = 0,
         };
-        if (input_reference_) {
-            // 如果使用参考输入，添加参考通道掩码
-            fs.channel_mask |= ESP_CODEC_DEV_MAKE_CHANNEL_MASK(1);
-        }
         // 打开输入设备
         ESP_ERROR_CHECK(esp_codec_dev_open(input_dev_, &fs));
-        // 设置输入通道增益
-        ESP_ERROR_CHECK(esp_codec_dev_set_in_channel_gain(input_dev_, ESP_CODEC_DEV_MAKE_CHANNEL_MASK(0), 40.0));
+        // 设置各麦克风通道增益
+        for (int i = 0; i < input_map_.mics(); i++) {
+            ESP_ERROR_CHECK(esp_codec_dev_set_in_channel_gain(input_dev_, ESP_CODEC_DEV_MAKE_CHANNEL_MASK(kMicSlots[i]), 40.0));
+        }
     } else {
         // 关闭输入设备
         ESP_ERROR_CHECK(esp_codec_dev_close(input_dev_));
@@ -323,6 +331,8 @@ int BoxAudioCodec::Read(int16_t* dest, int samples) {
     if (input_enabled_) {
         // 如果输入已启用，从输入设备读取数据
         ESP_ERROR_CHECK_WITHOUT_ABORT(esp_codec_dev_read(input_dev_, (void*)dest, samples * sizeof(int16_t)));
+        // 读出顺序为时隙升序，逐帧重排为麦克风在前、参考在后
+        input_map_.Reorder(dest, samples);
     }
     return samples;
 }
@@ -2,6 +2,7 @@
 #define _BOX_AUDIO_CODEC_H
 
 #include "audio_codec.h"
+#include "tdm_channel_map.h"
 
 #include <esp_codec_dev.h>
 #include <esp_codec_dev_defaults.h>
@@ -18,6 +19,10 @@ private:
     esp_codec_dev_handle_t output_dev_ = nullptr;
     esp_codec_dev_handle_t input_dev_ = nullptr;
 
+    // 多麦克风模式下按 TDM 时隙顺序读出的各通道，在 Read 中重排为“麦克风在前、参考在后”
+    TdmChannelMap input_map_;
+    uint16_t input_channel_mask_ = 0;
+
     void CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk, gpio_num_t ws, gpio_num_t dout, gpio_num_t din);
 
     virtual int Read(int16_t* dest, int samples) override;
@@ -26,7 +31,7 @@ private:
 public:
     BoxAudioCodec(void* i2c_master_handle, int input_sample_rate, int output_sample_rate,
         gpio_num_t mclk, gpio_num_t bclk, gpio_num_t ws, gpio_num_t dout, gpio_num_t din,
-        gpio_num_t pa_pin, uint8_t es8311_addr, uint8_t es7210_addr, bool input_reference);
+        gpio_num_t pa_pin, uint8_t es8311_addr, uint8_t es7210_addr, bool input_reference, int input_mics = 1);
     virtual ~BoxAudioCodec();
 
     virtual void SetOutputVolume(int volume) override;
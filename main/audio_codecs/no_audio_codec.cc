@@ -1,4 +1,5 @@
 #include "no_audio_codec.h"
+#include "audio_kernels.h"
 
 #include <esp_log.h>
 #include <cmath>
@@ -25,8 +26,8 @@ NoAudioCodecDuplex::NoAudioCodecDuplex(int input_sample_rate, int output_sample_
     i2s_chan_config_t chan_cfg = {
         .id = I2S_NUM_0, // I2S端口号
         .role = I2S_ROLE_MASTER, // 主模式
-        .dma_desc_num = 6, // DMA描述符数量
-        .dma_frame_num = 240, // DMA帧数
+        .dma_desc_num = DmaDescNum(input_sample_rate_), // DMA描述符数量
+        .dma_frame_num = DmaFrameNum(input_sample_rate_), // DMA帧数
         .auto_clear_after_cb = true, // 回调后自动清除
         .auto_clear_before_cb = false, // 回调前不自动清除
         .intr_priority = 0, // 中断优先级
@@ -85,8 +86,8 @@ ATK_NoAudioCodecDuplex::ATK_NoAudioCodecDuplex(int input_sample_rate, int output
     i2s_chan_config_t chan_cfg = {
         .id = I2S_NUM_0, // I2S端口号
         .role = I2S_ROLE_MASTER, // 主模式
-        .dma_desc_num = 6, // DMA描述符数量
-        .dma_frame_num = 240, // DMA帧数
+        .dma_desc_num = DmaDescNum(input_sample_rate_), // DMA描述符数量
+        .dma_frame_num = DmaFrameNum(input_sample_rate_), // DMA帧数
         .auto_clear_after_cb = true, // 回调后自动清除
         .auto_clear_before_cb = false, // 回调前不自动清除
         .intr_priority = 0, // 中断优先级
@@ -194,6 +195,8 @@ NoAudioCodecSimplex::NoAudioCodecSimplex(int input_sample_rate, int output_sampl
 
     // 创建麦克风通道
     chan_cfg.id = (i2s_port_t)1; // I2S端口号
+    chan_cfg.dma_desc_num = DmaDescNum(input_sample_rate_); // DMA描述符数量，与采集帧对齐
+    chan_cfg.dma_frame_num = DmaFrameNum(input_sample_rate_); // DMA帧数
     ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, nullptr, &rx_handle_)); // 创建I2S通道
     std_cfg.clk_cfg.sample_rate_hz = (uint32_t)input_sample_rate_; // 采样率
     std_cfg.gpio_cfg.bclk = mic_sck; // BCLK引脚
@@ -263,6 +266,8 @@ NoAudioCodecSimplex::NoAudioCodecSimplex(int input_sample_rate, int output_sampl
 
     // 创建麦克风通道
     chan_cfg.id = (i2s_port_t)1; // I2S端口号
+    chan_cfg.dma_desc_num = DmaDescNum(input_sample_rate_); // DMA描述符数量，与采集帧对齐
+    chan_cfg.dma_frame_num = DmaFrameNum(input_sample_rate_); // DMA帧数
     ESP_ERROR_CHECK(i2s_new_channel(&chan_cfg, nullptr, &rx_handle_)); // 创建I2S通道
     std_cfg.clk_cfg.sample_rate_hz = (uint32_t)input_sample_rate_; // 采样率
     std_cfg.slot_cfg.slot_mask = mic_slot_mask; // 自定义槽位掩码
@@ -318,6 +323,8 @@ NoAudioCodecSimplexPdm::NoAudioCodecSimplexPdm(int input_sample_rate, int output
 #if SOC_I2S_SUPPORTS_PDM_RX
     // 创建麦克风通道，PDM模式
     i2s_chan_config_t rx_chan_cfg = I2S_CHANNEL_DEFAULT_CONFIG((i2s_port_t)0, I2S_ROLE_MASTER); // 默认配置
+    rx_chan_cfg.dma_desc_num = DmaDescNum(input_sample_rate_); // DMA描述符数量，与采集帧对齐
+    rx_chan_cfg.dma_frame_num = DmaFrameNum(input_sample_rate_); // DMA帧数
     ESP_ERROR_CHECK(i2s_new_channel(&rx_chan_cfg, NULL, &rx_handle_)); // 创建I2S通道
     i2s_pdm_rx_config_t pdm_rx_cfg = {
         .clk_cfg = I2S_PDM_RX_CLK_DEFAULT_CONFIG((uint32_t)input_sample_rate_), // 默认时钟配置
@@ -345,16 +352,7 @@ int NoAudioCodec::Write(const int16_t* data, int samples) {
     // output_volume_: 0-100
     // volume_factor_: 0-65536
     int32_t volume_factor = pow(double(output_volume_) / 100.0, 2) * 65536; // 计算音量因子
-    for (int i = 0; i < samples; i++) {
-        int64_t temp = int64_t(data[i]) * volume_factor; // 使用 int64_t 进行乘法运算
-        if (temp > INT32_MAX) {
-            buffer[i] = INT32_MAX; // 限制最大值
-        } else if (temp < INT32_MIN) {
-            buffer[i] = INT32_MIN; // 限制最小值
-        } else {
-            buffer[i] = static_cast<int32_t>(temp); // 转换为int32_t
-        }
-    }
+    AudioKernels::GainToInt32(data, buffer.data(), samples, volume_factor); // 乘以音量因子并限制到 int32 范围
 
     size_t bytes_written;
     ESP_ERROR_CHECK(i2s_channel_write(tx_handle_, buffer.data(), samples * sizeof(int32_t), &bytes_written, portMAX_DELAY)); // 写入数据
@@ -372,9 +370,6 @@ int NoAudioCodec::Read(int16_t* dest, int samples) {
     }
 
     samples = bytes_read / sizeof(int32_t); // 计算样本数
-    for (int i = 0; i < samples; i++) {
-        int32_t value = bit32_buffer[i] >> 12; // 右移12位
-        dest[i] = (value > INT16_MAX) ? INT16_MAX : (value < -INT16_MAX) ? -INT16_MAX : (int16_t)value; // 限制值范围
-    }
+    AudioKernels::Int32ToInt16(bit32_buffer.data(), dest, samples, 12); // 右移12位并限制值范围
     return samples; // 返回读取的样本数
 }
\ No newline at end of file
@@ -0,0 +1,208 @@
+#include "polyphase_resampler.h"
+
+#include <array>
+#include <cstring>
+#include <algorithm>
+
+namespace {
+
+// ---- 编译期滤波器设计 ----
+
+constexpr double kPi = 3.14159265358979323846;
+
+constexpr double ConstSin(double x) {
+    // 先归约到 [-pi, pi]，再用泰勒级数
+    double turns = x / (2 * kPi);
+    long long n = (long long)(turns >= 0 ? turns + 0.5 : turns - 0.5);
+    x -= n * 2 * kPi;
+    double term = x;
+    double sum = x;
+    for (int i = 1; i < 16; i++) {
+        term *= -x * x / ((2 * i) * (2 * i + 1));
+        sum += term;
+    }
+    return sum;
+}
+
+constexpr double ConstSqrt(double x) {
+    if (x <= 0) {
+        return 0;
+    }
+    double r = x > 1 ? x : 1;
+    for (int i = 0; i < 64; i++) {
+        r = 0.5 * (r + x / r);
+    }
+    return r;
+}
+
+// 第一类零阶修正贝塞尔函数，用于 Kaiser 窗
+constexpr double BesselI0(double x) {
+    double sum = 1;
+    double term = 1;
+    double q = x * x / 4;
+    for (int k = 1; k < 40; k++) {
+        term *= q / (double(k) * k);
+        sum += term;
+    }
+    return sum;
+}
+
+// 设计 L/M 重采样的原型低通滤波器（在 L 倍上采样率上，截止频率为输入/输出奈奎斯特频率中较小者的 90%），
+// 按相位重排并把每个相位的直流增益归一化到 1 后量化为 Q15
+template <int L, int M, int T>
+constexpr std::array<int16_t, L * T> DesignPolyphase() {
+    constexpr int N = L * T;
+    constexpr double beta = 7.0;
+    double cutoff = 0.5 * 0.9 / (L > M ? L : M);
+    double center = (N - 1) / 2.0;
+    double i0_beta = BesselI0(beta);
+
+    double h[N] = {};
+    for (int n = 0; n < N; n++) {
+        double t = n - center;
+        double sinc = t == 0 ? 2 * cutoff : ConstSin(2 * kPi * cutoff * t) / (kPi * t);
+        double r = t / center;
+        double window = BesselI0(beta * ConstSqrt(1 - r * r)) / i0_beta;
+        h[n] = sinc * window;
+    }
+
+    std::array<int16_t, N> table = {};
+    for (int p = 0; p < L; p++) {
+        double sum = 0;
+        for (int k = 0; k < T; k++) {
+            sum += h[p + k * L];
+        }
+        for (int k = 0; k < T; k++) {
+            double v = h[p + k * L] / sum * 32768.0;
+            long long q = (long long)(v >= 0 ? v + 0.5 : v - 0.5);
+            table[p * T + k] = (int16_t)(q > 32767 ? 32767 : q < -32768 ? -32768 : q);
+        }
+    }
+    return table;
+}
+
+struct RatioTable {
+    int input_sample_rate;
+    int output_sample_rate;
+    int interpolation;
+    int decimation;
+    int taps;
+    const int16_t* coeffs;
+};
+
+constexpr auto kTable24kTo16k = DesignPolyphase<2, 3, 32>();
+constexpr auto kTable48kTo16k = DesignPolyphase<1, 3, 64>();
+constexpr auto kTable16kTo24k = DesignPolyphase<3, 2, 16>();
+constexpr auto kTable16kTo44k1 = DesignPolyphase<441, 160, 16>();
+
+const RatioTable kRatioTables[] = {
+    {24000, 16000, 2, 3, 32, kTable24kTo16k.data()},
+    {48000, 16000, 1, 3, 64, kTable48kTo16k.data()},
+    {16000, 24000, 3, 2, 16, kTable16kTo24k.data()},
+    {16000, 44100, 441, 160, 16, kTable16kTo44k1.data()},
+};
+
+const RatioTable* FindRatio(int input_sample_rate, int output_sample_rate) {
+    for (auto& table : kRatioTables) {
+        if (table.input_sample_rate == input_sample_rate && table.output_sample_rate == output_sample_rate) {
+            return &table;
+        }
+    }
+    return nullptr;
+}
+
+inline int16_t Round15(int32_t acc) {
+    acc = (acc + (1 << 14)) >> 15;
+    return (int16_t)std::min<int32_t>(std::max<int32_t>(acc, INT16_MIN), INT16_MAX);
+}
+
+} // namespace
+
+bool PolyphaseResampler::IsSupported(int input_sample_rate, int output_sample_rate) {
+    return FindRatio(input_sample_rate, output_sample_rate) != nullptr;
+}
+
+// 选择系数表并清空状态，不支持的比例或通道数返回 false
+bool PolyphaseResampler::Configure(int input_sample_rate, int output_sample_rate, int channels) {
+    auto table = FindRatio(input_sample_rate, output_sample_rate);
+    if (table == nullptr || channels < 1 || channels > kMaxChannels) {
+        coeffs_ = nullptr;
+        return false;
+    }
+    coeffs_ = table->coeffs;
+    interpolation_ = table->interpolation;
+    decimation_ = table->decimation;
+    taps_ = table->taps;
+    channels_ = channels;
+    Reset();
+    return true;
+}
+
+void PolyphaseResampler::Reset() {
+    position_ = 0;
+    memset(history_, 0, sizeof(history_));
+}
+
+size_t PolyphaseResampler::GetOutputFrames(size_t input_frames) const {
+    uint32_t limit = input_frames * interpolation_;
+    if (position_ >= limit) {
+        return 0;
+    }
+    return (limit - position_ + decimation_ - 1) / decimation_;
+}
+
+size_t PolyphaseResampler::Process(const int16_t* input, size_t input_frames, int16_t* output) {
+    if (coeffs_ == nullptr) {
+        return 0;
+    }
+    switch (channels_) {
+    case 2:
+        return ProcessChannels<2>(input, input_frames, output);
+    case 3:
+        return ProcessChannels<3>(input, input_frames, output);
+    case 4:
+        return ProcessChannels<4>(input, input_frames, output);
+    default:
+        return ProcessChannels<1>(input, input_frames, output);
+    }
+}
+
+// 输出 y[n] = sum_k h[phase][k] * x[base - k]，base/phase 由上采样时间轴上的位置决定
+// 输入块开头的 taps-1 个输出需要上一块的尾部数据，这部分从拼接了历史数据的 edge_ 中读取，其余直接读取输入
+template <int C>
+size_t PolyphaseResampler::ProcessChannels(const int16_t* input, size_t input_frames, int16_t* output) {
+    const size_t history = taps_ - 1;
+    const size_t head = std::min(history, input_frames);
+    memcpy(edge_, history_, history * C * sizeof(int16_t));
+    memcpy(edge_ + history * C, input, head * C * sizeof(int16_t));
+
+    const uint32_t limit = input_frames * interpolation_;
+    size_t produced = 0;
+    while (position_ < limit) {
+        size_t base = position_ / interpolation_;
+        const int16_t* h = coeffs_ + (position_ % interpolation_) * taps_;
+        const int16_t* x = base < history ? edge_ + (base + history) * C : input + base * C;
+
+        int32_t acc[C] = {};
+        for (int k = 0; k < taps_; k++) {
+            for (int c = 0; c < C; c++) {
+                acc[c] += int32_t(h[k]) * x[-k * C + c];
+            }
+        }
+        for (int c = 0; c < C; c++) {
+            output[produced * C + c] = Round15(acc[c]);
+        }
+        produced++;
+        position_ += decimation_;
+    }
+    position_ -= limit;
+
+    // 保存最后 taps-1 帧作为下一块的历史数据
+    if (input_frames >= history) {
+        memcpy(history_, input + (input_frames - history) * C, history * C * sizeof(int16_t));
+    } else {
+        memmove(history_, history_ + input_frames * C, (history - input_frames) * C * sizeof(int16_t));
+        memcpy(history_ + (history - input_frames) * C, input, input_frames * C * sizeof(int16_t));
+    }
+    return produced;
+}
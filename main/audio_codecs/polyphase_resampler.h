@@ -0,0 +1,39 @@
+#ifndef _POLYPHASE_RESAMPLER_H_
+#define _POLYPHASE_RESAMPLER_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// 定点多相 FIR 重采样器，系数表在编译期按固定比例生成（Kaiser 窗 sinc，Q15）
+// 支持 24k→16k、48k→16k、16k→24k、16k→44.1k，单声道或交织的多声道（麦克风+参考）一次处理
+// 流式接口：状态保存在对象内，输出写入调用方提供的缓冲区，处理过程中不分配内存
+class PolyphaseResampler {
+public:
+    static constexpr int kMaxTaps = 64;     // 每个相位的最大抽头数
+    static constexpr int kMaxChannels = 4;
+
+    static bool IsSupported(int input_sample_rate, int output_sample_rate);
+
+    bool Configure(int input_sample_rate, int output_sample_rate, int channels);
+    void Reset();
+    // 下一次 Process 输入 input_frames 帧时输出的确切帧数
+    size_t GetOutputFrames(size_t input_frames) const;
+    // 处理交织的输入帧，返回写入 output 的帧数
+    size_t Process(const int16_t* input, size_t input_frames, int16_t* output);
+
+private:
+    const int16_t* coeffs_ = nullptr;  // 按相位排列：coeffs_[phase * taps_ + k]
+    int interpolation_ = 1;            // L
+    int decimation_ = 1;               // M
+    int taps_ = 0;
+    int channels_ = 1;
+    uint32_t position_ = 0;            // 下一个输出在上采样时间轴上相对当前输入块起点的位置
+
+    int16_t history_[(kMaxTaps - 1) * kMaxChannels] = {};
+    int16_t edge_[(kMaxTaps - 1) * 2 * kMaxChannels] = {};
+
+    template <int C>
+    size_t ProcessChannels(const int16_t* input, size_t input_frames, int16_t* output);
+};
+
+#endif // _POLYPHASE_RESAMPLER_H_
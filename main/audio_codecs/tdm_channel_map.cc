@@ -0,0 +1,44 @@
+#include "tdm_channel_map.h"
+
+#include <algorithm>
+#include <cstring>
+
+void TdmChannelMap::Configure(const int* mic_slots, int mic_slot_count, int mics, int reference_slot) {
+    int max_mics = std::min(mic_slot_count, reference_slot >= 0 ? kMaxChannels - 1 : kMaxChannels);
+    mics_ = std::max(1, std::min(mics, max_mics));
+
+    // 输出顺序对应的时隙
+    int output_slots[kMaxChannels];
+    channels_ = 0;
+    for (int i = 0; i < mics_; i++) {
+        output_slots[channels_++] = mic_slots[i];
+    }
+    if (reference_slot >= 0) {
+        output_slots[channels_++] = reference_slot;
+    }
+
+    // 读出顺序为时隙升序，输出第 i 个通道在读出帧中的位置即比它小的时隙个数
+    reorder_ = false;
+    for (int i = 0; i < channels_; i++) {
+        int position = 0;
+        for (int j = 0; j < channels_; j++) {
+            position += output_slots[j] < output_slots[i];
+        }
+        order_[i] = position;
+        read_slots_[position] = output_slots[i];
+        reorder_ |= position != i;
+    }
+}
+
+void TdmChannelMap::Reorder(int16_t* data, size_t samples) const {
+    if (!reorder_) {
+        return;
+    }
+    int16_t frame[kMaxChannels];
+    for (size_t i = 0; i + channels_ <= samples; i += channels_) {
+        memcpy(frame, data + i, channels_ * sizeof(int16_t));
+        for (int c = 0; c < channels_; c++) {
+            data[i + c] = frame[order_[c]];
+        }
+    }
+}
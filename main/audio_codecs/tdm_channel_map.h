@@ -0,0 +1,35 @@
+#ifndef _TDM_CHANNEL_MAP_H_
+#define _TDM_CHANNEL_MAP_H_
+
+#include <cstdint>
+#include <cstddef>
+
+// TDM 多通道采集的时隙选择与通道重排
+// I2S 按时隙升序读出选中的通道，重排为“麦克风在前（按麦克风顺序）、参考在后”交给 AFE
+// 只做数据搬移，不依赖外设，可以在主机上测试
+class TdmChannelMap {
+public:
+    static constexpr int kMaxChannels = 4;
+
+    // mic_slots 为各路麦克风所在的时隙（共 mic_slot_count 个可用），使用其中前 mics 路（限定在 [1, mic_slot_count]）
+    // reference_slot 为回采参考所在的时隙，小于 0 表示不使用参考
+    void Configure(const int* mic_slots, int mic_slot_count, int mics, int reference_slot);
+
+    int mics() const { return mics_; }
+    int channels() const { return channels_; }
+    // 按时隙升序的第 i 个读出通道所在的时隙
+    int read_slot(int i) const { return read_slots_[i]; }
+    bool needs_reorder() const { return reorder_; }
+
+    // 原地把按时隙升序读出的交织数据重排为输出顺序，不足一帧的尾部保持不变
+    void Reorder(int16_t* data, size_t samples) const;
+
+private:
+    int mics_ = 1;
+    int channels_ = 1;
+    int read_slots_[kMaxChannels] = {0, 1, 2, 3};
+    int order_[kMaxChannels] = {0, 1, 2, 3};  // 输出第 i 个通道取读出帧中的第 order_[i] 个
+    bool reorder_ = false;
+};
+
+#endif // _TDM_CHANNEL_MAP_H_
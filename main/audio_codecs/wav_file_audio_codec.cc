@@ -0,0 +1,218 @@
+#include "wav_file_audio_codec.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstring>
+#include <algorithm>
+
+#define TAG "WavFileAudioCodec"
+
+// 输入/输出就绪回调的节拍，与 I2S DMA 的中断间隔同量级
+#define CLOCK_TICK_MS 10
+
+struct WavHeader {
+    char riff[4];
+    uint32_t riff_size;
+    char wave[4];
+    char fmt[4];
+    uint32_t fmt_size;
+    uint16_t format;
+    uint16_t channels;
+    uint32_t sample_rate;
+    uint32_t byte_rate;
+    uint16_t block_align;
+    uint16_t bits_per_sample;
+    char data[4];
+    uint32_t data_size;
+} __attribute__((packed));
+
+WavFileAudioCodec::WavFileAudioCodec(const std::string& input_path, const std::string& output_path,
+    int output_sample_rate, bool realtime) : realtime_(realtime) {
+    duplex_ = true;
+    input_sample_rate_ = 16000;
+    output_sample_rate_ = output_sample_rate;
+    output_channels_ = 1;
+
+    if (!OpenInput(input_path)) {
+        input_finished_ = true;
+    }
+    // 多于一个声道时最后一个声道为参考，其余为麦克风（与 BoxAudioCodec 多麦克风模式的排列相同）
+    input_reference_ = input_channels_ >= 2;
+    OpenOutput(output_path);
+    ESP_LOGI(TAG, "Input %s (%d Hz x%d), output %s (%d Hz), %s", input_path.c_str(), input_sample_rate_,
+        input_channels_, output_path.c_str(), output_sample_rate_, realtime_ ? "realtime" : "as fast as possible");
+}
+
+WavFileAudioCodec::~WavFileAudioCodec() {
+    if (clock_task_handle_ != nullptr) {
+        vTaskDelete(clock_task_handle_);
+    }
+    if (input_file_ != nullptr) {
+        fclose(input_file_);
+    }
+    if (output_file_ != nullptr) {
+        UpdateOutputHeader();
+        fclose(output_file_);
+    }
+}
+
+// 解析 RIFF 头，跳过 fmt 之后的 LIST 等附加块，文件指针停在 PCM 数据起点
+bool WavFileAudioCodec::OpenInput(const std::string& path) {
+    input_file_ = fopen(path.c_str(), "rb");
+    if (input_file_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to open input %s", path.c_str());
+        return false;
+    }
+
+    char riff[12];
+    if (fread(riff, 1, sizeof(riff), input_file_) != sizeof(riff) || memcmp(riff, "RIFF", 4) != 0 || memcmp(riff + 8, "WAVE", 4) != 0) {
+        ESP_LOGE(TAG, "Input %s is not a WAV file", path.c_str());
+        return false;
+    }
+
+    bool has_format = false;
+    while (true) {
+        char id[4];
+        uint32_t size;
+        if (fread(id, 1, 4, input_file_) != 4 || fread(&size, 1, 4, input_file_) != 4) {
+            ESP_LOGE(TAG, "Input %s has no data chunk", path.c_str());
+            return false;
+        }
+        if (memcmp(id, "fmt ", 4) == 0) {
+            uint8_t format[16];
+            if (size < sizeof(format) || fread(format, 1, sizeof(format), input_file_) != sizeof(format)) {
+                return false;
+            }
+            uint16_t tag, channels, bits;
+            uint32_t sample_rate;
+            memcpy(&tag, format, 2);
+            memcpy(&channels, format + 2, 2);
+            memcpy(&sample_rate, format + 4, 4);
+            memcpy(&bits, format + 14, 2);
+            if (tag != 1 || bits != 16 || channels < 1 || channels > 3) {
+                ESP_LOGE(TAG, "Input %s must be 16-bit PCM with 1 to 3 channels", path.c_str());
+                return false;
+            }
+            input_sample_rate_ = sample_rate;
+            input_channels_ = channels;
+            has_format = true;
+            fseek(input_file_, size - sizeof(format) + (size & 1), SEEK_CUR);
+        } else if (memcmp(id, "data", 4) == 0) {
+            return has_format;
+        } else {
+            fseek(input_file_, size + (size & 1), SEEK_CUR);
+        }
+    }
+}
+
+bool WavFileAudioCodec::OpenOutput(const std::string& path) {
+    output_file_ = fopen(path.c_str(), "wb");
+    if (output_file_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to open output %s", path.c_str());
+        return false;
+    }
+    UpdateOutputHeader();
+    return true;
+}
+
+void WavFileAudioCodec::UpdateOutputHeader() {
+    WavHeader header;
+    memcpy(header.riff, "RIFF", 4);
+    header.riff_size = sizeof(WavHeader) - 8 + output_data_bytes_;
+    memcpy(header.wave, "WAVE", 4);
+    memcpy(header.fmt, "fmt ", 4);
+    header.fmt_size = 16;
+    header.format = 1;
+    header.channels = output_channels_;
+    header.sample_rate = output_sample_rate_;
+    header.byte_rate = output_sample_rate_ * output_channels_ * sizeof(int16_t);
+    header.block_align = output_channels_ * sizeof(int16_t);
+    header.bits_per_sample = 16;
+    memcpy(header.data, "data", 4);
+    header.data_size = output_data_bytes_;
+
+    fseek(output_file_, 0, SEEK_SET);
+    fwrite(&header, sizeof(header), 1, output_file_);
+    fseek(output_file_, 0, SEEK_END);
+    fflush(output_file_);
+}
+
+// 不经过 I2S：由时钟任务按节拍调用输入/输出就绪回调，代替 DMA 中断
+void WavFileAudioCodec::Start() {
+    EnableInput(true);
+    EnableOutput(true);
+    xTaskCreate([](void* arg) {
+        WavFileAudioCodec* codec = (WavFileAudioCodec*)arg;
+        codec->ClockTaskLoop();
+    }, "wav_clock", 4096, this, 5, &clock_task_handle_);
+}
+
+// 主机上不保存音量设置
+void WavFileAudioCodec::SetOutputVolume(int volume) {
+    output_volume_ = volume;
+    ESP_LOGI(TAG, "Set output volume to %d", output_volume_);
+}
+
+void WavFileAudioCodec::ClockTaskLoop() {
+    while (true) {
+        if (input_enabled_ && !input_finished_ && on_input_ready_) {
+            on_input_ready_();
+        }
+        if (output_enabled_ && on_output_ready_) {
+            on_output_ready_();
+        }
+        vTaskDelay(pdMS_TO_TICKS(CLOCK_TICK_MS));
+    }
+}
+
+// 实时模式下等待到第 samples 个样本对应的墙上时间，模拟 I2S 的阻塞读写
+void WavFileAudioCodec::SleepUntil(int64_t start_time, uint64_t samples, int sample_rate) {
+    if (!realtime_) {
+        return;
+    }
+    int64_t deadline = start_time + (int64_t)(samples * 1000000 / sample_rate);
+    int64_t wait_us = deadline - esp_timer_get_time();
+    if (wait_us > 0) {
+        vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+    }
+}
+
+int WavFileAudioCodec::Read(int16_t* dest, int samples) {
+    if (input_file_ == nullptr || input_finished_) {
+        return 0;
+    }
+    if (input_samples_read_ == 0) {
+        input_start_time_ = esp_timer_get_time();
+    }
+    int count = fread(dest, sizeof(int16_t), samples, input_file_);
+    if (count < samples) {
+        // 文件末尾不足一帧时补零，保持帧长不变
+        std::fill(dest + count, dest + samples, 0);
+        input_finished_ = true;
+        ESP_LOGI(TAG, "Input finished after %llu samples", (unsigned long long)(input_samples_read_ + count));
+    }
+    input_samples_read_ += samples;
+    SleepUntil(input_start_time_, input_samples_read_ / input_channels_, input_sample_rate_);
+    return count > 0 ? samples : 0;
+}
+
+int WavFileAudioCodec::Write(const int16_t* data, int samples) {
+    if (output_file_ == nullptr) {
+        return 0;
+    }
+    // 两次写入之间的空档超过 1 帧时重新对齐时钟，等同于 I2S 在空闲时输出静音
+    int64_t now = esp_timer_get_time();
+    uint64_t elapsed_samples = (uint64_t)(now - output_start_time_) * output_sample_rate_ / 1000000;
+    if (output_samples_written_ == 0 || elapsed_samples > output_samples_written_ + samples) {
+        output_start_time_ = now;
+        output_samples_written_ = 0;
+    }
+
+    fwrite(data, sizeof(int16_t), samples, output_file_);
+    output_data_bytes_ += samples * sizeof(int16_t);
+    UpdateOutputHeader();
+
+    output_samples_written_ += samples;
+    SleepUntil(output_start_time_, output_samples_written_, output_sample_rate_);
+    return samples;
+}
@@ -0,0 +1,48 @@
+#ifndef _WAV_FILE_AUDIO_CODEC_H
+#define _WAV_FILE_AUDIO_CODEC_H
+
+#include "audio_codec.h"
+
+#include <freertos/task.h>
+#include <cstdio>
+#include <cstdint>
+#include <string>
+
+// 以 WAV 文件代替 I2S 的编解码器，用于在主机上回放录制的会话并测量音频链路
+// 输入：16 位 PCM WAV，单声道、双声道（麦克风+参考）或三声道（两路麦克风+参考），采样率取自文件头
+// 输出：写入 16 位单声道 WAV，文件头在每次写入后更新，进程中途退出时文件依然有效
+// realtime 为 true 时按墙上时钟节拍读写，模拟 I2S 的阻塞；否则尽快处理
+class WavFileAudioCodec : public AudioCodec {
+public:
+    WavFileAudioCodec(const std::string& input_path, const std::string& output_path, int output_sample_rate, bool realtime);
+    virtual ~WavFileAudioCodec();
+
+    virtual void Start() override;
+    virtual void SetOutputVolume(int volume) override;
+
+    // 输入文件是否已读完
+    inline bool input_finished() const { return input_finished_; }
+
+private:
+    FILE* input_file_ = nullptr;
+    FILE* output_file_ = nullptr;
+    bool realtime_;
+    bool input_finished_ = false;
+    uint32_t output_data_bytes_ = 0;
+    int64_t input_start_time_ = 0;
+    int64_t output_start_time_ = 0;
+    uint64_t input_samples_read_ = 0;
+    uint64_t output_samples_written_ = 0;
+    TaskHandle_t clock_task_handle_ = nullptr;
+
+    bool OpenInput(const std::string& path);
+    bool OpenOutput(const std::string& path);
+    void UpdateOutputHeader();
+    void SleepUntil(int64_t start_time, uint64_t samples, int sample_rate);
+    void ClockTaskLoop();
+
+    virtual int Read(int16_t* dest, int samples) override;
+    virtual int Write(const int16_t* data, int samples) override;
+};
+
+#endif // _WAV_FILE_AUDIO_CODEC_H
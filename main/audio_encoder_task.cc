@@ -0,0 +1,150 @@
+#include "audio_encoder_task.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <algorithm>
+
+#define TAG "AudioEncoderTask"
+
+#define ENCODER_TASK_STACK_SIZE (4096 * 8)
+
+// 构造函数，创建有界帧队列和固定在 core_id 上的编码任务
+AudioEncoderTask::AudioEncoderTask(OpusFrameEncoder* encoder, AudioFramePool* pool, size_t queue_length, BaseType_t core_id)
+    : encoder_(encoder), pool_(pool) {
+    queue_ = xQueueCreate(queue_length, sizeof(AudioFrame*));
+
+    // Opus 编码需要较大的栈，优先放在 PSRAM 中
+    task_stack_ = (StackType_t*)heap_caps_malloc(ENCODER_TASK_STACK_SIZE, MALLOC_CAP_SPIRAM);
+    if (task_stack_ == nullptr) {
+        task_stack_ = (StackType_t*)heap_caps_malloc(ENCODER_TASK_STACK_SIZE, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    task_handle_ = xTaskCreateStaticPinnedToCore([](void* arg) {
+        AudioEncoderTask* task = (AudioEncoderTask*)arg;
+        task->EncoderTaskLoop();
+    }, "audio_encoder", ENCODER_TASK_STACK_SIZE, this, 3, task_stack_, &task_buffer_, core_id);
+}
+
+// 析构函数，释放资源
+AudioEncoderTask::~AudioEncoderTask() {
+    if (task_handle_ != nullptr) {
+        vTaskDelete(task_handle_);
+    }
+    AudioFrame* frame;
+    while (xQueueReceive(queue_, &frame, 0) == pdTRUE) {
+        pool_->Release(frame);
+    }
+    vQueueDelete(queue_);
+    heap_caps_free(task_stack_);
+}
+
+// 设置编码后数据包的发送回调，在编码任务中调用，回调必须是线程安全的
+void AudioEncoderTask::OnPacket(std::function<void(const std::vector<uint8_t>& opus, int64_t capture_time_us)> callback) {
+    packet_callback_ = callback;
+}
+
+// 提交一帧 PCM，帧的所有权交给编码任务；队列已满时直接归还帧池并计数
+bool AudioEncoderTask::Push(AudioFrame* frame) {
+    frame->timestamp_us = esp_timer_get_time();
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (xQueueSend(queue_, &frame, 0) != pdTRUE) {
+        dropped_++;
+        pool_->Release(frame);
+        return false;
+    }
+    pending_frames_++;
+    return true;
+}
+
+// 等待已提交的帧全部编码并发送完成，在重置编码器状态前调用
+void AudioEncoderTask::WaitForCompletion() {
+    std::unique_lock<std::mutex> lock(mutex_);
+    condition_variable_.wait(lock, [this]() {
+        return pending_frames_ == 0;
+    });
+}
+
+AudioEncoderTask::Stats AudioEncoderTask::GetStats(bool reset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.frames = frames_;
+    stats.packets = packets_;
+    stats.dropped = dropped_;
+    stats.queue_avg_us = frames_ > 0 ? queue_total_us_ / frames_ : 0;
+    stats.queue_max_us = queue_max_us_;
+    stats.encode_avg_us = frames_ > 0 ? encode_total_us_ / frames_ : 0;
+    stats.encode_max_us = encode_max_us_;
+    stats.send_avg_us = packets_ > 0 ? send_total_us_ / packets_ : 0;
+    stats.send_max_us = send_max_us_;
+    if (reset) {
+        frames_ = packets_ = dropped_ = 0;
+        queue_total_us_ = encode_total_us_ = send_total_us_ = 0;
+        queue_max_us_ = encode_max_us_ = send_max_us_ = 0;
+    }
+    return stats;
+}
+
+// 编码任务循环，依次取出 PCM 帧编码并发送，帧处理完后归还帧池
+void AudioEncoderTask::EncoderTaskLoop() {
+    ESP_LOGI(TAG, "audio_encoder started on core %d", xPortGetCoreID());
+    AudioFrame* frame;
+    while (true) {
+        if (xQueueReceive(queue_, &frame, portMAX_DELAY) != pdTRUE) {
+            continue;
+        }
+
+        int64_t start_time = esp_timer_get_time();
+        uint32_t queue_us = start_time - frame->timestamp_us;
+        size_t samples = frame->pcm.size();
+        struct {
+            uint32_t packets = 0;
+            uint32_t bytes = 0;
+            uint32_t total_us = 0;
+            uint32_t max_us = 0;
+            LatencyTrace* trace;
+        } send;
+        send.trace = &frame->trace;
+        // 闭包只捕获两个指针，不会为 std::function 额外分配内存
+        encoder_->Encode(frame->pcm.data(), samples, [this, &send](const std::vector<uint8_t>& opus) {
+            int64_t send_start = esp_timer_get_time();
+            // 数据包记在使其凑满一包的那一帧上，打包等待的时长不计入
+            send.trace->Stamp(kLatencyEncode);
+            if (packet_callback_) {
+                packet_callback_(opus, send.trace->origin_us);
+            }
+            send.trace->Stamp(kLatencySend);
+            send.trace->Finish(kLatencyUplink);
+            LatencyTracer::GetInstance().MarkUplinkSent();
+            uint32_t elapsed = esp_timer_get_time() - send_start;
+            send.total_us += elapsed;
+            send.max_us = std::max(send.max_us, elapsed);
+            send.packets++;
+            send.bytes += opus.size();
+        });
+        uint32_t encode_us = esp_timer_get_time() - start_time - send.total_us;
+        // 编码器只读取帧的内容，缓冲区连同容量一起归还帧池
+        pool_->Release(frame);
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        frames_++;
+        packets_ += send.packets;
+        queue_total_us_ += queue_us;
+        encode_total_us_ += encode_us;
+        send_total_us_ += send.total_us;
+        queue_max_us_ = std::max(queue_max_us_, queue_us);
+        encode_max_us_ = std::max(encode_max_us_, encode_us);
+        send_max_us_ = std::max(send_max_us_, send.max_us);
+        totals_.samples += samples;
+        totals_.bytes += send.bytes;
+        totals_.encode_us += encode_us;
+        pending_frames_--;
+        if (pending_frames_ == 0) {
+            condition_variable_.notify_all();
+        }
+    }
+}
+
+AudioEncoderTask::Totals AudioEncoderTask::GetTotals() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return totals_;
+}
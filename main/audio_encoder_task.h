@@ -0,0 +1,75 @@
+#ifndef AUDIO_ENCODER_TASK_H
+#define AUDIO_ENCODER_TASK_H
+
+#include "audio_frame_pool.h"
+#include "opus_frame_encoder.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <freertos/queue.h>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// 上行编码任务：从有界队列中取 PCM 帧，编码后直接交给发送回调（协议层的线程安全发送接口）
+// 与下行解码共用的 BackgroundTask 分开，并固定在指定的核心上，播放解码不会排在编码后面
+class AudioEncoderTask {
+public:
+    struct Stats {
+        uint32_t frames;         // 编码的 PCM 帧数
+        uint32_t packets;        // 发送的 Opus 包数
+        uint32_t dropped;        // 队列已满被丢弃的帧数
+        uint32_t queue_avg_us;   // 入队到开始编码的平均/最大等待时间
+        uint32_t queue_max_us;
+        uint32_t encode_avg_us;  // 每帧编码（不含发送）的平均/最大耗时
+        uint32_t encode_max_us;
+        uint32_t send_avg_us;    // 每包发送的平均/最大耗时
+        uint32_t send_max_us;
+    };
+
+    // 自启动以来的累计值，不随 GetStats 清零，按会话取差值
+    struct Totals {
+        uint64_t samples;    // 编码的 PCM 样本数
+        uint64_t bytes;      // 发送的 Opus 字节数
+        uint64_t encode_us;  // 编码耗时（不含发送）
+    };
+
+    AudioEncoderTask(OpusFrameEncoder* encoder, AudioFramePool* pool, size_t queue_length, BaseType_t core_id);
+    ~AudioEncoderTask();
+
+    // capture_time_us 为凑满该包的那一帧的采集时间
+    void OnPacket(std::function<void(const std::vector<uint8_t>& opus, int64_t capture_time_us)> callback);
+    bool Push(AudioFrame* frame);
+    void WaitForCompletion();
+    Stats GetStats(bool reset);
+    Totals GetTotals();
+
+private:
+    OpusFrameEncoder* encoder_;
+    AudioFramePool* pool_;
+    QueueHandle_t queue_ = nullptr;
+    TaskHandle_t task_handle_ = nullptr;
+    StaticTask_t task_buffer_;
+    StackType_t* task_stack_ = nullptr;
+    std::function<void(const std::vector<uint8_t>& opus, int64_t capture_time_us)> packet_callback_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_variable_;
+    size_t pending_frames_ = 0;
+
+    // 统计在 mutex_ 保护下累加，GetStats(true) 后清零
+    uint32_t frames_ = 0;
+    uint32_t packets_ = 0;
+    uint32_t dropped_ = 0;
+    uint64_t queue_total_us_ = 0;
+    uint64_t encode_total_us_ = 0;
+    uint64_t send_total_us_ = 0;
+    uint32_t queue_max_us_ = 0;
+    uint32_t encode_max_us_ = 0;
+    uint32_t send_max_us_ = 0;
+    Totals totals_ = {};
+
+    void EncoderTaskLoop();
+};
+
+#endif // AUDIO_ENCODER_TASK_H
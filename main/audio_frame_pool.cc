@@ -0,0 +1,62 @@
+#include "audio_frame_pool.h"
+
+#include <esp_log.h>
+
+#define TAG "AudioFramePool"
+
+// 初始化缓冲池，frame_samples 为单帧可能出现的最大样本数（含所有通道）
+void AudioFramePool::Initialize(size_t frame_count, size_t frame_samples) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    frame_samples_ = frame_samples;
+    frames_.resize(frame_count);
+    free_frames_.clear();
+    free_frames_.reserve(frame_count);
+    for (auto& frame : frames_) {
+        frame.pcm.reserve(frame_samples_);
+        free_frames_.push_back(&frame);
+    }
+    ESP_LOGI(TAG, "Frame pool initialized, %zu frames x %zu samples", frame_count, frame_samples_);
+}
+
+// 取出一个空闲帧，池已耗尽时返回 nullptr
+AudioFrame* AudioFramePool::Acquire() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (free_frames_.empty()) {
+        exhausted_++;
+        return nullptr;
+    }
+    auto frame = free_frames_.back();
+    free_frames_.pop_back();
+    acquired_++;
+    size_t in_use = frames_.size() - free_frames_.size();
+    if (in_use > peak_in_use_) {
+        peak_in_use_ = in_use;
+    }
+    return frame;
+}
+
+// 归还帧；下游只读取帧的内容，容量不足说明缓冲区被接管或换掉了，重新预留并计数（稳态下应为 0）
+void AudioFramePool::Release(AudioFrame* frame) {
+    if (frame == nullptr) {
+        return;
+    }
+    frame->pcm.clear();
+    if (frame->pcm.capacity() < frame_samples_) {
+        frame->pcm.reserve(frame_samples_);
+        refilled_++;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    free_frames_.push_back(frame);
+}
+
+AudioFramePool::Stats AudioFramePool::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.acquired = acquired_;
+    stats.exhausted = exhausted_;
+    stats.refilled = refilled_;
+    stats.in_use = frames_.size() - free_frames_.size();
+    stats.peak_in_use = peak_in_use_;
+    stats.frame_count = frames_.size();
+    return stats;
+}
@@ -0,0 +1,53 @@
+#ifndef AUDIO_FRAME_POOL_H
+#define AUDIO_FRAME_POOL_H
+
+#include "latency_tracer.h"
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 可复用的 PCM 帧，pcm 的容量在初始化时一次性预留
+struct AudioFrame {
+    std::vector<int16_t> pcm;
+    int64_t timestamp_us = 0;  // 交给编码任务的时间，用于统计排队延迟
+    LatencyTrace trace;        // 从采集开始的各阶段时间戳
+};
+
+// 固定数量的 PCM 帧缓冲池，用于在采集、重采样、AFE 与编码任务之间传递音频帧
+// 稳态下只在池内循环使用已预留的缓冲区，不产生堆分配；帧耗尽时由调用方丢弃该帧并计数
+class AudioFramePool {
+public:
+    struct Stats {
+        uint32_t acquired;   // 成功取出的帧数
+        uint32_t exhausted;  // 池已耗尽、取帧失败的次数
+        uint32_t refilled;   // 归还时容量不足、需要重新预留的次数，稳态下应为 0
+        size_t in_use;       // 当前借出的帧数
+        size_t peak_in_use;  // 借出帧数峰值
+        size_t frame_count;  // 帧总数
+    };
+
+    AudioFramePool() = default;
+    AudioFramePool(const AudioFramePool&) = delete;
+    AudioFramePool& operator=(const AudioFramePool&) = delete;
+
+    void Initialize(size_t frame_count, size_t frame_samples);
+    AudioFrame* Acquire();
+    void Release(AudioFrame* frame);
+    Stats GetStats();
+    inline size_t frame_samples() const { return frame_samples_; }
+
+private:
+    std::mutex mutex_;
+    std::vector<AudioFrame> frames_;
+    std::vector<AudioFrame*> free_frames_;
+    size_t frame_samples_ = 0;
+    size_t peak_in_use_ = 0;
+    std::atomic<uint32_t> acquired_{0};
+    std::atomic<uint32_t> exhausted_{0};
+    std::atomic<uint32_t> refilled_{0};
+};
+
+#endif // AUDIO_FRAME_POOL_H
@@ -0,0 +1,207 @@
+#include "audio_packet_ring.h"
+
+#include <esp_log.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+
+#define TAG "AudioPacketRing"
+
+// 记录头为 4 字节的负载长度，取该值时表示本圈剩余空间作废，从缓冲区起点继续读取
+// 长度之后是 8 字节的入队时间戳，用于统计下行时延，然后才是负载
+static constexpr uint32_t kWrapMarker = 0xFFFFFFFF;
+static constexpr size_t kHeaderSize = sizeof(uint32_t);
+static constexpr size_t kTimestampSize = sizeof(int64_t);
+
+static inline size_t AlignRecord(size_t size) {
+    return (size + 3) & ~size_t(3);  // 记录按 4 字节对齐，保证长度头可以直接读写
+}
+
+// 构造函数，预分配整块缓冲区，优先使用 PSRAM，失败时回退到内部 SRAM
+AudioPacketRing::AudioPacketRing(size_t capacity_bytes, OverflowPolicy policy)
+    : capacity_(AlignRecord(capacity_bytes)), policy_(policy) {
+    buffer_ = (uint8_t*)heap_caps_malloc(capacity_, MALLOC_CAP_SPIRAM | MALLOC_CAP_8BIT);
+    if (buffer_ == nullptr) {
+        buffer_ = (uint8_t*)heap_caps_malloc(capacity_, MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    if (buffer_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to allocate %zu bytes", capacity_);
+        capacity_ = 0;
+        return;
+    }
+    // 读写索引在 [0, index_limit_) 内单调前进，取模 capacity_ 得到缓冲区内的位置
+    // index_limit_ 是 capacity_ 的整数倍且不超过 SIZE_MAX / 2，索引相加不会溢出
+    index_limit_ = (SIZE_MAX / 2 / capacity_) * capacity_;
+    ESP_LOGI(TAG, "Packet ring allocated, capacity: %zu bytes", capacity_);
+}
+
+// 析构函数，释放缓冲区
+AudioPacketRing::~AudioPacketRing() {
+    if (buffer_ != nullptr) {
+        heap_caps_free(buffer_);
+    }
+}
+
+// 索引前进 bytes 字节
+size_t AudioPacketRing::Advance(size_t index, size_t bytes) const {
+    index += bytes;
+    return index >= index_limit_ ? index - index_limit_ : index;
+}
+
+// 计算当前占用的字节数（包含因回绕而作废的尾部空间）
+size_t AudioPacketRing::UsedBytes(size_t head, size_t tail) const {
+    return head >= tail ? head - tail : index_limit_ - tail + head;
+}
+
+// 解析 tail 处的记录，返回负载在缓冲区中的偏移、长度与下一条记录的索引
+// 读取的内容可能已被生产者淘汰覆盖，因此需要校验长度，调用方再通过 CAS 确认 tail 未被移动
+bool AudioPacketRing::NextRecord(size_t tail, size_t& offset, size_t& size, size_t& next) const {
+    size_t position = tail % capacity_;
+    size_t record = tail;
+    uint32_t header;
+    memcpy(&header, buffer_ + position, kHeaderSize);
+    if (header == kWrapMarker) {
+        record = Advance(tail, capacity_ - position);
+        position = 0;
+        memcpy(&header, buffer_, kHeaderSize);
+    }
+    if (header == kWrapMarker || position + kHeaderSize + kTimestampSize + header > capacity_) {
+        return false;
+    }
+    offset = position + kHeaderSize + kTimestampSize;
+    size = header;
+    next = Advance(record, AlignRecord(kHeaderSize + kTimestampSize + header));
+    return true;
+}
+
+// 为长度为 need 的记录寻找写入位置，返回负载所在的缓冲区偏移与写入后的 head，必须持有 producer_mutex_
+// 记录不跨越缓冲区末尾，末尾放不下时写入回绕标记，剩余空间作废
+bool AudioPacketRing::Reserve(size_t head, size_t need, size_t& offset, size_t& next) {
+    size_t free_bytes = capacity_ - UsedBytes(head, tail_.load(std::memory_order_acquire));
+    size_t position = head % capacity_;
+    size_t space_to_end = capacity_ - position;
+    if (need <= space_to_end) {
+        if (need > free_bytes) {
+            return false;
+        }
+        offset = position;
+        next = Advance(head, need);
+        return true;
+    }
+    if (space_to_end + need > free_bytes) {
+        return false;
+    }
+    memcpy(buffer_ + position, &kWrapMarker, kHeaderSize);
+    offset = 0;
+    next = Advance(head, space_to_end + need);
+    return true;
+}
+
+// 生产者：将数据包拷贝进环形缓冲区，队列已满时按 policy_ 处理
+// 允许长度为 0 的数据包，下行抖动缓冲区用它标记需要丢包补偿的帧
+bool AudioPacketRing::Push(const uint8_t* data, size_t size, int64_t timestamp_us) {
+    // 单条记录不超过容量的一半：队列为空时无论索引停在哪里都放得下，淘汰旧数据包总能腾出空间
+    size_t need = AlignRecord(kHeaderSize + kTimestampSize + size);
+    if (buffer_ == nullptr || need * 2 > capacity_) {
+        dropped_.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    size_t head = head_.load(std::memory_order_relaxed);
+    size_t offset = 0;
+    size_t next = 0;
+    while (!Reserve(head, need, offset, next)) {
+        if (policy_ == kOverflowDropNewest) {
+            dropped_.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        // 淘汰最旧的数据包，与消费者竞争同一个 tail，通过 CAS 保证只有一方成功
+        // 消费者可能已在此期间取空队列，此时 tail 处是过期数据，重新检查空间即可
+        size_t tail = tail_.load(std::memory_order_acquire);
+        if (tail == head) {
+            continue;
+        }
+        size_t record_offset, record_size, record_next;
+        if (NextRecord(tail, record_offset, record_size, record_next) &&
+            tail_.compare_exchange_strong(tail, record_next, std::memory_order_acq_rel)) {
+            evicted_.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    uint32_t header = size;
+    memcpy(buffer_ + offset, &header, kHeaderSize);
+    memcpy(buffer_ + offset + kHeaderSize, &timestamp_us, kTimestampSize);
+    if (size > 0) {
+        memcpy(buffer_ + offset + kHeaderSize + kTimestampSize, data, size);
+    }
+    head_.store(next, std::memory_order_release);
+    pushed_.fetch_add(1, std::memory_order_relaxed);
+
+    size_t used = UsedBytes(next, tail_.load(std::memory_order_relaxed));
+    size_t peak = peak_bytes_.load(std::memory_order_relaxed);
+    if (used > peak) {
+        peak_bytes_.store(used, std::memory_order_relaxed);
+    }
+    return true;
+}
+
+// 消费者：取出最旧的数据包，拷贝到调用方提供的 packet 中（复用其已有容量）
+bool AudioPacketRing::Pop(std::vector<uint8_t>& packet, int64_t* timestamp_us) {
+    if (buffer_ == nullptr) {
+        return false;
+    }
+    while (true) {
+        size_t tail = tail_.load(std::memory_order_acquire);
+        size_t head = head_.load(std::memory_order_acquire);
+        if (tail == head) {
+            return false;
+        }
+        size_t offset, size, next;
+        if (!NextRecord(tail, offset, size, next)) {
+            if (tail_.load(std::memory_order_acquire) == tail) {
+                ESP_LOGE(TAG, "Corrupted record at %zu", tail);
+                return false;
+            }
+            continue;  // 记录已被生产者淘汰，重新读取 tail
+        }
+        packet.assign(buffer_ + offset, buffer_ + offset + size);
+        if (timestamp_us != nullptr) {
+            memcpy(timestamp_us, buffer_ + offset - kTimestampSize, kTimestampSize);
+        }
+        if (tail_.compare_exchange_strong(tail, next, std::memory_order_acq_rel)) {
+            popped_.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+        // 拷贝期间该记录被淘汰，数据可能已被覆盖，丢弃后重试
+    }
+}
+
+// 清空队列，与生产者共用 producer_mutex_，可以在任意线程调用
+void AudioPacketRing::Clear() {
+    std::lock_guard<std::mutex> lock(producer_mutex_);
+    tail_.store(head_.load(std::memory_order_relaxed), std::memory_order_release);
+}
+
+bool AudioPacketRing::Empty() const {
+    return head_.load(std::memory_order_acquire) == tail_.load(std::memory_order_acquire);
+}
+
+AudioPacketRing::Stats AudioPacketRing::GetStats() const {
+    Stats stats;
+    stats.pushed = pushed_.load(std::memory_order_relaxed);
+    stats.popped = popped_.load(std::memory_order_relaxed);
+    stats.dropped = dropped_.load(std::memory_order_relaxed);
+    stats.evicted = evicted_.load(std::memory_order_relaxed);
+    stats.used_bytes = UsedBytes(head_.load(std::memory_order_relaxed), tail_.load(std::memory_order_relaxed));
+    stats.peak_bytes = peak_bytes_.load(std::memory_order_relaxed);
+    stats.capacity_bytes = capacity_;
+    return stats;
+}
+
+void AudioPacketRing::ResetStats() {
+    pushed_ = 0;
+    popped_ = 0;
+    dropped_ = 0;
+    evicted_ = 0;
+    peak_bytes_ = 0;
+}
@@ -0,0 +1,71 @@
+#ifndef AUDIO_PACKET_RING_H
+#define AUDIO_PACKET_RING_H
+
+#include <atomic>
+#include <mutex>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 定长字节环形缓冲区，用于在网络回调与解码任务之间传递 Opus 数据包
+// 数据包以 [长度头 + 负载] 的形式内联存放在预分配的内存块中（优先 PSRAM），入队出队不产生堆分配
+// 消费端无锁；多个生产者（网络回调、PlaySound）之间通过独立的 producer_mutex_ 串行化，不再与 Application::Schedule 争用同一把锁
+class AudioPacketRing {
+public:
+    // 队列满时的处理策略
+    enum OverflowPolicy {
+        kOverflowDropNewest,  // 丢弃新到的数据包
+        kOverflowDropOldest,  // 淘汰最旧的数据包，为新数据包腾出空间
+    };
+
+    struct Stats {
+        uint32_t pushed;        // 成功入队的数据包数
+        uint32_t popped;        // 成功出队的数据包数
+        uint32_t dropped;       // 因队列已满被丢弃的新数据包数
+        uint32_t evicted;       // 因队列已满被淘汰的旧数据包数
+        size_t used_bytes;      // 当前占用字节数
+        size_t peak_bytes;      // 占用字节数峰值
+        size_t capacity_bytes;  // 总容量
+    };
+
+    AudioPacketRing(size_t capacity_bytes, OverflowPolicy policy = kOverflowDropOldest);
+    ~AudioPacketRing();
+
+    AudioPacketRing(const AudioPacketRing&) = delete;
+    AudioPacketRing& operator=(const AudioPacketRing&) = delete;
+
+    // timestamp_us 随数据包一起存放，出队时取回，用于统计排队时延
+    // 记录（含 12 字节记录头）超过容量一半的数据包直接丢弃
+    bool Push(const uint8_t* data, size_t size, int64_t timestamp_us = 0);
+    bool Pop(std::vector<uint8_t>& packet, int64_t* timestamp_us = nullptr);
+    void Clear();
+    bool Empty() const;
+    Stats GetStats() const;
+    void ResetStats();
+
+private:
+    uint8_t* buffer_ = nullptr;
+    size_t capacity_ = 0;
+    OverflowPolicy policy_;
+    std::mutex producer_mutex_;
+
+    size_t index_limit_ = 0;
+
+    // 读写索引分别放在独立的缓存行中，避免生产者与消费者之间的伪共享
+    // 索引不随缓冲区回绕归零，消费者 CAS 时不会把转了一圈的 tail 误认为未被移动（ABA）
+    alignas(64) std::atomic<size_t> head_{0};
+    alignas(64) std::atomic<size_t> tail_{0};
+
+    std::atomic<uint32_t> pushed_{0};
+    std::atomic<uint32_t> popped_{0};
+    std::atomic<uint32_t> dropped_{0};
+    std::atomic<uint32_t> evicted_{0};
+    std::atomic<size_t> peak_bytes_{0};
+
+    size_t Advance(size_t index, size_t bytes) const;
+    size_t UsedBytes(size_t head, size_t tail) const;
+    bool NextRecord(size_t tail, size_t& offset, size_t& size, size_t& next) const;
+    bool Reserve(size_t head, size_t need, size_t& offset, size_t& next);
+};
+
+#endif // AUDIO_PACKET_RING_H
@@ -0,0 +1,183 @@
+#include "audio_player.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
+#include <cstring>
+#include <algorithm>
+#include <cassert>
+
+#define TAG "AudioPlayer"
+
+// 每次送入 I2S 的时长，越短 Clear() 后残留的声音越少
+#define WRITER_CHUNK_MS 20
+// 缓冲区取空后这段时间内又有数据到达，视为一次欠载而不是正常的播放结束
+#define UNDERRUN_WINDOW_MS 500
+// 单个 Opus 数据包的最大时长，解码端在低于领先量时还会再解码一整包
+#define MAX_PACKET_MS 120
+
+// 构造函数，按编解码器的输出采样率分配 PCM 环形缓冲区并创建写入任务
+AudioPlayer::AudioPlayer(AudioCodec* codec, int decode_ahead_ms, int prebuffer_ms)
+    : codec_(codec), sample_rate_(codec->output_sample_rate()), decode_ahead_ms_(decode_ahead_ms) {
+    prebuffer_samples_ = (size_t)sample_rate_ * std::min(prebuffer_ms, decode_ahead_ms) / 1000;
+    capacity_ = (size_t)sample_rate_ * (decode_ahead_ms + MAX_PACKET_MS) / 1000;
+    buffer_ = (int16_t*)heap_caps_malloc(capacity_ * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+    if (buffer_ == nullptr) {
+        buffer_ = (int16_t*)heap_caps_malloc(capacity_ * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    assert(buffer_ != nullptr);
+    chunk_.reserve(sample_rate_ * WRITER_CHUNK_MS / 1000);
+    ESP_LOGI(TAG, "Playback buffer %d ms (%zu samples), decode ahead %d ms, prebuffer %d ms",
+        SamplesToMs(capacity_), capacity_, decode_ahead_ms_, SamplesToMs(prebuffer_samples_));
+
+    xTaskCreate([](void* arg) {
+        AudioPlayer* player = (AudioPlayer*)arg;
+        player->WriterTaskLoop();
+    }, "audio_writer", 4096, this, 4, &writer_task_handle_);
+}
+
+// 析构函数，释放资源
+AudioPlayer::~AudioPlayer() {
+    if (writer_task_handle_ != nullptr) {
+        vTaskDelete(writer_task_handle_);
+    }
+    heap_caps_free(buffer_);
+}
+
+// 设置低水位回调，缓冲时长低于解码领先量时在写入任务中调用，用于触发下一次解码
+void AudioPlayer::OnLowWater(std::function<void()> callback) {
+    low_water_callback_ = callback;
+}
+
+// 设置排空回调，缓冲区中的 PCM 全部送入 I2S 后在写入任务中调用，回调中不能阻塞
+void AudioPlayer::OnDrained(std::function<void()> callback) {
+    drained_callback_ = callback;
+}
+
+// 写入解码后的 PCM，返回实际写入的样本数；空间不足时丢弃多余部分并计为溢出
+// trace 不为空时，在这段样本的首个样本送入 I2S 时记录输出阶段
+size_t AudioPlayer::Write(const int16_t* data, size_t samples, const LatencyTrace* trace) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (used_ == 0 && !playing_) {
+        int64_t now = esp_timer_get_time();
+        if (starved_time_ != 0 && now - starved_time_ < UNDERRUN_WINDOW_MS * 1000) {
+            underruns_++;
+        }
+        starved_time_ = 0;
+        first_write_time_ = now;
+    }
+
+    size_t count = std::min(samples, capacity_ - used_);
+    if (count < samples) {
+        overruns_++;
+    }
+    size_t write_pos = (read_pos_ + used_) % capacity_;
+    size_t first = std::min(count, capacity_ - write_pos);
+    memcpy(buffer_ + write_pos, data, first * sizeof(int16_t));
+    memcpy(buffer_, data + first, (count - first) * sizeof(int16_t));
+    if (trace != nullptr) {
+        traces_.Push(count, *trace);
+    } else {
+        traces_.Push(count, LatencyTrace());
+    }
+    used_ += count;
+    peak_used_ = std::max(peak_used_, used_);
+    condition_variable_.notify_all();
+    return count;
+}
+
+// 丢弃所有尚未送入 I2S 的 PCM，下一次写入重新开始预缓冲
+void AudioPlayer::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    read_pos_ = 0;
+    used_ = 0;
+    traces_.Clear();
+    playing_ = false;
+    starved_time_ = 0;
+    condition_variable_.notify_all();
+}
+
+// 缓冲区中的 PCM 是否已全部送入 I2S
+bool AudioPlayer::IsDrained() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return used_ == 0 && !writing_;
+}
+
+int AudioPlayer::BufferedMs() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return SamplesToMs(used_);
+}
+
+AudioPlayer::Stats AudioPlayer::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.underruns = underruns_;
+    stats.overruns = overruns_;
+    stats.buffered_ms = SamplesToMs(used_);
+    stats.peak_ms = SamplesToMs(peak_used_);
+    stats.capacity_ms = SamplesToMs(capacity_);
+    stats.start_latency_ms = start_latency_ms_;
+    return stats;
+}
+
+// 写入任务循环，从环形缓冲区取出 PCM 送入 I2S，i2s_channel_write 的阻塞只影响本任务
+void AudioPlayer::WriterTaskLoop() {
+    ESP_LOGI(TAG, "audio_writer started");
+    while (true) {
+        bool low_water;
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            condition_variable_.wait(lock, [this]() { return used_ > 0; });
+            if (!playing_) {
+                // 先积累预缓冲深度再开始播放，数据不足时最多等待预缓冲时长，避免短音频的尾部一直不播放
+                condition_variable_.wait_for(lock, std::chrono::milliseconds(SamplesToMs(prebuffer_samples_)), [this]() {
+                    return used_ == 0 || used_ >= prebuffer_samples_;
+                });
+                if (used_ == 0) {
+                    continue;
+                }
+                playing_ = true;
+                start_latency_ms_ = (esp_timer_get_time() - first_write_time_) / 1000;
+            }
+
+            size_t count = std::min(used_, chunk_.capacity());
+            size_t first = std::min(count, capacity_ - read_pos_);
+            chunk_.resize(count);
+            memcpy(chunk_.data(), buffer_ + read_pos_, first * sizeof(int16_t));
+            memcpy(chunk_.data() + first, buffer_, (count - first) * sizeof(int16_t));
+            read_pos_ = (read_pos_ + count) % capacity_;
+            used_ -= count;
+            // 与取出样本在同一把锁内，Clear() 之后读写位置不会错位
+            traces_.Consume(count, [](LatencyTrace& trace) {
+                if (trace.origin_us == 0) {
+                    return;  // 本地提示音
+                }
+                trace.Stamp(kLatencyOutput);
+                trace.Finish(kLatencyDownlink);
+                LatencyTracer::GetInstance().MarkPlayback();
+            });
+            writing_ = true;
+            low_water = SamplesToMs(used_) < decode_ahead_ms_;
+        }
+
+        if (low_water && low_water_callback_) {
+            low_water_callback_();
+        }
+        codec_->OutputData(chunk_);
+
+        bool drained = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            writing_ = false;
+            if (used_ == 0 && playing_) {
+                playing_ = false;
+                starved_time_ = esp_timer_get_time();
+                drained = true;
+            }
+        }
+        condition_variable_.notify_all();
+        if (drained && drained_callback_) {
+            drained_callback_();
+        }
+    }
+}
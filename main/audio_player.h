@@ -0,0 +1,70 @@
+#ifndef AUDIO_PLAYER_H
+#define AUDIO_PLAYER_H
+
+#include "audio_codec.h"
+#include "latency_tracer.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <vector>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+
+// 下行播放：解码后的 PCM 先写入环形缓冲区，由独立的写入任务送入 I2S DMA
+// 解码端只需保持 decode_ahead_ms 的 PCM 领先量，不会再阻塞在 i2s_channel_write 上
+// 写入任务在开始播放（或欠载后恢复播放）前先积累 prebuffer_ms 的数据
+class AudioPlayer {
+public:
+    struct Stats {
+        uint32_t underruns;    // 播放过程中缓冲区被取空、随后又有数据到达的次数
+        uint32_t overruns;     // 缓冲区已满、部分 PCM 被丢弃的次数
+        int buffered_ms;       // 当前缓冲的时长
+        int peak_ms;           // 缓冲时长峰值
+        int capacity_ms;       // 缓冲区容量
+        int start_latency_ms;  // 最近一次从首个样本写入到开始送入 I2S 的耗时
+    };
+
+    AudioPlayer(AudioCodec* codec, int decode_ahead_ms, int prebuffer_ms);
+    ~AudioPlayer();
+
+    void OnLowWater(std::function<void()> callback);
+    void OnDrained(std::function<void()> callback);
+    size_t Write(const int16_t* data, size_t samples, const LatencyTrace* trace = nullptr);
+    void Clear();
+    bool IsDrained();
+    int BufferedMs();
+    Stats GetStats();
+
+private:
+    AudioCodec* codec_;
+    int sample_rate_;
+    int decode_ahead_ms_;
+    size_t prebuffer_samples_;
+
+    std::mutex mutex_;
+    std::condition_variable condition_variable_;
+    int16_t* buffer_ = nullptr;
+    size_t capacity_ = 0;
+    size_t read_pos_ = 0;
+    size_t used_ = 0;
+    size_t peak_used_ = 0;
+    bool playing_ = false;
+    bool writing_ = false;
+    int64_t first_write_time_ = 0;
+    int64_t starved_time_ = 0;
+    uint32_t underruns_ = 0;
+    uint32_t overruns_ = 0;
+    int start_latency_ms_ = 0;
+
+    std::vector<int16_t> chunk_;
+    LatencyTraceFifo traces_;  // 缓冲区中各段样本对应的下行时延记录
+    std::function<void()> low_water_callback_;
+    std::function<void()> drained_callback_;
+    TaskHandle_t writer_task_handle_ = nullptr;
+
+    inline int SamplesToMs(size_t samples) const { return samples * 1000 / sample_rate_; }
+    void WriterTaskLoop();
+};
+
+#endif // AUDIO_PLAYER_H
@@ -0,0 +1,61 @@
+#ifndef AFE_FEED_RING_H
+#define AFE_FEED_RING_H
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <cstddef>
+
+// AFE 输入环形缓冲区，代替“追加到 vector 再 erase 已喂入部分”的做法
+// 容量是喂入块（get_feed_chunksize() * 通道数）的整数倍，读位置总是落在块边界上，
+// 因此每个完整的块在环内都是连续的，直接以环内指针喂给 AFE，不拷贝、不搬移、不重新分配
+class AfeFeedRing {
+public:
+    void Initialize(size_t chunk_samples, size_t chunk_count = 2) {
+        chunk_samples_ = chunk_samples;
+        buffer_.assign(chunk_samples * std::max<size_t>(chunk_count, 1), 0);
+        read_pos_ = 0;
+        used_ = 0;
+    }
+
+    // 写入任意长度的交织 PCM，每凑满一块就调用 feed(const int16_t* chunk)
+    // 写入与喂入交替进行，单次写入的长度不受环容量限制
+    template <typename Feed>
+    void Write(const int16_t* data, size_t samples, Feed feed) {
+        const size_t capacity = buffer_.size();
+        if (capacity == 0) {
+            return;
+        }
+        while (samples > 0) {
+            size_t write_pos = (read_pos_ + used_) % capacity;
+            size_t count = std::min({samples, capacity - used_, capacity - write_pos});
+            memcpy(buffer_.data() + write_pos, data, count * sizeof(int16_t));
+            data += count;
+            samples -= count;
+            used_ += count;
+
+            while (used_ >= chunk_samples_) {
+                feed(buffer_.data() + read_pos_);
+                read_pos_ = (read_pos_ + chunk_samples_) % capacity;
+                used_ -= chunk_samples_;
+            }
+        }
+    }
+
+    // 丢弃不足一块的残留数据
+    void Reset() {
+        read_pos_ = 0;
+        used_ = 0;
+    }
+
+    inline size_t chunk_samples() const { return chunk_samples_; }
+
+private:
+    std::vector<int16_t> buffer_;
+    size_t chunk_samples_ = 0;
+    size_t read_pos_ = 0;
+    size_t used_ = 0;
+};
+
+#endif // AFE_FEED_RING_H
@@ -52,6 +52,7 @@ void AudioProcessor::Initialize(int channels, bool reference) {
 
     // 根据配置创建AFE通信数据
     afe_communication_data_ = esp_afe_vc_v1.create_from_config(&afe_config);
+    input_ring_.Initialize(esp_afe_vc_v1.get_feed_chunksize(afe_communication_data_) * channels_);
     
     // 创建音频处理任务
     xTaskCreate([](void* arg) {
@@ -70,15 +71,11 @@ AudioProcessor::~AudioProcessor() {
 }
 
 // 输入音频数据
+// 数据先写入环形缓冲区，每凑满一个喂入块就直接用环内的连续内存喂入AFE
 void AudioProcessor::Input(const std::vector<int16_t>& data) {
-    input_buffer_.insert(input_buffer_.end(), data.begin(), data.end()); // 将数据插入输入缓冲区
-
-    auto feed_size = esp_afe_vc_v1.get_feed_chunksize(afe_communication_data_) * channels_; // 获取每次喂入AFE的数据大小
-    while (input_buffer_.size() >= feed_size) {
-        auto chunk = input_buffer_.data(); // 获取输入缓冲区的数据
+    input_ring_.Write(data.data(), data.size(), [this](const int16_t* chunk) {
         esp_afe_vc_v1.feed(afe_communication_data_, chunk); // 将数据喂入AFE
-        input_buffer_.erase(input_buffer_.begin(), input_buffer_.begin() + feed_size); // 删除已处理的数据
-    }
+    });
 }
 
 // 启动音频处理器
@@ -96,8 +93,13 @@ bool AudioProcessor::IsRunning() {
     return xEventGroupGetBits(event_group_) & PROCESSOR_RUNNING; // 获取事件标志位并检查是否正在运行
 }
 
+// 每次喂入 AFE 的帧数（每通道，16kHz）
+size_t AudioProcessor::GetFeedSize() {
+    return esp_afe_vc_v1.get_feed_chunksize(afe_communication_data_);
+}
+
 // 设置输出回调函数
-void AudioProcessor::OnOutput(std::function<void(std::vector<int16_t>&& data)> callback) {
+void AudioProcessor::OnOutput(std::function<void(const std::vector<int16_t>& data)> callback) {
     output_callback_ = callback; // 设置输出回调函数
 }
 
@@ -123,7 +125,9 @@ void AudioProcessor::AudioProcessorTask() {
         }
 
         if (output_callback_) {
-            output_callback_(std::vector<int16_t>(res->data, res->data + res->data_size / sizeof(int16_t))); // 调用输出回调函数
+            // 输出缓冲区在任务内复用，回调需要在返回前拷走数据
+            output_buffer_.assign(res->data, res->data + res->data_size / sizeof(int16_t));
+            output_callback_(output_buffer_); // 调用输出回调函数
         }
     }
 }
\ No newline at end of file
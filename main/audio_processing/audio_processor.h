@@ -1,6 +1,8 @@
 #ifndef AUDIO_PROCESSOR_H
 #define AUDIO_PROCESSOR_H
 
+#include "afe_feed_ring.h"
+
 #include <esp_afe_sr_models.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/task.h>
@@ -20,13 +22,15 @@ public:
     void Start();
     void Stop();
     bool IsRunning();
-    void OnOutput(std::function<void(std::vector<int16_t>&& data)> callback);
+    size_t GetFeedSize();
+    void OnOutput(std::function<void(const std::vector<int16_t>& data)> callback);
 
 private:
     EventGroupHandle_t event_group_ = nullptr;
     esp_afe_sr_data_t* afe_communication_data_ = nullptr;
-    std::vector<int16_t> input_buffer_;
-    std::function<void(std::vector<int16_t>&& data)> output_callback_;
+    AfeFeedRing input_ring_;
+    std::vector<int16_t> output_buffer_;
+    std::function<void(const std::vector<int16_t>& data)> output_callback_;
     int channels_;
     bool reference_;
 
@@ -2,19 +2,31 @@
 #include "application.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_heap_caps.h>
 #include <model_path.h>
 #include <arpa/inet.h>
 #include <sstream>
+#include <cstring>
+#include <algorithm>
 
 #define DETECTION_RUNNING_EVENT 1 // 定义事件标志位，表示检测任务正在运行
+#define OUTPUT_RUNNING_EVENT 2 // 共享前端模式下，AFE 输出作为上行音频
+
+// 唤醒词预录时长，检测到唤醒词时发送这段时间内已编码好的数据包
+#define WAKE_WORD_PREROLL_MS 2000
+#define WAKE_WORD_PREROLL_PACKETS (WAKE_WORD_PREROLL_MS / OPUS_FRAME_DURATION_MS)
+// 编码任务来不及处理时 PCM 环最多积压的时长
+#define WAKE_WORD_PCM_BACKLOG_MS 1000
+// Opus 包环按 64kbps 计算 2 秒的容量，另加记录头
+#define WAKE_WORD_OPUS_RING_BYTES (WAKE_WORD_PREROLL_MS * 64 / 8 + 2048)
 
 static const char* TAG = "WakeWordDetect"; // 日志标签
 
 // 构造函数，初始化事件组和相关数据结构
 WakeWordDetect::WakeWordDetect()
     : afe_detection_data_(nullptr), // 初始化AFE检测数据为空
-      wake_word_pcm_(), // 初始化PCM数据存储
-      wake_word_opus_() { // 初始化Opus编码数据存储
+      wake_word_opus_(WAKE_WORD_OPUS_RING_BYTES) { // 预分配 Opus 包环
 
     event_group_ = xEventGroupCreate(); // 创建事件组
 }
@@ -25,9 +37,15 @@ WakeWordDetect::~WakeWordDetect() {
         esp_afe_sr_v1.destroy(afe_detection_data_); // 销毁AFE检测数据
     }
 
+    if (wake_word_encode_task_ != nullptr) {
+        vTaskDelete(wake_word_encode_task_); // 删除常驻编码任务
+    }
     if (wake_word_encode_task_stack_ != nullptr) {
         heap_caps_free(wake_word_encode_task_stack_); // 释放编码任务栈内存
     }
+    if (wake_word_pcm_ != nullptr) {
+        heap_caps_free(wake_word_pcm_); // 释放预录 PCM 环
+    }
 
     vEventGroupDelete(event_group_); // 删除事件组
 }
@@ -89,6 +107,20 @@ void WakeWordDetect::Initialize(int channels, bool reference) {
 
     // 根据配置创建AFE检测数据
     afe_detection_data_ = esp_afe_sr_v1.create_from_config(&afe_config);
+    input_ring_.Initialize(esp_afe_sr_v1.get_feed_chunksize(afe_detection_data_) * channels_);
+
+    // 预录 PCM 环与常驻编码任务，缓冲区和任务栈都放在 PSRAM 中
+    wake_word_pcm_capacity_ = 16000 / 1000 * WAKE_WORD_PCM_BACKLOG_MS;
+    wake_word_pcm_ = (int16_t*)heap_caps_malloc(wake_word_pcm_capacity_ * sizeof(int16_t), MALLOC_CAP_SPIRAM);
+    if (wake_word_pcm_ == nullptr) {
+        wake_word_pcm_ = (int16_t*)heap_caps_malloc(wake_word_pcm_capacity_ * sizeof(int16_t), MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT);
+    }
+    wake_word_encode_task_stack_ = (StackType_t*)heap_caps_malloc(4096 * 8, MALLOC_CAP_SPIRAM); // 分配编码任务栈内存
+    wake_word_encode_task_ = xTaskCreateStatic([](void* arg) {
+        auto this_ = (WakeWordDetect*)arg;
+        this_->WakeWordEncodeTask();
+        vTaskDelete(NULL);
+    }, "encode_detect_packets", 4096 * 8, this, 2, wake_word_encode_task_stack_, &wake_word_encode_task_buffer_);
 
     // 创建音频检测任务
     xTaskCreate([](void* arg) {
@@ -109,7 +141,21 @@ void WakeWordDetect::OnVadStateChange(std::function<void(bool speaking)> callbac
 }
 
 // 启动检测任务
+// 上一次封存的预录已经取走（或放弃），从空的预录重新开始持续编码
 void WakeWordDetect::StartDetection() {
+    {
+        std::lock_guard<std::mutex> lock(wake_word_mutex_);
+        if (wake_word_sealed_) {
+            wake_word_sealed_ = false;
+            wake_word_flushing_ = false;
+            wake_word_pcm_used_ = 0;
+            wake_word_opus_.Clear();
+            wake_word_packets_ = 0;
+            wake_word_reset_encoder_ = true;
+            wake_word_generation_++;
+            wake_word_cv_.notify_all();
+        }
+    }
     xEventGroupSetBits(event_group_, DETECTION_RUNNING_EVENT); // 设置事件标志位，表示检测任务正在运行
 }
 
@@ -123,15 +169,48 @@ bool WakeWordDetect::IsDetectionRunning() {
     return xEventGroupGetBits(event_group_) & DETECTION_RUNNING_EVENT; // 获取事件标志位并检查是否正在运行
 }
 
-// 输入音频数据
-void WakeWordDetect::Feed(const std::vector<int16_t>& data) {
-    input_buffer_.insert(input_buffer_.end(), data.begin(), data.end()); // 将数据插入输入缓冲区
+// 设置输出回调函数，输出缓冲区在任务内复用，回调需要在返回前拷走数据
+void WakeWordDetect::OnOutput(std::function<void(const std::vector<int16_t>& data)> callback) {
+    output_callback_ = callback;
+}
 
-    auto feed_size = esp_afe_sr_v1.get_feed_chunksize(afe_detection_data_) * channels_; // 获取每次喂入AFE的数据大小
-    while (input_buffer_.size() >= feed_size) {
-        esp_afe_sr_v1.feed(afe_detection_data_, input_buffer_.data()); // 将数据喂入AFE
-        input_buffer_.erase(input_buffer_.begin(), input_buffer_.begin() + feed_size); // 删除已处理的数据
+// 切换到语音通信角色：关闭 WakeNet 节省算力，降噪、回声消除与 VAD 继续运行
+void WakeWordDetect::StartOutput() {
+    if (IsOutputRunning()) {
+        return;
     }
+    esp_afe_sr_v1.disable_wakenet(afe_detection_data_);
+    xEventGroupSetBits(event_group_, OUTPUT_RUNNING_EVENT);
+}
+
+// 切换回唤醒词角色
+void WakeWordDetect::StopOutput() {
+    if (!IsOutputRunning()) {
+        return;
+    }
+    xEventGroupClearBits(event_group_, OUTPUT_RUNNING_EVENT);
+    esp_afe_sr_v1.enable_wakenet(afe_detection_data_);
+}
+
+bool WakeWordDetect::IsOutputRunning() {
+    return xEventGroupGetBits(event_group_) & OUTPUT_RUNNING_EVENT;
+}
+
+bool WakeWordDetect::IsRunning() {
+    return xEventGroupGetBits(event_group_) & (DETECTION_RUNNING_EVENT | OUTPUT_RUNNING_EVENT);
+}
+
+// 每次喂入 AFE 的帧数（每通道，16kHz）
+size_t WakeWordDetect::GetFeedSize() {
+    return esp_afe_sr_v1.get_feed_chunksize(afe_detection_data_);
+}
+
+// 输入音频数据
+// 数据先写入环形缓冲区，每凑满一个喂入块就直接用环内的连续内存喂入AFE
+void WakeWordDetect::Feed(const std::vector<int16_t>& data) {
+    input_ring_.Write(data.data(), data.size(), [this](const int16_t* chunk) {
+        esp_afe_sr_v1.feed(afe_detection_data_, chunk); // 将数据喂入AFE
+    });
 }
 
 // 音频检测任务
@@ -142,7 +221,8 @@ void WakeWordDetect::AudioDetectionTask() {
         feed_size, fetch_size); // 日志：音频检测任务启动
 
     while (true) {
-        xEventGroupWaitBits(event_group_, DETECTION_RUNNING_EVENT, pdFALSE, pdTRUE, portMAX_DELAY); // 等待检测任务运行标志位
+        // 等待检测或输出任一运行标志位
+        xEventGroupWaitBits(event_group_, DETECTION_RUNNING_EVENT | OUTPUT_RUNNING_EVENT, pdFALSE, pdFALSE, portMAX_DELAY);
 
         auto res = esp_afe_sr_v1.fetch(afe_detection_data_); // 从AFE获取处理后的数据
         if (res == nullptr || res->ret_value == ESP_FAIL) {
@@ -152,8 +232,17 @@ void WakeWordDetect::AudioDetectionTask() {
             continue; // 如果获取数据失败，则继续
         }
 
-        // 存储唤醒词数据用于语音识别，例如识别说话者
-        StoreWakeWordData((uint16_t*)res->data, res->data_size / sizeof(uint16_t));
+        auto bits = xEventGroupGetBits(event_group_);
+        if (bits & OUTPUT_RUNNING_EVENT) {
+            // 语音通信角色：处理后的音频交给上行，此时 WakeNet 已关闭，不需要保存唤醒词音频
+            if (output_callback_) {
+                output_buffer_.assign((int16_t*)res->data, (int16_t*)res->data + res->data_size / sizeof(int16_t));
+                output_callback_(output_buffer_);
+            }
+        } else {
+            // 存储唤醒词数据用于语音识别，例如识别说话者
+            StoreWakeWordData((const int16_t*)res->data, res->data_size / sizeof(int16_t));
+        }
 
         // 语音活动检测状态变化
         if (vad_state_change_callback_) {
@@ -167,8 +256,9 @@ void WakeWordDetect::AudioDetectionTask() {
         }
 
         // 检测到唤醒词
-        if (res->wakeup_state == WAKENET_DETECTED) {
+        if ((bits & DETECTION_RUNNING_EVENT) && res->wakeup_state == WAKENET_DETECTED) {
             StopDetection(); // 停止检测任务
+            last_detected_time_us_ = esp_timer_get_time();
             last_detected_wake_word_ = wake_words_[res->wake_word_index - 1]; // 获取检测到的唤醒词
 
             if (wake_word_detected_callback_) {
@@ -178,58 +268,101 @@ void WakeWordDetect::AudioDetectionTask() {
     }
 }
 
-// 存储唤醒词数据
-void WakeWordDetect::StoreWakeWordData(uint16_t* data, size_t samples) {
-    // 将音频数据存储到wake_word_pcm_
-    wake_word_pcm_.emplace_back(std::vector<int16_t>(data, data + samples));
-    // 保留约2秒的数据，检测时长为32ms（采样率为16000，每次处理512个样本）
-    while (wake_word_pcm_.size() > 2000 / 32) {
-        wake_word_pcm_.pop_front(); // 删除最早的数据
+// 存储唤醒词数据：写入 PCM 环并唤醒编码任务，积压超过容量时丢弃最旧的数据
+void WakeWordDetect::StoreWakeWordData(const int16_t* data, size_t samples) {
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    if (wake_word_pcm_ == nullptr || wake_word_sealed_) {
+        return;
     }
+    const size_t capacity = wake_word_pcm_capacity_;
+    if (samples > capacity) {
+        data += samples - capacity;
+        samples = capacity;
+    }
+    if (wake_word_pcm_used_ + samples > capacity) {
+        size_t overflow = wake_word_pcm_used_ + samples - capacity;
+        wake_word_pcm_read_ = (wake_word_pcm_read_ + overflow) % capacity;
+        wake_word_pcm_used_ -= overflow;
+    }
+    size_t write_pos = (wake_word_pcm_read_ + wake_word_pcm_used_) % capacity;
+    size_t first = std::min(samples, capacity - write_pos);
+    memcpy(wake_word_pcm_ + write_pos, data, first * sizeof(int16_t));
+    memcpy(wake_word_pcm_, data + first, (samples - first) * sizeof(int16_t));
+    wake_word_pcm_used_ += samples;
+    wake_word_cv_.notify_all();
 }
 
-// 编码唤醒词数据
-void WakeWordDetect::EncodeWakeWordData() {
-    wake_word_opus_.clear(); // 清空Opus编码数据
-    if (wake_word_encode_task_stack_ == nullptr) {
-        wake_word_encode_task_stack_ = (StackType_t*)heap_caps_malloc(4096 * 8, MALLOC_CAP_SPIRAM); // 分配编码任务栈内存
-    }
-    wake_word_encode_task_ = xTaskCreateStatic([](void* arg) {
-        auto this_ = (WakeWordDetect*)arg;
+// 常驻编码任务：每凑满一包就编码，包环中只保留最近 WAKE_WORD_PREROLL_PACKETS 个数据包
+// 封存后把剩余的整包编码完，不足一包的尾部丢弃，然后通知 GetWakeWordOpus
+void WakeWordDetect::WakeWordEncodeTask() {
+    const size_t frame_samples = 16000 / 1000 * OPUS_FRAME_DURATION_MS;
+    auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS); // 创建Opus编码器
+    encoder->SetComplexity(0); // 设置编码复杂度为0（最快）
+    std::vector<int16_t> frame;
+    std::vector<uint8_t> evicted;
+    uint32_t generation = 0;
+
+    while (true) {
         {
-            auto start_time = esp_timer_get_time(); // 获取开始时间
-            auto encoder = std::make_unique<OpusEncoderWrapper>(16000, 1, OPUS_FRAME_DURATION_MS); // 创建Opus编码器
-            encoder->SetComplexity(0); // 设置编码复杂度为0（最快）
-
-            // 对PCM数据进行编码
-            for (auto& pcm: this_->wake_word_pcm_) {
-                encoder->Encode(std::move(pcm), [this_](std::vector<uint8_t>&& opus) {
-                    std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-                    this_->wake_word_opus_.emplace_back(std::move(opus)); // 存储编码后的数据
-                    this_->wake_word_cv_.notify_all(); // 通知等待的线程
-                });
+            std::unique_lock<std::mutex> lock(wake_word_mutex_);
+            wake_word_cv_.wait(lock, [this, frame_samples]() {
+                return wake_word_pcm_used_ >= frame_samples || wake_word_flushing_ || wake_word_reset_encoder_;
+            });
+            if (wake_word_reset_encoder_) {
+                encoder->ResetState();
+                wake_word_reset_encoder_ = false;
+            }
+            if (wake_word_pcm_used_ < frame_samples) {
+                if (wake_word_flushing_) {
+                    wake_word_pcm_used_ = 0;
+                    wake_word_flushing_ = false;
+                    wake_word_cv_.notify_all();
+                }
+                continue;
             }
-            this_->wake_word_pcm_.clear(); // 清空PCM数据
+            frame.resize(frame_samples);
+            size_t first = std::min(frame_samples, wake_word_pcm_capacity_ - wake_word_pcm_read_);
+            memcpy(frame.data(), wake_word_pcm_ + wake_word_pcm_read_, first * sizeof(int16_t));
+            memcpy(frame.data() + first, wake_word_pcm_, (frame_samples - first) * sizeof(int16_t));
+            wake_word_pcm_read_ = (wake_word_pcm_read_ + frame_samples) % wake_word_pcm_capacity_;
+            wake_word_pcm_used_ -= frame_samples;
+            generation = wake_word_generation_;
+        }
 
-            auto end_time = esp_timer_get_time(); // 获取结束时间
-            ESP_LOGI(TAG, "Encode wake word opus %zu packets in %lld ms",
-                this_->wake_word_opus_.size(), (end_time - start_time) / 1000); // 日志：编码完成
+        // 编码在锁外进行，检测任务写入 PCM 不会被阻塞
+        encoder->Encode(std::move(frame), [this, &evicted, generation](std::vector<uint8_t>&& opus) {
+            std::lock_guard<std::mutex> lock(wake_word_mutex_);
+            if (generation != wake_word_generation_) {
+                return;  // 编码期间 StartDetection 清空了包环，这一帧属于上一轮预录
+            }
+            while (wake_word_packets_ >= WAKE_WORD_PREROLL_PACKETS && wake_word_opus_.Pop(evicted)) {
+                wake_word_packets_--;
+            }
+            if (wake_word_opus_.Push(opus.data(), opus.size())) {
+                wake_word_packets_++;
+            }
+        });
+    }
+}
 
-            std::lock_guard<std::mutex> lock(this_->wake_word_mutex_);
-            this_->wake_word_opus_.push_back(std::vector<uint8_t>()); // 添加空数据表示编码结束
-            this_->wake_word_cv_.notify_all(); // 通知等待的线程
-        }
-        vTaskDelete(NULL); // 任务完成后删除任务
-    }, "encode_detect_packets", 4096 * 8, this, 2, wake_word_encode_task_stack_, &wake_word_encode_task_buffer_);
+// 检测到唤醒词后调用：封存预录，此时大部分数据包已经编码完成
+void WakeWordDetect::EncodeWakeWordData() {
+    std::lock_guard<std::mutex> lock(wake_word_mutex_);
+    wake_word_sealed_ = true;
+    wake_word_flushing_ = wake_word_pcm_ != nullptr;
+    wake_word_cv_.notify_all();
 }
 
-// 获取编码后的唤醒词数据
+// 获取编码后的唤醒词数据，取完时返回 false
 bool WakeWordDetect::GetWakeWordOpus(std::vector<uint8_t>& opus) {
     std::unique_lock<std::mutex> lock(wake_word_mutex_);
     wake_word_cv_.wait(lock, [this]() {
-        return !wake_word_opus_.empty(); // 等待编码数据可用
+        return !wake_word_flushing_; // 等待剩余的整包编码完成
     });
-    opus.swap(wake_word_opus_.front()); // 获取编码数据
-    wake_word_opus_.pop_front(); // 删除已获取的数据
-    return !opus.empty(); // 返回是否获取到有效数据
-}
\ No newline at end of file
+    if (wake_word_opus_.Pop(opus)) {
+        wake_word_packets_--;
+        return true;
+    }
+    opus.clear();
+    return false;
+}
@@ -5,10 +5,12 @@
 #include <freertos/task.h>
 #include <freertos/event_groups.h>
 
+#include "afe_feed_ring.h"
+#include "audio_packet_ring.h"
+
 #include <esp_afe_sr_models.h>
 #include <esp_nsn_models.h>
 
-#include <list>
 #include <string>
 #include <vector>
 #include <functional>
@@ -28,32 +30,59 @@ public:
     void StartDetection();
     void StopDetection();
     bool IsDetectionRunning();
+    size_t GetFeedSize();
     void EncodeWakeWordData();
     bool GetWakeWordOpus(std::vector<uint8_t>& opus);
     const std::string& GetLastDetectedWakeWord() const { return last_detected_wake_word_; }
+    // 最近一次检测到唤醒词的时间，用于统计唤醒到首个上行包的延迟
+    int64_t GetLastDetectedTime() const { return last_detected_time_us_; }
+
+    // 共享前端模式下，同一个 AFE 的输出在监听状态下直接作为上行音频，不再单独创建语音通信 AFE
+    // 输出期间关闭 WakeNet，停止输出后恢复
+    void OnOutput(std::function<void(const std::vector<int16_t>& data)> callback);
+    void StartOutput();
+    void StopOutput();
+    bool IsOutputRunning();
+    // 检测或输出任一在运行，需要喂入音频
+    bool IsRunning();
 
 private:
     esp_afe_sr_data_t* afe_detection_data_ = nullptr;
     char* wakenet_model_ = NULL;
     std::vector<std::string> wake_words_;
-    std::vector<int16_t> input_buffer_;
+    AfeFeedRing input_ring_;
     EventGroupHandle_t event_group_;
     std::function<void(const std::string& wake_word)> wake_word_detected_callback_;
     std::function<void(bool speaking)> vad_state_change_callback_;
+    std::function<void(const std::vector<int16_t>& data)> output_callback_;
+    std::vector<int16_t> output_buffer_;
     bool is_speaking_ = false;
     int channels_;
     bool reference_;
     std::string last_detected_wake_word_;
 
+    int64_t last_detected_time_us_ = 0;
+
+    // 唤醒词预录：检测任务把 AFE 输出写入 PCM 环，常驻的编码任务持续编码，
+    // Opus 包环中始终保留最近约 2 秒的数据包，检测到唤醒词时只需编码不足一包的尾部
     TaskHandle_t wake_word_encode_task_ = nullptr;
     StaticTask_t wake_word_encode_task_buffer_;
     StackType_t* wake_word_encode_task_stack_ = nullptr;
-    std::list<std::vector<int16_t>> wake_word_pcm_;
-    std::list<std::vector<uint8_t>> wake_word_opus_;
+    int16_t* wake_word_pcm_ = nullptr;  // PSRAM 中的定长 PCM 环
+    size_t wake_word_pcm_capacity_ = 0;
+    size_t wake_word_pcm_read_ = 0;
+    size_t wake_word_pcm_used_ = 0;
+    AudioPacketRing wake_word_opus_;
+    size_t wake_word_packets_ = 0;       // 包环中的数据包数
+    bool wake_word_sealed_ = false;      // 已检测到唤醒词，等待取走数据包
+    bool wake_word_flushing_ = false;    // 编码任务尚未处理完封存前写入的 PCM
+    bool wake_word_reset_encoder_ = false;
+    uint32_t wake_word_generation_ = 0;  // 每次清空包环时加一，编码任务据此丢弃清空前取出的帧
     std::mutex wake_word_mutex_;
     std::condition_variable wake_word_cv_;
 
-    void StoreWakeWordData(uint16_t* data, size_t size);
+    void StoreWakeWordData(const int16_t* data, size_t samples);
+    void WakeWordEncodeTask();
     void AudioDetectionTask();
 };
 
@@ -1,7 +1,6 @@
 #include "background_task.h"
 
 #include <esp_log.h>
-#include <esp_task_wdt.h>
 
 #define TAG "BackgroundTask"  // 日志标签
 
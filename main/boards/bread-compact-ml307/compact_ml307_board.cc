@@ -45,6 +45,11 @@ private:
 
     // 初始化按钮
     void InitializeButtons() {
+        // 按下时还不知道是单击还是长按，先在后台提前建立连接
+        boot_button_.OnPressDown([this]() {
+            Application::GetInstance().PreConnect();
+        });
+
         // 启动按钮点击事件
         boot_button_.OnClick([this]() {
             Application::GetInstance().ToggleChatState(); // 切换聊天状态
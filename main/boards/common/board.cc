@@ -5,9 +5,13 @@
 #include "assets/lang_config.h"
 
 #include <esp_log.h>
+#if !CONFIG_IDF_TARGET_LINUX
 #include <esp_ota_ops.h>
 #include <esp_chip_info.h>
 #include <esp_random.h>
+#else
+#include <random>
+#endif
 
 #define TAG "Board" // 定义日志标签
 // Board类的构造函数
@@ -36,8 +40,16 @@ std::string Board::GenerateUuid()
     // UUID v4 需要 16 字节的随机数据
     uint8_t uuid[16];
 
+#if !CONFIG_IDF_TARGET_LINUX
     // 使用ESP32的硬件随机数生成器填充UUID数组
     esp_fill_random(uuid, sizeof(uuid));
+#else
+    // 主机上没有硬件随机数生成器，使用系统熵源
+    std::random_device random;
+    for (auto& byte : uuid) {
+        byte = (uint8_t)random();
+    }
+#endif
 
     // 设置UUID版本 (版本 4) 和变体位
     uuid[6] = (uuid[6] & 0x0F) | 0x40; // 版本 4
@@ -105,6 +117,7 @@ std::string Board::GetJson()
     // 添加芯片型号名称（如"ESP32"）
     json += "\"chip_model_name\":\"" + SystemInfo::GetChipModelName() + "\",";
 
+#if !CONFIG_IDF_TARGET_LINUX
     // 开始芯片信息的嵌套对象
     json += "\"chip_info\":{";
 
@@ -187,6 +200,7 @@ std::string Board::GetJson()
     // 添加分区标签（如"ota_0"）
     json += "\"label\":\"" + std::string(ota_partition->label) + "\"";
     json += "},";
+#endif
 
     // 添加板级信息（通过子类实现的具体硬件信息）
     json += "\"board\":" + GetBoardJson();
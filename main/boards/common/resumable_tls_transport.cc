@@ -0,0 +1,104 @@
+#include "resumable_tls_transport.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <esp_crt_bundle.h>
+#include <cstring>
+
+#define TAG "ResumableTls"
+
+ResumableTlsTransport::ResumableTlsTransport() {
+}
+
+ResumableTlsTransport::~ResumableTlsTransport() {
+    Disconnect();
+}
+
+bool ResumableTlsTransport::Handshake(esp_tls_client_session_t* session) {
+    esp_tls_cfg_t cfg = {};
+    cfg.crt_bundle_attach = esp_crt_bundle_attach;
+    cfg.client_session = session;
+
+    tls_client_ = esp_tls_init();
+    if (tls_client_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to initialize TLS");
+        return false;
+    }
+    if (esp_tls_conn_new_sync(host_.c_str(), host_.size(), port_, &cfg, tls_client_) != 1) {
+        esp_tls_conn_destroy(tls_client_);
+        tls_client_ = nullptr;
+        return false;
+    }
+    return true;
+}
+
+// 先携带缓存的会话握手，失败时作废缓存并退回完整握手
+bool ResumableTlsTransport::Connect(const char* host, int port) {
+    auto& cache = TlsSessionCache::GetInstance();
+    host_ = host;
+    port_ = port;
+
+    auto session = cache.Lookup(host_, port_);
+    int64_t start_time = esp_timer_get_time();
+    bool resumed = session != nullptr;
+    if (resumed && !Handshake(session.get())) {
+        ESP_LOGW(TAG, "Handshake with cached session failed, retry with full handshake");
+        cache.Invalidate(host_, port_);
+        resumed = false;
+        start_time = esp_timer_get_time();
+    }
+    if (tls_client_ == nullptr && !Handshake(nullptr)) {
+        ESP_LOGE(TAG, "Failed to connect to %s:%d", host, port);
+        return false;
+    }
+    int64_t duration = esp_timer_get_time() - start_time;
+    cache.RecordHandshake(resumed, duration);
+    cache.Store(host_, port_, esp_tls_get_client_session(tls_client_));
+
+    auto stats = cache.GetStats();
+    ESP_LOGI(TAG, "Connected to %s:%d in %lld ms (%s), sessions hit %lu miss %lu failed %lu, avg resumed %lu ms full %lu ms",
+        host, port, duration / 1000, resumed ? "resumed" : "full",
+        stats.hits, stats.misses, stats.failures, stats.resumed_avg_ms, stats.full_avg_ms);
+    connected_ = true;
+    return true;
+}
+
+void ResumableTlsTransport::Disconnect() {
+    if (tls_client_ != nullptr) {
+        // TLS 1.3 的票据在握手之后才下发，断开前再取一次
+        if (connected_) {
+            TlsSessionCache::GetInstance().Store(host_, port_, esp_tls_get_client_session(tls_client_));
+        }
+        esp_tls_conn_destroy(tls_client_);
+        tls_client_ = nullptr;
+    }
+    connected_ = false;
+}
+
+int ResumableTlsTransport::Send(const char* data, size_t length) {
+    size_t total_sent = 0;
+    while (total_sent < length) {
+        int ret = esp_tls_conn_write(tls_client_, data + total_sent, length - total_sent);
+        if (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE) {
+            continue;
+        }
+        if (ret <= 0) {
+            ESP_LOGE(TAG, "Send failed: %d", ret);
+            connected_ = false;
+            return ret;
+        }
+        total_sent += ret;
+    }
+    return total_sent;
+}
+
+int ResumableTlsTransport::Receive(char* buffer, size_t bufferSize) {
+    int ret;
+    do {
+        ret = esp_tls_conn_read(tls_client_, buffer, bufferSize);
+    } while (ret == ESP_TLS_ERR_SSL_WANT_READ || ret == ESP_TLS_ERR_SSL_WANT_WRITE);
+    if (ret <= 0) {
+        connected_ = false;
+    }
+    return ret;
+}
@@ -0,0 +1,30 @@
+#ifndef RESUMABLE_TLS_TRANSPORT_H
+#define RESUMABLE_TLS_TRANSPORT_H
+
+#include "tls_session_cache.h"
+
+#include <transport.h>
+#include <esp_tls.h>
+#include <string>
+
+// 与 TlsTransport 相同的 esp-tls 传输层，连接时携带 TlsSessionCache 中的会话做简化握手，
+// 握手完成和断开时把服务器下发的最新会话存回缓存
+class ResumableTlsTransport : public Transport {
+public:
+    ResumableTlsTransport();
+    ~ResumableTlsTransport();
+
+    bool Connect(const char* host, int port) override;
+    void Disconnect() override;
+    int Send(const char* data, size_t length) override;
+    int Receive(char* buffer, size_t bufferSize) override;
+
+private:
+    esp_tls_t* tls_client_ = nullptr;
+    std::string host_;
+    int port_ = 0;
+
+    bool Handshake(esp_tls_client_session_t* session);
+};
+
+#endif // RESUMABLE_TLS_TRANSPORT_H
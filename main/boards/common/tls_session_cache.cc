@@ -0,0 +1,74 @@
+#include "tls_session_cache.h"
+
+#include <esp_log.h>
+
+#define TAG "TlsSessionCache"
+
+// 内存中最多缓存的 wss:// 服务器数
+#define TLS_SESSION_CACHE_ENTRIES 4
+
+static std::string MakeKey(const std::string& host, int port) {
+    return host + ":" + std::to_string(port);
+}
+
+TlsSessionCache::Session TlsSessionCache::Wrap(esp_tls_client_session_t* session) {
+    return Session(session, [](esp_tls_client_session_t* session) {
+        esp_tls_free_client_session(session);
+    });
+}
+
+TlsSessionCache::Session TlsSessionCache::Lookup(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = MakeKey(host, port);
+    for (auto it = entries_.begin(); it != entries_.end(); ++it) {
+        if (it->key == key) {
+            entries_.splice(entries_.begin(), entries_, it);
+            hits_++;
+            return it->session;
+        }
+    }
+    misses_++;
+    return nullptr;
+}
+
+void TlsSessionCache::Store(const std::string& host, int port, esp_tls_client_session_t* session) {
+    if (session == nullptr) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = MakeKey(host, port);
+    entries_.remove_if([&key](const Entry& entry) { return entry.key == key; });
+    entries_.push_front({key, Wrap(session)});
+    while (entries_.size() > TLS_SESSION_CACHE_ENTRIES) {
+        entries_.pop_back();
+    }
+}
+
+void TlsSessionCache::Invalidate(const std::string& host, int port) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    auto key = MakeKey(host, port);
+    entries_.remove_if([&key](const Entry& entry) { return entry.key == key; });
+    failures_++;
+}
+
+void TlsSessionCache::RecordHandshake(bool resumed, int64_t duration_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (resumed) {
+        resumed_count_++;
+        resumed_total_us_ += duration_us;
+    } else {
+        full_count_++;
+        full_total_us_ += duration_us;
+    }
+}
+
+TlsSessionCache::Stats TlsSessionCache::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.hits = hits_;
+    stats.misses = misses_;
+    stats.failures = failures_;
+    stats.resumed_avg_ms = resumed_count_ > 0 ? resumed_total_us_ / resumed_count_ / 1000 : 0;
+    stats.full_avg_ms = full_count_ > 0 ? full_total_us_ / full_count_ / 1000 : 0;
+    return stats;
+}
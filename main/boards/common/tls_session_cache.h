@@ -0,0 +1,66 @@
+#ifndef TLS_SESSION_CACHE_H
+#define TLS_SESSION_CACHE_H
+
+#include <esp_tls.h>
+
+#include <string>
+#include <memory>
+#include <mutex>
+#include <list>
+
+// TLS 会话缓存：按 host:port 保存上一次握手得到的会话（session ticket 或 session ID），
+// 下一次连接同一服务器时交给 esp-tls 做简化握手，省去证书链校验与密钥交换。
+// 会话只保存在内存中：esp-tls 只公开不透明的 esp_tls_client_session_t，没有从序列化数据重建会话的接口，
+// 重启后的第一次连接仍是完整握手。
+// 目前只有 wss:// 的 ResumableTlsTransport 使用；esp_http_client（OTA）与 esp-mqtt 不支持传入会话，
+// 它们的连接仍是完整握手。
+class TlsSessionCache {
+public:
+    using Session = std::shared_ptr<esp_tls_client_session_t>;
+
+    struct Stats {
+        uint32_t hits;           // 有缓存会话可用的连接次数
+        uint32_t misses;         // 没有缓存会话、进行完整握手的次数
+        uint32_t failures;       // 携带缓存会话握手失败、缓存被作废的次数
+        uint32_t resumed_avg_ms; // 携带缓存会话的平均握手耗时
+        uint32_t full_avg_ms;    // 完整握手的平均耗时
+    };
+
+    static TlsSessionCache& GetInstance() {
+        static TlsSessionCache instance;
+        return instance;
+    }
+    TlsSessionCache(const TlsSessionCache&) = delete;
+    TlsSessionCache& operator=(const TlsSessionCache&) = delete;
+
+    // 取出缓存的会话，握手期间由调用方持有引用；没有缓存时返回空
+    Session Lookup(const std::string& host, int port);
+    // 握手完成后保存服务器下发的会话
+    void Store(const std::string& host, int port, esp_tls_client_session_t* session);
+    // 携带缓存会话握手失败时作废，下一次进行完整握手
+    void Invalidate(const std::string& host, int port);
+    // 记录一次握手的耗时，resumed 表示是否携带了缓存会话
+    void RecordHandshake(bool resumed, int64_t duration_us);
+    Stats GetStats();
+
+private:
+    struct Entry {
+        std::string key;  // host:port
+        Session session;
+    };
+
+    std::mutex mutex_;
+    std::list<Entry> entries_;  // 最近使用的在前
+    uint32_t hits_ = 0;
+    uint32_t misses_ = 0;
+    uint32_t failures_ = 0;
+    uint32_t resumed_count_ = 0;
+    uint32_t full_count_ = 0;
+    uint64_t resumed_total_us_ = 0;
+    uint64_t full_total_us_ = 0;
+
+    TlsSessionCache() = default;
+    static Session Wrap(esp_tls_client_session_t* session);
+};
+
+#endif // TLS_SESSION_CACHE_H
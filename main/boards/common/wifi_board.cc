@@ -16,6 +16,9 @@
 #include <tls_transport.h>
 #include <web_socket.h>
 #include <esp_log.h>
+#if CONFIG_TLS_SESSION_CACHE
+#include "resumable_tls_transport.h"
+#endif
 
 #include <wifi_station.h>
 #include <wifi_configuration_ap.h>
@@ -179,7 +182,11 @@ WebSocket* WifiBoard::CreateWebSocket() {
     // 检查URL是否使用安全WebSocket协议（wss://）
     if (url.find("wss://") == 0) {
         // 创建使用TLS加密传输层的WebSocket实例
+#if CONFIG_TLS_SESSION_CACHE
+        return new WebSocket(new ResumableTlsTransport());  // 重连时复用缓存的 TLS 会话
+#else
         return new WebSocket(new TlsTransport());  // TLS传输层提供加密通信
+#endif
     } else {
         // 创建使用普通TCP传输层的WebSocket实例
         return new WebSocket(new TcpTransport());  // TCP传输层提供明文通信
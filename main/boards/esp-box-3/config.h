@@ -7,6 +7,12 @@
 #define AUDIO_OUTPUT_SAMPLE_RATE 24000
 
 #define AUDIO_INPUT_REFERENCE    true
+// ES7210 四路麦克风中送入 AFE 的路数
+#ifdef CONFIG_AUDIO_INPUT_MIC_COUNT
+#define AUDIO_INPUT_MIC_COUNT    CONFIG_AUDIO_INPUT_MIC_COUNT
+#else
+#define AUDIO_INPUT_MIC_COUNT    1
+#endif
 
 #define AUDIO_I2S_GPIO_MCLK GPIO_NUM_2
 #define AUDIO_I2S_GPIO_WS GPIO_NUM_45
@@ -79,6 +79,11 @@ private:
 
     // 初始化按钮
     void InitializeButtons() {
+        // 按下时还不知道是单击还是长按，先在后台提前建立连接
+        boot_button_.OnPressDown([this]() {
+            Application::GetInstance().PreConnect();
+        });
+
         boot_button_.OnClick([this]() {
             auto& app = Application::GetInstance();
             if (app.GetDeviceState() == kDeviceStateStarting && !WifiStation::GetInstance().IsConnected()) {
@@ -167,7 +172,8 @@ public:
             AUDIO_CODEC_PA_PIN, 
             AUDIO_CODEC_ES8311_ADDR, 
             AUDIO_CODEC_ES7210_ADDR, 
-            AUDIO_INPUT_REFERENCE);  // 返回Box音频编解码器对象
+            AUDIO_INPUT_REFERENCE,
+            AUDIO_INPUT_MIC_COUNT);  // 返回Box音频编解码器对象
         return &audio_codec;
     }
 
@@ -277,7 +277,8 @@ public:
             AUDIO_CODEC_PA_PIN, 
             AUDIO_CODEC_ES8311_ADDR, 
             AUDIO_CODEC_ES7210_ADDR, 
-            AUDIO_INPUT_REFERENCE);  // 创建Box音频编解码器对象
+            AUDIO_INPUT_REFERENCE,
+            AUDIO_INPUT_MIC_COUNT);  // 创建Box音频编解码器对象
         return &audio_codec;
     }
 
@@ -0,0 +1,15 @@
+#ifndef _BOARD_CONFIG_H_
+#define _BOARD_CONFIG_H_
+
+// 输出采样率与常见服务端 TTS 一致，下行同样会经过重采样
+#define AUDIO_OUTPUT_SAMPLE_RATE 24000
+
+// 环境变量可覆盖 Kconfig 中的默认值，便于 CI 中回放不同录音
+#define HOST_ENV_WAV_INPUT    "XIAOZHI_WAV_INPUT"
+#define HOST_ENV_WAV_OUTPUT   "XIAOZHI_WAV_OUTPUT"
+#define HOST_ENV_REALTIME     "XIAOZHI_REALTIME"
+
+// 输入读完且不在播放状态持续该时长后退出进程
+#define HOST_EXIT_IDLE_MS     3000
+
+#endif // _BOARD_CONFIG_H_
@@ -0,0 +1,44 @@
+#include "display.h"
+
+#include <esp_log.h>
+
+#define TAG "Display"
+
+// linux 目标没有屏幕也不链接 LVGL，Display 的状态、通知、表情和聊天消息改为输出到日志
+// 默认的 NoDisplay 继承自这里，不需要定时器和电源管理锁
+
+Display::Display() {
+}
+
+Display::~Display() {
+}
+
+void Display::SetStatus(const char* status) {
+    ESP_LOGI(TAG, "Status: %s", status);
+}
+
+void Display::ShowNotification(const std::string &notification, int duration_ms) {
+    ShowNotification(notification.c_str(), duration_ms);
+}
+
+void Display::ShowNotification(const char* notification, int duration_ms) {
+    ESP_LOGI(TAG, "Notification: %s", notification);
+}
+
+void Display::Update() {
+}
+
+void Display::SetEmotion(const char* emotion) {
+    ESP_LOGI(TAG, "Emotion: %s", emotion);
+}
+
+void Display::SetIcon(const char* icon) {
+}
+
+void Display::SetChatMessage(const char* role, const char* content) {
+    // 清空消息时不输出
+    if (content == nullptr || content[0] == '\0') {
+        return;
+    }
+    ESP_LOGI(TAG, "%s: %s", role, content);
+}
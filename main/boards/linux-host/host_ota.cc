@@ -0,0 +1,38 @@
+#include "ota.h"
+
+#include <esp_log.h>
+
+#define TAG "Ota"
+
+// linux 目标没有 OTA 分区，回环协议下也没有版本检查服务器
+// Application 只在非回环方式下调用 CheckVersion，这里的实现只保证 Ota 成员可以链接
+
+Ota::Ota() {
+}
+
+Ota::~Ota() {
+}
+
+void Ota::SetCheckVersionUrl(std::string check_version_url) {
+    check_version_url_ = check_version_url;
+}
+
+void Ota::SetHeader(const std::string& key, const std::string& value) {
+    headers_[key] = value;
+}
+
+void Ota::SetPostData(const std::string& post_data) {
+    post_data_ = post_data;
+}
+
+bool Ota::CheckVersion() {
+    ESP_LOGW(TAG, "Version check is not supported on the linux target");
+    return false;
+}
+
+void Ota::MarkCurrentVersionValid() {
+}
+
+void Ota::StartUpgrade(std::function<void(int progress, size_t speed)> callback) {
+    ESP_LOGW(TAG, "Upgrade is not supported on the linux target");
+}
@@ -0,0 +1,142 @@
+#include <esp_timer.h>
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+
+#include <time.h>
+#include <list>
+#include <mutex>
+
+#define TAG "HostShim"
+
+// 定时器分发任务的轮询间隔，主机上 FreeRTOS 的节拍为 1ms
+#define TIMER_POLL_MS 1
+
+struct esp_timer {
+    esp_timer_cb_t callback;
+    void* arg;
+    const char* name;
+    int64_t next_time_us;
+    uint64_t period_us;  // 0 表示单次定时器
+    bool active;
+};
+
+namespace {
+
+std::mutex timers_mutex;
+std::list<esp_timer*> timers;
+TaskHandle_t timer_task_handle = nullptr;
+
+void TimerTaskLoop(void* arg) {
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(TIMER_POLL_MS));
+        int64_t now = esp_timer_get_time();
+        // 逐个取出到期的定时器，在锁外调用回调，回调中可以重新启动或停止定时器
+        while (true) {
+            esp_timer_cb_t callback = nullptr;
+            void* callback_arg = nullptr;
+            {
+                std::lock_guard<std::mutex> lock(timers_mutex);
+                for (auto timer : timers) {
+                    if (timer->active && timer->next_time_us <= now) {
+                        callback = timer->callback;
+                        callback_arg = timer->arg;
+                        if (timer->period_us > 0) {
+                            timer->next_time_us += timer->period_us;
+                            if (timer->next_time_us <= now) {
+                                timer->next_time_us = now + timer->period_us;
+                            }
+                        } else {
+                            timer->active = false;
+                        }
+                        break;
+                    }
+                }
+            }
+            if (callback == nullptr) {
+                break;
+            }
+            callback(callback_arg);
+        }
+    }
+}
+
+esp_err_t Start(esp_timer_handle_t timer, uint64_t timeout_us, uint64_t period_us) {
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->next_time_us = esp_timer_get_time() + timeout_us;
+    timer->period_us = period_us;
+    timer->active = true;
+    return ESP_OK;
+}
+
+} // namespace
+
+extern "C" {
+
+int64_t esp_timer_get_time(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (int64_t)ts.tv_sec * 1000000 + ts.tv_nsec / 1000;
+}
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (esp_cpu_cycle_count_t)((uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec);
+}
+
+esp_err_t esp_timer_create(const esp_timer_create_args_t* create_args, esp_timer_handle_t* out_handle) {
+    if (create_args == nullptr || create_args->callback == nullptr || out_handle == nullptr) {
+        return ESP_ERR_INVALID_ARG;
+    }
+    if (create_args->dispatch_method != ESP_TIMER_TASK) {
+        ESP_LOGW(TAG, "Timer %s: only ESP_TIMER_TASK dispatch is supported on host", create_args->name);
+    }
+
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    if (timer_task_handle == nullptr) {
+        xTaskCreate(TimerTaskLoop, "esp_timer", 4096, nullptr, 22, &timer_task_handle);
+    }
+    auto timer = new esp_timer{create_args->callback, create_args->arg, create_args->name, 0, 0, false};
+    timers.push_back(timer);
+    *out_handle = timer;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_start_once(esp_timer_handle_t timer, uint64_t timeout_us) {
+    return Start(timer, timeout_us, 0);
+}
+
+esp_err_t esp_timer_start_periodic(esp_timer_handle_t timer, uint64_t period) {
+    return Start(timer, period, period);
+}
+
+esp_err_t esp_timer_stop(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    if (!timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timer->active = false;
+    return ESP_OK;
+}
+
+esp_err_t esp_timer_delete(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    if (timer->active) {
+        return ESP_ERR_INVALID_STATE;
+    }
+    timers.remove(timer);
+    delete timer;
+    return ESP_OK;
+}
+
+bool esp_timer_is_active(esp_timer_handle_t timer) {
+    std::lock_guard<std::mutex> lock(timers_mutex);
+    return timer->active;
+}
+
+} // extern "C"
@@ -0,0 +1,33 @@
+#include "system_info.h"
+
+#include <esp_log.h>
+
+#define TAG "SystemInfo"
+
+// linux 目标没有 flash、MAC 地址与 ESP 堆统计，返回固定值，只用于 Board::GetJson
+
+size_t SystemInfo::GetFlashSize() {
+    return 0;
+}
+
+size_t SystemInfo::GetMinimumFreeHeapSize() {
+    return 0;
+}
+
+size_t SystemInfo::GetFreeHeapSize() {
+    return 0;
+}
+
+std::string SystemInfo::GetMacAddress() {
+    // 本地管理地址，不会与真实设备冲突
+    return "02:00:00:00:00:01";
+}
+
+std::string SystemInfo::GetChipModelName() {
+    return std::string(CONFIG_IDF_TARGET);
+}
+
+esp_err_t SystemInfo::PrintRealTimeStats(TickType_t xTicksToWait) {
+    ESP_LOGW(TAG, "Real time stats are not supported on the linux target");
+    return ESP_ERR_NOT_SUPPORTED;
+}
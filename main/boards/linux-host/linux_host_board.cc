@@ -0,0 +1,103 @@
+#include "board.h"
+#include "audio_codecs/wav_file_audio_codec.h"
+#include "application.h"
+#include "config.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cstdlib>
+#include <cstring>
+
+#define TAG "LinuxHostBoard"
+
+// 主机板：WAV 文件代替麦克风和扬声器，默认的 NoDisplay/NoLed，没有网络（配合回环协议使用）
+// 启动后自动开始对话；输入读完并且播放结束后退出进程，便于在 CI 中批量回放
+class LinuxHostBoard : public Board {
+private:
+    esp_timer_handle_t session_timer_ = nullptr;
+    int idle_ms_ = 0;
+
+    static const char* GetEnv(const char* name, const char* default_value) {
+        const char* value = getenv(name);
+        return value != nullptr && value[0] != '\0' ? value : default_value;
+    }
+
+    virtual std::string GetBoardJson() override {
+        return "{\"type\":\"" BOARD_TYPE "\",\"name\":\"" BOARD_NAME "\"}";
+    }
+
+    void OnSessionTimer() {
+        auto& app = Application::GetInstance();
+        auto codec = static_cast<WavFileAudioCodec*>(GetAudioCodec());
+        auto state = app.GetDeviceState();
+        if (!codec->input_finished()) {
+            if (state == kDeviceStateIdle) {
+                app.ToggleChatState();
+            }
+            return;
+        }
+
+        idle_ms_ = state == kDeviceStateSpeaking ? 0 : idle_ms_ + 500;
+        if (idle_ms_ >= HOST_EXIT_IDLE_MS) {
+            ESP_LOGI(TAG, "Input finished and playback drained, exiting");
+            exit(0);
+        }
+    }
+
+public:
+    LinuxHostBoard() {
+        esp_timer_create_args_t session_timer_args = {
+            .callback = [](void* arg) {
+                ((LinuxHostBoard*)arg)->OnSessionTimer();
+            },
+            .arg = this,
+            .dispatch_method = ESP_TIMER_TASK,
+            .name = "session_timer",
+            .skip_unhandled_events = true,
+        };
+        ESP_ERROR_CHECK(esp_timer_create(&session_timer_args, &session_timer_));
+    }
+
+    virtual std::string GetBoardType() override {
+        return "linux-host";
+    }
+
+    virtual AudioCodec* GetAudioCodec() override {
+        static WavFileAudioCodec audio_codec(
+            GetEnv(HOST_ENV_WAV_INPUT, CONFIG_HOST_WAV_INPUT_FILE),
+            GetEnv(HOST_ENV_WAV_OUTPUT, CONFIG_HOST_WAV_OUTPUT_FILE),
+            AUDIO_OUTPUT_SAMPLE_RATE,
+            strcmp(GetEnv(HOST_ENV_REALTIME, CONFIG_HOST_AUDIO_REALTIME ? "1" : "0"), "0") != 0);
+        return &audio_codec;
+    }
+
+    virtual void StartNetwork() override {
+        // 没有网络，等协议创建完成后开始驱动会话
+        esp_timer_start_periodic(session_timer_, 500 * 1000);
+    }
+
+    virtual const char* GetNetworkStateIcon() override {
+        return nullptr;
+    }
+
+    virtual void SetPowerSaveMode(bool enabled) override {
+    }
+
+    virtual Http* CreateHttp() override {
+        return nullptr;
+    }
+
+    virtual WebSocket* CreateWebSocket() override {
+        return nullptr;
+    }
+
+    virtual Mqtt* CreateMqtt() override {
+        return nullptr;
+    }
+
+    virtual Udp* CreateUdp() override {
+        return nullptr;
+    }
+};
+
+DECLARE_BOARD(LinuxHostBoard);
@@ -0,0 +1,8 @@
+#ifndef _HOST_SHIM_DRIVER_GPIO_H_
+#define _HOST_SHIM_DRIVER_GPIO_H_
+
+// linux 目标没有 GPIO 驱动，board.h 引入的 backlight.h 只需要引脚类型
+
+typedef int gpio_num_t;
+
+#endif // _HOST_SHIM_DRIVER_GPIO_H_
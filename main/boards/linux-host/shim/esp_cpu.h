@@ -0,0 +1,21 @@
+#ifndef _HOST_SHIM_ESP_CPU_H_
+#define _HOST_SHIM_ESP_CPU_H_
+
+// ESP-IDF linux 目标下没有 CPU 周期计数器，以单调时钟的纳秒数代替
+// 自检日志中的“cycles”在主机上即为纳秒
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HOST_SHIM_ESP_CPU_H_
@@ -0,0 +1,8 @@
+#ifndef _HOST_SHIM_ESP_PM_H_
+#define _HOST_SHIM_ESP_PM_H_
+
+// linux 目标没有电源管理，display.h 中的成员只需要锁句柄类型
+
+typedef struct esp_pm_lock* esp_pm_lock_handle_t;
+
+#endif // _HOST_SHIM_ESP_PM_H_
@@ -0,0 +1,8 @@
+#ifndef _HOST_SHIM_FONT_AWESOME_SYMBOLS_H_
+#define _HOST_SHIM_FONT_AWESOME_SYMBOLS_H_
+
+// linux 目标不使用 xiaozhi-fonts，这里只定义 display 之外的源文件用到的图标，主机显示不绘制图标
+
+#define FONT_AWESOME_DOWNLOAD ""
+
+#endif // _HOST_SHIM_FONT_AWESOME_SYMBOLS_H_
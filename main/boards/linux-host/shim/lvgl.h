@@ -0,0 +1,10 @@
+#ifndef _HOST_SHIM_LVGL_H_
+#define _HOST_SHIM_LVGL_H_
+
+// linux 目标不链接 LVGL，display.h 中的成员只需要不透明类型，Display 的主机实现见 host_display.cc
+
+typedef struct _lv_font_t lv_font_t;
+typedef struct _lv_display_t lv_display_t;
+typedef struct _lv_obj_t lv_obj_t;
+
+#endif // _HOST_SHIM_LVGL_H_
@@ -0,0 +1,7 @@
+#ifndef _HOST_SHIM_MQTT_H_
+#define _HOST_SHIM_MQTT_H_
+
+// linux 目标不使用 esp-ml307，board.h 只需要该类型的声明，回环协议下 CreateMqtt 返回 nullptr
+class Mqtt;
+
+#endif // _HOST_SHIM_MQTT_H_
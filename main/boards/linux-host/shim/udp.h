@@ -0,0 +1,7 @@
+#ifndef _HOST_SHIM_UDP_H_
+#define _HOST_SHIM_UDP_H_
+
+// linux 目标不使用 esp-ml307，board.h 只需要该类型的声明，回环协议下 CreateUdp 返回 nullptr
+class Udp;
+
+#endif // _HOST_SHIM_UDP_H_
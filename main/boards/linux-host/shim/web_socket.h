@@ -0,0 +1,7 @@
+#ifndef _HOST_SHIM_WEB_SOCKET_H_
+#define _HOST_SHIM_WEB_SOCKET_H_
+
+// linux 目标不使用 esp-ml307，board.h 只需要该类型的声明，回环协议下 CreateWebSocket 返回 nullptr
+class WebSocket;
+
+#endif // _HOST_SHIM_WEB_SOCKET_H_
@@ -108,8 +108,8 @@ void SensecapAudioCodec::CreateDuplexChannels(gpio_num_t mclk, gpio_num_t bclk,
     i2s_chan_config_t chan_cfg = {
         .id = I2S_NUM_0,  // 使用 I2S 端口 0
         .role = I2S_ROLE_MASTER,  // 主模式
-        .dma_desc_num = 6,  // DMA 描述符数量
-        .dma_frame_num = 240,  // DMA 帧数量
+        .dma_desc_num = DmaDescNum(input_sample_rate_),  // DMA 描述符数量
+        .dma_frame_num = DmaFrameNum(input_sample_rate_),  // DMA 帧数量
         .auto_clear_after_cb = true,  // 回调后自动清除
         .auto_clear_before_cb = false,  // 回调前不自动清除
         .intr_priority = 0,  // 中断优先级
@@ -0,0 +1,187 @@
+#include "latency_tracer.h"
+
+#include <esp_log.h>
+#include <cstdio>
+#include <algorithm>
+
+#define TAG "LatencyTracer"
+
+static const char* const kMetricNames[kLatencyMetricCount] = {
+    "capture", "resample", "afe_feed", "afe_fetch", "encode", "send",
+    "receive", "decode", "output", "uplink", "downlink", "response",
+};
+
+// 没有起点的记录（如本地提示音、未能匹配到的 AFE 输出）不参与统计
+void LatencyTrace::Stamp(LatencyMetric stage) {
+#if CONFIG_AUDIO_LATENCY_TRACE
+    if (origin_us == 0) {
+        return;
+    }
+    uint32_t offset = esp_timer_get_time() - origin_us;
+    uint32_t previous = 0;
+    for (int i = stage - 1; i >= 0; i--) {
+        if (stamped & (1 << i)) {
+            previous = stage_us[i];
+            break;
+        }
+    }
+    stage_us[stage] = offset;
+    stamped |= 1 << stage;
+    LatencyTracer::GetInstance().Record(stage, offset - previous);
+#endif
+}
+
+void LatencyTrace::Finish(LatencyMetric metric) {
+#if CONFIG_AUDIO_LATENCY_TRACE
+    if (origin_us == 0) {
+        return;
+    }
+    for (int i = kLatencyStageCount - 1; i >= 0; i--) {
+        if (stamped & (1 << i)) {
+            LatencyTracer::GetInstance().Record(metric, stage_us[i]);
+            return;
+        }
+    }
+#endif
+}
+
+int LatencyHistogram::BucketIndex(uint32_t us) {
+    if (us < 4) {
+        return us;
+    }
+    int msb = 31 - __builtin_clz(us);
+    int index = 4 + (msb - 2) * 4 + ((us >> (msb - 2)) & 3);
+    return index < kBucketCount ? index : kBucketCount - 1;
+}
+
+// 返回桶的中点
+uint32_t LatencyHistogram::BucketValue(int index) {
+    if (index < 4) {
+        return index;
+    }
+    int shift = (index - 4) / 4;
+    uint32_t lower = (uint32_t)(4 + (index - 4) % 4) << shift;
+    return lower + ((1u << shift) >> 1);
+}
+
+void LatencyHistogram::Record(uint32_t us) {
+    count_++;
+    min_ = std::min(min_, us);
+    max_ = std::max(max_, us);
+    buckets_[BucketIndex(us)]++;
+}
+
+uint32_t LatencyHistogram::Percentile(int percent) const {
+    if (count_ == 0) {
+        return 0;
+    }
+    uint32_t target = ((uint64_t)count_ * percent + 99) / 100;
+    uint32_t seen = 0;
+    for (int i = 0; i < kBucketCount; i++) {
+        seen += buckets_[i];
+        if (seen >= target) {
+            return std::min(std::max(BucketValue(i), min_), max_);
+        }
+    }
+    return max_;
+}
+
+void LatencyHistogram::Reset() {
+    count_ = 0;
+    min_ = UINT32_MAX;
+    max_ = 0;
+    buckets_.fill(0);
+}
+
+const char* LatencyTracer::GetMetricName(LatencyMetric metric) {
+    return kMetricNames[metric];
+}
+
+void LatencyTracer::Record(LatencyMetric metric, uint32_t us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    histograms_[metric].Record(us);
+}
+
+void LatencyTracer::MarkUplinkSent() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    last_uplink_sent_us_ = esp_timer_get_time();
+}
+
+void LatencyTracer::ArmResponse() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    response_armed_ = true;
+}
+
+void LatencyTracer::MarkPlayback() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!response_armed_) {
+        return;
+    }
+    response_armed_ = false;
+    if (last_uplink_sent_us_ != 0) {
+        histograms_[kLatencyResponse].Record(esp_timer_get_time() - last_uplink_sent_us_);
+    }
+}
+
+std::string LatencyTracer::GetJson(bool reset) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    std::string json = "{";
+    char item[128];
+    for (int i = 0; i < kLatencyMetricCount; i++) {
+        auto& histogram = histograms_[i];
+        snprintf(item, sizeof(item), "%s\"%s\":{\"count\":%lu,\"min\":%lu,\"p50\":%lu,\"p99\":%lu,\"max\":%lu}",
+            i > 0 ? "," : "", kMetricNames[i], histogram.count(), histogram.min(),
+            histogram.Percentile(50), histogram.Percentile(99), histogram.max());
+        json += item;
+        if (reset) {
+            histogram.Reset();
+        }
+    }
+    json += "}";
+    return json;
+}
+
+void LatencyTracer::Dump() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ESP_LOGI(TAG, "%-10s %8s %8s %8s %8s %8s (us)", "stage", "count", "min", "p50", "p99", "max");
+    for (int i = 0; i < kLatencyMetricCount; i++) {
+        auto& histogram = histograms_[i];
+        if (histogram.count() == 0) {
+            continue;
+        }
+        ESP_LOGI(TAG, "%-10s %8lu %8lu %8lu %8lu %8lu", kMetricNames[i], histogram.count(), histogram.min(),
+            histogram.Percentile(50), histogram.Percentile(99), histogram.max());
+    }
+}
+
+void LatencyTracer::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& histogram : histograms_) {
+        histogram.Reset();
+    }
+    last_uplink_sent_us_ = 0;
+    response_armed_ = false;
+}
+
+// 记录满时丢弃最旧的记录，读取端只会少统计几个样本，不会错位
+void LatencyTraceFifo::Push(size_t samples, const LatencyTrace& trace) {
+#if CONFIG_AUDIO_LATENCY_TRACE
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (count_ == kCapacity) {
+        head_ = (head_ + 1) % kCapacity;
+        count_--;
+    }
+    entries_[(head_ + count_) % kCapacity] = {write_position_, trace};
+    count_++;
+#endif
+    write_position_ += samples;
+}
+
+// 丢弃缓冲的样本（如播放缓冲区被清空）时调用，读写位置重新对齐
+void LatencyTraceFifo::Clear() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    head_ = 0;
+    count_ = 0;
+    write_position_ = 0;
+    read_position_ = 0;
+}
@@ -0,0 +1,141 @@
+#ifndef LATENCY_TRACER_H
+#define LATENCY_TRACER_H
+
+#include <sdkconfig.h>
+#include <esp_timer.h>
+
+#include <array>
+#include <mutex>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+// 帧级时延统计的指标：前 kLatencyStageCount 项是链路上的各个阶段，记录与上一个已打点阶段的间隔
+// 上行：采集 → 重采样 → 送入 AFE → 取出 AFE → 编码（含排队） → 发送
+// 下行：收包后在解码队列中的等待 → 解码（含重采样） → 在播放缓冲区中等待直到送入 I2S
+enum LatencyMetric {
+    kLatencyCapture,    // AudioCodec::InputData 的耗时（等待 I2S DMA）
+    kLatencyResample,
+    kLatencyAfeFeed,
+    kLatencyAfeFetch,   // 送入 AFE 到该帧首个样本被取出
+    kLatencyEncode,
+    kLatencySend,
+    kLatencyReceive,    // 收到数据包到开始解码
+    kLatencyDecode,
+    kLatencyOutput,     // 写入播放缓冲区到送入 I2S
+    kLatencyStageCount,
+    kLatencyUplink = kLatencyStageCount,  // 开始采集到 SendAudio 返回
+    kLatencyDownlink,                     // 收到数据包到送入 I2S
+    kLatencyResponse,                     // 最后一个上行包发出到首个 TTS 样本送入 I2S
+    kLatencyMetricCount,
+};
+
+// 随帧传递的时延记录：起点的单调时间戳，以及各阶段相对起点的偏移（微秒）
+struct LatencyTrace {
+    int64_t origin_us = 0;
+    uint32_t stage_us[kLatencyStageCount] = {};
+    uint16_t stamped = 0;  // 已打点阶段的位图
+
+    inline void Begin(int64_t origin_us = esp_timer_get_time()) {
+        this->origin_us = origin_us;
+        stamped = 0;
+    }
+    // 记录阶段时间戳，并把与上一个已打点阶段的间隔计入该阶段的直方图
+    void Stamp(LatencyMetric stage);
+    // 把起点到最后一个打点阶段的总时长计入 metric
+    void Finish(LatencyMetric metric);
+};
+
+// 对数分桶的时延直方图：每个 2 的幂区间再均分为 4 个桶，相对误差不超过 12.5%，覆盖 0 ~ 16 秒
+class LatencyHistogram {
+public:
+    static constexpr int kBucketCount = 4 + 23 * 4;
+
+    void Record(uint32_t us);
+    uint32_t Percentile(int percent) const;
+    void Reset();
+
+    inline uint32_t count() const { return count_; }
+    inline uint32_t min() const { return count_ > 0 ? min_ : 0; }
+    inline uint32_t max() const { return max_; }
+
+private:
+    uint32_t count_ = 0;
+    uint32_t min_ = UINT32_MAX;
+    uint32_t max_ = 0;
+    std::array<uint32_t, kBucketCount> buckets_ = {};
+
+    static int BucketIndex(uint32_t us);
+    static uint32_t BucketValue(int index);
+};
+
+// 全局时延统计，各任务打点时写入，可以通过协议查询或在控制台输出
+class LatencyTracer {
+public:
+    static LatencyTracer& GetInstance() {
+        static LatencyTracer instance;
+        return instance;
+    }
+
+    LatencyTracer(const LatencyTracer&) = delete;
+    LatencyTracer& operator=(const LatencyTracer&) = delete;
+
+    void Record(LatencyMetric metric, uint32_t us);
+    // 上行包发出时调用，记录“用户说完”的时间点
+    void MarkUplinkSent();
+    // 收到 tts start 时调用，下一次 MarkPlayback 记录一次响应时延
+    void ArmResponse();
+    // 下行样本送入 I2S 时调用
+    void MarkPlayback();
+
+    // 以 JSON 对象返回各指标的 count/min/p50/p99/max（微秒）
+    std::string GetJson(bool reset);
+    void Dump();
+    void Reset();
+
+    static const char* GetMetricName(LatencyMetric metric);
+
+private:
+    LatencyTracer() = default;
+
+    std::mutex mutex_;
+    std::array<LatencyHistogram, kLatencyMetricCount> histograms_;
+    int64_t last_uplink_sent_us_ = 0;
+    bool response_armed_ = false;
+};
+
+// 跨越缓冲环节（AFE、播放缓冲区）时按样本位置找回时延记录：
+// 写入端登记每段样本对应的记录，读取端取出一段样本时，对其中每个记录的首个样本回调一次
+class LatencyTraceFifo {
+public:
+    void Push(size_t samples, const LatencyTrace& trace);
+    template <typename Callback>
+    void Consume(size_t samples, Callback callback) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        uint64_t end = read_position_ + samples;
+        while (count_ > 0 && entries_[head_].start < end) {
+            callback(entries_[head_].trace);
+            head_ = (head_ + 1) % kCapacity;
+            count_--;
+        }
+        read_position_ = end;
+    }
+    void Clear();
+
+private:
+    static constexpr size_t kCapacity = 16;
+
+    struct Entry {
+        uint64_t start;
+        LatencyTrace trace;
+    };
+
+    std::mutex mutex_;
+    std::array<Entry, kCapacity> entries_;
+    size_t head_ = 0;
+    size_t count_ = 0;
+    uint64_t write_position_ = 0;
+    uint64_t read_position_ = 0;
+};
+
+#endif // LATENCY_TRACER_H
@@ -2,7 +2,6 @@
 #include <esp_err.h>       // ESP32 错误处理库
 #include <nvs.h>           // 非易失性存储 (NVS) 库
 #include <nvs_flash.h>     // NVS Flash 初始化库
-#include <driver/gpio.h>   // GPIO 驱动库
 #include <esp_event.h>     // ESP32 事件循环库
 
 #include "application.h"   // 应用程序头文件
@@ -0,0 +1,93 @@
+#include "opus_decoder_pool.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <opus.h>
+#include <algorithm>
+
+#define TAG "OpusDecoderPool"
+
+OpusDecoderPool::OpusDecoderPool(int output_sample_rate, size_t max_entries)
+    : output_sample_rate_(output_sample_rate), max_entries_(std::max<size_t>(max_entries, 1)) {
+    entries_.reserve(max_entries_);
+}
+
+// 估算一个条目占用的内存：Opus 解码器状态、包装对象以及重采样器（其状态内联在对象中）
+size_t OpusDecoderPool::EntrySize(const Entry& entry) {
+    size_t size = sizeof(Entry) + sizeof(OpusDecoderWrapper) + opus_decoder_get_size(1);
+    if (entry.resampler) {
+        size += sizeof(AudioResampler);
+    }
+    return size;
+}
+
+// 切换到指定采样率的解码器，命中时重置解码器与重采样器的状态，未命中时新建（必要时淘汰最久未使用的条目）
+OpusDecoderPool::Entry* OpusDecoderPool::Acquire(int sample_rate) {
+    if (current_ != nullptr && current_->sample_rate == sample_rate) {
+        current_->last_used = ++use_counter_;
+        return current_;
+    }
+
+    int64_t start_time = esp_timer_get_time();
+    auto it = std::find_if(entries_.begin(), entries_.end(), [sample_rate](const std::unique_ptr<Entry>& entry) {
+        return entry->sample_rate == sample_rate;
+    });
+
+    Entry* entry;
+    bool hit = it != entries_.end();
+    if (hit) {
+        entry = it->get();
+        entry->decoder->ResetState();
+        if (entry->resampler) {
+            // 重新配置只会重新初始化内联的滤波器状态，不分配内存
+            entry->resampler->Configure(sample_rate, output_sample_rate_, 1);
+        }
+        stats_.hits++;
+    } else {
+        if (entries_.size() >= max_entries_) {
+            // 淘汰最久未使用且不是当前正在使用的条目
+            auto victim = std::min_element(entries_.begin(), entries_.end(), [this](const std::unique_ptr<Entry>& a, const std::unique_ptr<Entry>& b) {
+                if (a.get() == current_) return false;
+                if (b.get() == current_) return true;
+                return a->last_used < b->last_used;
+            });
+            ESP_LOGI(TAG, "Evict decoder for %d Hz", (*victim)->sample_rate);
+            stats_.memory_bytes -= EntrySize(**victim);
+            entries_.erase(victim);
+            stats_.evictions++;
+        }
+
+        auto new_entry = std::make_unique<Entry>();
+        new_entry->sample_rate = sample_rate;
+        new_entry->decoder = std::make_unique<OpusDecoderWrapper>(sample_rate, 1);
+        if (sample_rate != output_sample_rate_) {
+            ESP_LOGI(TAG, "Resampling audio from %d to %d", sample_rate, output_sample_rate_);
+            new_entry->resampler = std::make_unique<AudioResampler>();
+            new_entry->resampler->Configure(sample_rate, output_sample_rate_, 1);
+        }
+        stats_.memory_bytes += EntrySize(*new_entry);
+        entry = new_entry.get();
+        entries_.push_back(std::move(new_entry));
+        stats_.misses++;
+    }
+
+    entry->last_used = ++use_counter_;
+    current_ = entry;
+
+    uint32_t elapsed = esp_timer_get_time() - start_time;
+    stats_.last_switch_us = elapsed;
+    if (hit) {
+        stats_.max_hit_us = std::max(stats_.max_hit_us, elapsed);
+    } else {
+        stats_.max_miss_us = std::max(stats_.max_miss_us, elapsed);
+    }
+    ESP_LOGI(TAG, "Switch decoder to %d Hz (%s) in %lu us, %zu entries, %zu bytes",
+        sample_rate, hit ? "reused" : "created", elapsed, entries_.size(), stats_.memory_bytes);
+    return entry;
+}
+
+OpusDecoderPool::Stats OpusDecoderPool::GetStats() const {
+    Stats stats = stats_;
+    stats.entries = entries_.size();
+    return stats;
+}
@@ -0,0 +1,51 @@
+#ifndef OPUS_DECODER_POOL_H
+#define OPUS_DECODER_POOL_H
+
+#include <opus_decoder.h>
+#include "audio_resampler.h"
+
+#include <memory>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+// 按采样率缓存的 Opus 解码器与输出重采样器
+// 系统提示音（16kHz）与服务端 TTS（如 24kHz）来回切换时复用已创建的解码器，只重置状态不重新分配内存
+// 超过 max_entries 时淘汰最久未使用的条目
+class OpusDecoderPool {
+public:
+    struct Entry {
+        int sample_rate;
+        std::unique_ptr<OpusDecoderWrapper> decoder;
+        std::unique_ptr<AudioResampler> resampler;  // 与输出采样率相同时为空
+        uint32_t last_used;
+    };
+
+    struct Stats {
+        uint32_t hits;            // 命中已有解码器的切换次数
+        uint32_t misses;          // 需要新建解码器的切换次数
+        uint32_t evictions;       // 淘汰的条目数
+        size_t entries;           // 当前缓存的条目数
+        size_t memory_bytes;      // 缓存条目占用的内存估计
+        uint32_t last_switch_us;  // 最近一次切换耗时
+        uint32_t max_hit_us;      // 命中时的最大切换耗时
+        uint32_t max_miss_us;     // 新建时的最大切换耗时
+    };
+
+    OpusDecoderPool(int output_sample_rate, size_t max_entries);
+
+    Entry* Acquire(int sample_rate);
+    Stats GetStats() const;
+
+private:
+    int output_sample_rate_;
+    size_t max_entries_;
+    std::vector<std::unique_ptr<Entry>> entries_;
+    Entry* current_ = nullptr;
+    uint32_t use_counter_ = 0;
+    Stats stats_ = {};
+
+    static size_t EntrySize(const Entry& entry);
+};
+
+#endif // OPUS_DECODER_POOL_H
@@ -0,0 +1,82 @@
+#include "opus_frame_encoder.h"
+
+#include <esp_log.h>
+#include <opus.h>
+#include <algorithm>
+#include <cstring>
+
+#define TAG "OpusFrameEncoder"
+
+OpusFrameEncoder::OpusFrameEncoder(int sample_rate, int channels, int duration_ms)
+    : channels_(channels), frame_samples_(sample_rate / 1000 * channels * duration_ms) {
+    int error;
+    encoder_ = opus_encoder_create(sample_rate, channels, OPUS_APPLICATION_VOIP, &error);
+    if (encoder_ == nullptr) {
+        ESP_LOGE(TAG, "Failed to create audio encoder, error code: %d", error);
+        return;
+    }
+    opus_encoder_ctl(encoder_, OPUS_SET_DTX(1));
+    opus_encoder_ctl(encoder_, OPUS_SET_COMPLEXITY(5));
+    pending_.reserve(frame_samples_);
+    packet_.resize(kMaxPacketSize);
+}
+
+OpusFrameEncoder::~OpusFrameEncoder() {
+    if (encoder_ != nullptr) {
+        opus_encoder_destroy(encoder_);
+    }
+}
+
+void OpusFrameEncoder::SetComplexity(int complexity) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (encoder_ != nullptr) {
+        opus_encoder_ctl(encoder_, OPUS_SET_COMPLEXITY(complexity));
+    }
+}
+
+void OpusFrameEncoder::ResetState() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (encoder_ != nullptr) {
+        opus_encoder_ctl(encoder_, OPUS_RESET_STATE);
+    }
+    pending_.clear();
+}
+
+// 先用输入补齐暂存的不完整包，之后的整包直接从输入编码，剩余的尾部暂存到下一次
+void OpusFrameEncoder::Encode(const int16_t* pcm, size_t samples, const std::function<void(const std::vector<uint8_t>& opus)>& handler) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (encoder_ == nullptr) {
+        return;
+    }
+    if (!pending_.empty()) {
+        size_t fill = std::min(frame_samples_ - pending_.size(), samples);
+        pending_.insert(pending_.end(), pcm, pcm + fill);
+        pcm += fill;
+        samples -= fill;
+        if (pending_.size() < frame_samples_) {
+            return;
+        }
+        EncodeFrame(pending_.data(), handler);
+        pending_.clear();
+    }
+    while (samples >= frame_samples_) {
+        EncodeFrame(pcm, handler);
+        pcm += frame_samples_;
+        samples -= frame_samples_;
+    }
+    pending_.insert(pending_.end(), pcm, pcm + samples);
+}
+
+// 必须持有 mutex_；数据包缓冲区只在容量内调整长度，不会重新分配
+void OpusFrameEncoder::EncodeFrame(const int16_t* pcm, const std::function<void(const std::vector<uint8_t>& opus)>& handler) {
+    packet_.resize(kMaxPacketSize);
+    int ret = opus_encode(encoder_, pcm, frame_samples_ / channels_, packet_.data(), packet_.size());
+    if (ret < 0) {
+        ESP_LOGE(TAG, "Failed to encode audio, error code: %d", ret);
+        return;
+    }
+    packet_.resize(ret);
+    if (handler) {
+        handler(packet_);
+    }
+}
@@ -0,0 +1,41 @@
+#ifndef OPUS_FRAME_ENCODER_H
+#define OPUS_FRAME_ENCODER_H
+
+#include <vector>
+#include <mutex>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+
+struct OpusEncoder;
+
+// 上行 Opus 编码器：输入按只读指针传入，不接管调用方（帧池）的缓冲区
+// 不足一包的样本暂存在构造时预留的缓冲区中，编码结果写入复用的数据包缓冲区，稳态下不分配内存
+// 编码参数与 OpusEncoderWrapper 一致：VOIP 模式，开启 DTX，默认复杂度 5
+class OpusFrameEncoder {
+public:
+    OpusFrameEncoder(int sample_rate, int channels, int duration_ms);
+    ~OpusFrameEncoder();
+    OpusFrameEncoder(const OpusFrameEncoder&) = delete;
+    OpusFrameEncoder& operator=(const OpusFrameEncoder&) = delete;
+
+    void SetComplexity(int complexity);
+    // 重置编码器状态并丢弃暂存的样本
+    void ResetState();
+    // 每凑满一包调用一次 handler，opus 只在回调期间有效
+    void Encode(const int16_t* pcm, size_t samples, const std::function<void(const std::vector<uint8_t>& opus)>& handler);
+
+private:
+    static constexpr size_t kMaxPacketSize = 1000;
+
+    std::mutex mutex_;
+    OpusEncoder* encoder_ = nullptr;
+    int channels_;
+    size_t frame_samples_;  // 每包的样本数（含所有通道）
+    std::vector<int16_t> pending_;
+    std::vector<uint8_t> packet_;
+
+    void EncodeFrame(const int16_t* pcm, const std::function<void(const std::vector<uint8_t>& opus)>& handler);
+};
+
+#endif // OPUS_FRAME_ENCODER_H
@@ -0,0 +1,188 @@
+#include "jitter_buffer.h"
+
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+
+#define TAG "JitterBuffer"
+
+// 构造函数，frame_duration_ms 为每个数据包的时长，min/max_depth_ms 限定目标深度的调整范围
+JitterBuffer::JitterBuffer(int frame_duration_ms, int min_depth_ms, int max_depth_ms)
+    : frame_duration_ms_(frame_duration_ms), min_depth_ms_(min_depth_ms), max_depth_ms_(max_depth_ms) {
+}
+
+// 设置按序输出数据包的回调函数，空数据包表示该帧丢失，需要执行丢包补偿
+void JitterBuffer::OnOutput(std::function<void(std::vector<uint8_t>&& packet)> callback) {
+    output_callback_ = callback;
+}
+
+// 重置缓冲区状态，在每次打开音频通道（序列号从头开始）时调用
+void JitterBuffer::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    for (auto& slot : slots_) {
+        slot.valid = false;
+    }
+    started_ = false;
+    playing_ = false;
+    buffered_ = 0;
+    concealed_run_ = 0;
+    waiting_since_ = 0;
+    jitter_q4_ = 0;
+    reorder_delay_q4_ = 0;
+    stats_ = {};
+}
+
+// 计算当前目标深度：取到达抖动的 3 倍与近期乱序延迟中的较大值
+int JitterBuffer::TargetDepthMs() const {
+    int target = std::max(jitter_q4_ * 3 / 16, reorder_delay_q4_ / 16);
+    return std::clamp(target, min_depth_ms_, max_depth_ms_);
+}
+
+// 按 RFC 3550 的方式更新到达间隔抖动，只统计比预期晚到的部分
+// 服务端通常以快于实时的速度下发 TTS，提前到达不应抬高目标深度
+// 句子之间、轮次之间的停顿沿用同一序列号空间，晚到的时长远超最大深度，按语段边界跳过该样本，
+// 否则每句话之后目标深度都会被推到最大值（这样长的网络停顿本来也无法靠缓冲吸收）
+void JitterBuffer::UpdateJitter(uint32_t sequence, int64_t now) {
+    int64_t arrival_delta = now - last_arrival_time_;
+    int64_t expected_delta = int64_t(sequence - highest_sequence_) * frame_duration_ms_;
+    int64_t lateness = std::max<int64_t>(arrival_delta - expected_delta, 0);
+    if (lateness <= max_depth_ms_) {
+        jitter_q4_ += (int32_t(lateness) * 16 - jitter_q4_) / 16;
+    }
+    last_arrival_time_ = now;
+    highest_sequence_ = sequence;
+}
+
+// 为收到的数据包找到槽位，过晚或重复的数据包返回 nullptr，必须持有 mutex_
+JitterBuffer::Slot* JitterBuffer::Acquire(uint32_t sequence, int64_t now) {
+    if (!started_) {
+        started_ = true;
+        next_sequence_ = sequence;
+        highest_sequence_ = sequence;
+        start_time_ = now;
+        last_arrival_time_ = now;
+    } else if (int32_t(sequence - next_sequence_) < 0) {
+        // 该帧已经被补偿或跳过，来得太晚
+        stats_.late++;
+        return nullptr;
+    }
+
+    if (int32_t(sequence - next_sequence_) >= kSlotCount) {
+        // 序列号跳跃超出缓冲范围，按序输出已缓存的数据包后从新序列号重新开始
+        ESP_LOGW(TAG, "Sequence jumped from %lu to %lu, resync", next_sequence_, sequence);
+        uint32_t emitted = 0;
+        for (int i = 0; i < kSlotCount && buffered_ > 0; i++) {
+            auto& slot = slots_[(next_sequence_ + i) % kSlotCount];
+            if (slot.valid && slot.sequence == next_sequence_ + i) {
+                Emit(slot);
+                emitted++;
+            }
+        }
+        stats_.skipped += sequence - next_sequence_ - emitted;
+        next_sequence_ = sequence;
+        waiting_since_ = 0;
+        concealed_run_ = 0;
+    }
+
+    auto& slot = slots_[sequence % kSlotCount];
+    if (slot.valid && slot.sequence == sequence) {
+        stats_.duplicated++;
+        return nullptr;
+    }
+    return &slot;
+}
+
+// 数据写入槽位后登记并按序输出，必须持有 mutex_
+void JitterBuffer::Commit(Slot& slot, uint32_t sequence, int64_t now) {
+    stats_.received++;
+    reorder_delay_q4_ -= reorder_delay_q4_ / 64;  // 乱序延迟估计随时间衰减
+    if (int32_t(sequence - highest_sequence_) > 0) {
+        UpdateJitter(sequence, now);
+    } else if (sequence != highest_sequence_) {
+        // 比已收到的最大序列号小，说明是乱序到达的数据包，记录它让空缺等待了多久
+        stats_.reordered++;
+        if (waiting_since_ != 0) {
+            reorder_delay_q4_ = std::max<int32_t>(reorder_delay_q4_, (now - waiting_since_) * 16);
+        }
+    }
+
+    slot.valid = true;
+    slot.sequence = sequence;
+    buffered_++;
+    Drain(now);
+}
+
+// 由定时器周期性调用，在没有新数据包到达时也能让超时的空缺得到补偿
+void JitterBuffer::Poll() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (started_) {
+        Drain(esp_timer_get_time() / 1000);
+    }
+}
+
+// 按序输出可以播放的数据包，必须持有 mutex_
+void JitterBuffer::Drain(int64_t now) {
+    int target_ms = TargetDepthMs();
+    if (!playing_) {
+        // 首个数据包到达后先积累目标深度，再开始输出
+        if (buffered_ * frame_duration_ms_ < target_ms && now - start_time_ < target_ms) {
+            return;
+        }
+        playing_ = true;
+    }
+
+    while (buffered_ > 0) {
+        auto& slot = slots_[next_sequence_ % kSlotCount];
+        if (slot.valid && slot.sequence == next_sequence_) {
+            Emit(slot);
+            next_sequence_++;
+            waiting_since_ = 0;
+            concealed_run_ = 0;
+            continue;
+        }
+
+        // 后面还有数据包，说明当前帧缺失，等待它最多 target_ms
+        if (waiting_since_ == 0) {
+            waiting_since_ = now;
+        }
+        if (now - waiting_since_ < target_ms) {
+            break;
+        }
+        // 等待超时：少量连续丢失用 PLC 补偿，连续丢失过多则直接跳过，避免输出长时间的伪造音频
+        // waiting_since_ 保持不变，后续同样缺失的帧会立即按超时处理
+        if (concealed_run_ < kMaxConcealedFrames) {
+            EmitLoss();
+            concealed_run_++;
+            stats_.concealed++;
+        } else {
+            stats_.skipped++;
+        }
+        next_sequence_++;
+    }
+}
+
+// 输出一个数据包，必须持有 mutex_
+void JitterBuffer::Emit(Slot& slot) {
+    slot.valid = false;
+    buffered_--;
+    // 回调只读取数据、不取走时，clear 后槽位缓冲区的容量保留给之后的数据包
+    if (output_callback_) {
+        output_callback_(std::move(slot.data));
+    }
+    slot.data.clear();
+}
+
+// 输出一个空数据包表示丢帧，必须持有 mutex_
+void JitterBuffer::EmitLoss() {
+    if (output_callback_) {
+        output_callback_(std::vector<uint8_t>());
+    }
+}
+
+JitterBuffer::Stats JitterBuffer::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats = stats_;
+    stats.jitter_ms = jitter_q4_ / 16;
+    stats.target_ms = TargetDepthMs();
+    return stats;
+}
@@ -0,0 +1,94 @@
+#ifndef JITTER_BUFFER_H
+#define JITTER_BUFFER_H
+
+#include <vector>
+#include <array>
+#include <mutex>
+#include <cstdint>
+#include <functional>
+#include <esp_timer.h>
+
+// 下行音频播放抖动缓冲区，按 UDP 包头中的序列号重排乱序到达的数据包
+// 缺失的帧在等待超过目标深度后以空数据包输出，由解码端执行 Opus 丢包补偿（PLC）
+// 目标深度根据到达间隔抖动（RFC 3550 估计）和实测的乱序延迟自适应调整
+class JitterBuffer {
+public:
+    struct Stats {
+        uint32_t received;    // 收到的数据包数
+        uint32_t reordered;   // 乱序到达但仍及时填补空缺的数据包数
+        uint32_t late;        // 到达过晚被丢弃的数据包数
+        uint32_t duplicated;  // 重复的数据包数
+        uint32_t concealed;   // 以 PLC 补偿的帧数
+        uint32_t skipped;     // 连续丢失过多、直接跳过的帧数
+        int jitter_ms;        // 当前到达间隔抖动估计
+        int target_ms;        // 当前目标深度
+    };
+
+    JitterBuffer(int frame_duration_ms, int min_depth_ms, int max_depth_ms);
+
+    void OnOutput(std::function<void(std::vector<uint8_t>&& packet)> callback);
+    void Reset();
+    // 放入一个收到的数据包：fill(uint8_t* data) 把 size 字节直接写入槽位自带的缓冲区（如原地解密），
+    // 槽位缓冲区在各包之间复用，输出回调不取走数据时稳定后不再分配内存
+    template <typename Fill>
+    void Put(uint32_t sequence, size_t size, Fill&& fill) {
+        std::lock_guard<std::mutex> lock(mutex_);
+        int64_t now = esp_timer_get_time() / 1000;
+        Slot* slot = Acquire(sequence, now);
+        if (slot == nullptr) {
+            return;
+        }
+        slot->data.resize(size);
+        if (!fill(slot->data.data())) {
+            slot->data.clear();
+            return;
+        }
+        Commit(*slot, sequence, now);
+    }
+    void Poll();
+    Stats GetStats();
+
+private:
+    static constexpr int kSlotCount = 32;           // 最多缓存的帧数
+    static constexpr int kMaxConcealedFrames = 5;   // 连续补偿的最大帧数，超过后直接跳过
+
+    struct Slot {
+        bool valid = false;
+        uint32_t sequence = 0;
+        std::vector<uint8_t> data;
+    };
+
+    std::mutex mutex_;
+    std::array<Slot, kSlotCount> slots_;
+    std::function<void(std::vector<uint8_t>&& packet)> output_callback_;
+
+    int frame_duration_ms_;
+    int min_depth_ms_;
+    int max_depth_ms_;
+
+    bool started_ = false;
+    bool playing_ = false;
+    uint32_t next_sequence_ = 0;
+    uint32_t highest_sequence_ = 0;
+    int buffered_ = 0;
+    int concealed_run_ = 0;
+    int64_t start_time_ = 0;
+    int64_t waiting_since_ = 0;
+    int64_t last_arrival_time_ = 0;
+
+    // 抖动与乱序延迟估计，单位为 1/16 毫秒
+    int32_t jitter_q4_ = 0;
+    int32_t reorder_delay_q4_ = 0;
+
+    Stats stats_ = {};
+
+    Slot* Acquire(uint32_t sequence, int64_t now);
+    void Commit(Slot& slot, uint32_t sequence, int64_t now);
+    int TargetDepthMs() const;
+    void UpdateJitter(uint32_t sequence, int64_t now);
+    void Drain(int64_t now);
+    void Emit(Slot& slot);
+    void EmitLoss();
+};
+
+#endif // JITTER_BUFFER_H
@@ -0,0 +1,306 @@
+#include "json_scanner.h"
+
+#include <esp_log.h>
+#include <cstring>
+
+#define TAG "JsonScanner"
+
+namespace {
+
+const JsonValue kMissingValue;
+
+class Cursor {
+public:
+    explicit Cursor(std::string_view text) : p_(text.data()), end_(text.data() + text.size()) {}
+
+    void SkipSpace() {
+        while (p_ < end_ && (*p_ == ' ' || *p_ == '\t' || *p_ == '\n' || *p_ == '\r')) {
+            p_++;
+        }
+    }
+
+    bool Consume(char c) {
+        SkipSpace();
+        if (p_ < end_ && *p_ == c) {
+            p_++;
+            return true;
+        }
+        return false;
+    }
+
+    bool AtEnd() {
+        SkipSpace();
+        return p_ == end_;
+    }
+
+    // p_ 指向开头的引号，结束后指向结尾引号之后
+    bool ScanString(std::string_view& out, bool& escaped) {
+        const char* start = ++p_;
+        while (p_ < end_) {
+            char c = *p_;
+            if (c == '"') {
+                out = std::string_view(start, p_ - start);
+                p_++;
+                return true;
+            }
+            if (c == '\\') {
+                escaped = true;
+                p_ += 2;
+                continue;
+            }
+            if ((uint8_t)c < 0x20) {
+                return false;
+            }
+            p_++;
+        }
+        return false;
+    }
+
+    // 跳过整个嵌套的对象或数组，只匹配括号层数，不校验内部结构
+    bool SkipComposite() {
+        int depth = 0;
+        while (p_ < end_) {
+            char c = *p_;
+            if (c == '"') {
+                std::string_view unused;
+                bool escaped = false;
+                if (!ScanString(unused, escaped)) {
+                    return false;
+                }
+                continue;
+            }
+            if (c == '{' || c == '[') {
+                depth++;
+            } else if (c == '}' || c == ']') {
+                if (--depth == 0) {
+                    p_++;
+                    return true;
+                }
+            }
+            p_++;
+        }
+        return false;
+    }
+
+    bool ScanLiteral(std::string_view literal) {
+        if ((size_t)(end_ - p_) < literal.size() || std::string_view(p_, literal.size()) != literal) {
+            return false;
+        }
+        p_ += literal.size();
+        return true;
+    }
+
+    bool ScanValue(JsonValue& value) {
+        SkipSpace();
+        if (p_ == end_) {
+            return false;
+        }
+        const char* start = p_;
+        switch (*p_) {
+        case '"':
+            value.type = JsonValue::kString;
+            return ScanString(value.raw, value.escaped);
+        case '{':
+        case '[':
+            value.type = *p_ == '{' ? JsonValue::kObject : JsonValue::kArray;
+            if (!SkipComposite()) {
+                return false;
+            }
+            break;
+        case 't':
+        case 'f':
+            value.type = JsonValue::kBool;
+            if (!ScanLiteral(*p_ == 't' ? "true" : "false")) {
+                return false;
+            }
+            break;
+        case 'n':
+            value.type = JsonValue::kNull;
+            if (!ScanLiteral("null")) {
+                return false;
+            }
+            break;
+        default:
+            if (*p_ != '-' && (*p_ < '0' || *p_ > '9')) {
+                return false;
+            }
+            value.type = JsonValue::kNumber;
+            while (p_ < end_ && (strchr("0123456789+-.eE", *p_) != nullptr)) {
+                p_++;
+            }
+            break;
+        }
+        value.raw = std::string_view(start, p_ - start);
+        return true;
+    }
+
+    bool Peek(char c) {
+        SkipSpace();
+        return p_ < end_ && *p_ == c;
+    }
+
+private:
+    const char* p_;
+    const char* end_;
+};
+
+inline int HexValue(char c) {
+    if (c >= '0' && c <= '9') return c - '0';
+    if (c >= 'A' && c <= 'F') return c - 'A' + 10;
+    if (c >= 'a' && c <= 'f') return c - 'a' + 10;
+    return -1;
+}
+
+bool ReadHex4(std::string_view s, size_t pos, uint32_t& out) {
+    if (pos + 4 > s.size()) {
+        return false;
+    }
+    out = 0;
+    for (size_t i = pos; i < pos + 4; i++) {
+        int v = HexValue(s[i]);
+        if (v < 0) {
+            return false;
+        }
+        out = (out << 4) | v;
+    }
+    return true;
+}
+
+void AppendUtf8(std::string& out, uint32_t cp) {
+    if (cp < 0x80) {
+        out += (char)cp;
+    } else if (cp < 0x800) {
+        out += (char)(0xC0 | (cp >> 6));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else if (cp < 0x10000) {
+        out += (char)(0xE0 | (cp >> 12));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    } else {
+        out += (char)(0xF0 | (cp >> 18));
+        out += (char)(0x80 | ((cp >> 12) & 0x3F));
+        out += (char)(0x80 | ((cp >> 6) & 0x3F));
+        out += (char)(0x80 | (cp & 0x3F));
+    }
+}
+
+} // namespace
+
+int JsonValue::ToInt(int fallback) const {
+    if (type != kNumber) {
+        return fallback;
+    }
+    size_t i = 0;
+    bool negative = raw[0] == '-';
+    if (negative) {
+        i++;
+    }
+    int64_t value = 0;
+    for (; i < raw.size() && raw[i] >= '0' && raw[i] <= '9'; i++) {
+        value = value * 10 + (raw[i] - '0');
+        if (value > INT32_MAX) {
+            return fallback;
+        }
+    }
+    return negative ? -(int)value : (int)value;
+}
+
+std::string JsonValue::ToString() const {
+    if (type != kString) {
+        return std::string();
+    }
+    if (!escaped) {
+        return std::string(raw);
+    }
+    std::string out;
+    out.reserve(raw.size());
+    for (size_t i = 0; i < raw.size(); i++) {
+        char c = raw[i];
+        if (c != '\\' || i + 1 >= raw.size()) {
+            out += c;
+            continue;
+        }
+        c = raw[++i];
+        switch (c) {
+        case 'b': out += '\b'; break;
+        case 'f': out += '\f'; break;
+        case 'n': out += '\n'; break;
+        case 'r': out += '\r'; break;
+        case 't': out += '\t'; break;
+        case 'u': {
+            uint32_t cp;
+            if (!ReadHex4(raw, i + 1, cp)) {
+                out += '?';
+                break;
+            }
+            i += 4;
+            // UTF-16 代理对，中文以外的表情符号等字符会用到
+            uint32_t low;
+            if (cp >= 0xD800 && cp < 0xDC00 && i + 2 < raw.size() && raw[i + 1] == '\\' && raw[i + 2] == 'u'
+                && ReadHex4(raw, i + 3, low) && low >= 0xDC00 && low < 0xE000) {
+                cp = 0x10000 + ((cp - 0xD800) << 10) + (low - 0xDC00);
+                i += 6;
+            } else if (cp >= 0xD800 && cp < 0xE000) {
+                cp = 0xFFFD;
+            }
+            AppendUtf8(out, cp);
+            break;
+        }
+        default:  // \" \\ \/
+            out += c;
+            break;
+        }
+    }
+    return out;
+}
+
+bool JsonObject::Parse(std::string_view text) {
+    count_ = 0;
+    text_ = text;
+    Cursor cursor(text);
+    if (!cursor.Consume('{')) {
+        return false;
+    }
+    if (cursor.Consume('}')) {
+        return cursor.AtEnd();
+    }
+    size_t dropped = 0;
+    while (true) {
+        if (!cursor.Peek('"')) {
+            return false;
+        }
+        Member member;
+        bool key_escaped = false;
+        if (!cursor.ScanString(member.key, key_escaped) || !cursor.Consume(':') || !cursor.ScanValue(member.value)) {
+            return false;
+        }
+        // 超出上限的成员继续扫描以校验格式，但不保存，消息本身仍然有效
+        if (count_ < kMaxMembers) {
+            members_[count_++] = member;
+        } else {
+            dropped++;
+        }
+        if (cursor.Consume(',')) {
+            continue;
+        }
+        if (cursor.Consume('}')) {
+            if (!cursor.AtEnd()) {
+                return false;
+            }
+            if (dropped > 0) {
+                ESP_LOGW(TAG, "Dropped %u members beyond the first %u", (unsigned)dropped, (unsigned)kMaxMembers);
+            }
+            return true;
+        }
+        return false;
+    }
+}
+
+const JsonValue& JsonObject::operator[](std::string_view key) const {
+    for (size_t i = 0; i < count_; i++) {
+        if (members_[i].key == key) {
+            return members_[i].value;
+        }
+    }
+    return kMissingValue;
+}
@@ -0,0 +1,68 @@
+#ifndef JSON_SCANNER_H
+#define JSON_SCANNER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// 不分配内存的 JSON 扫描器：只扫描对象的顶层成员，记录每个成员值在原始文本中的位置
+// 嵌套的对象和数组整体作为一个值，需要时再对其原始文本调用一次 JsonObject::Parse
+// 所有视图都指向传入的原始文本，原始文本必须在使用期间保持有效
+struct JsonValue {
+    enum Type : uint8_t {
+        kMissing,
+        kString,
+        kNumber,
+        kBool,
+        kNull,
+        kObject,
+        kArray,
+    };
+
+    Type type = kMissing;
+    bool escaped = false;  // 字符串中含有转义序列，raw 不能直接当作字符串内容使用
+    std::string_view raw;  // 字符串为引号内的原始内容（未反转义），其他类型为值本身的文本
+
+    bool IsString() const { return type == kString; }
+    bool IsNumber() const { return type == kNumber; }
+    bool IsObject() const { return type == kObject; }
+    bool IsArray() const { return type == kArray; }
+    bool IsTrue() const { return type == kBool && raw == "true"; }
+
+    // 与不含转义字符的常量比较，消息类型、状态等字段都用这个
+    bool Equals(std::string_view value) const {
+        return type == kString && !escaped && raw == value;
+    }
+    // 字符串内容的视图，含转义时返回原始文本，仅适合打日志
+    std::string_view view() const { return type == kString ? raw : std::string_view(); }
+    // 数字的整数部分，不是数字时返回 fallback
+    int ToInt(int fallback = 0) const;
+    // 反转义后的字符串（\uXXXX 转为 UTF-8），不是字符串时返回空串
+    std::string ToString() const;
+};
+
+class JsonObject {
+public:
+    static constexpr size_t kMaxMembers = 12;
+
+    // 扫描一个 JSON 对象的顶层成员，格式错误时返回 false
+    // 只保存前 kMaxMembers 个成员，其余成员照常校验格式后丢弃，并输出一条带丢弃个数的警告
+    bool Parse(std::string_view text);
+    // 按键名查找顶层成员，不存在时返回 type 为 kMissing 的值
+    const JsonValue& operator[](std::string_view key) const;
+    std::string_view text() const { return text_; }
+    size_t size() const { return count_; }
+
+private:
+    struct Member {
+        std::string_view key;
+        JsonValue value;
+    };
+
+    std::string_view text_;
+    Member members_[kMaxMembers];
+    size_t count_ = 0;
+};
+
+#endif // JSON_SCANNER_H
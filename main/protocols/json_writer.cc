@@ -0,0 +1,85 @@
+#include "json_writer.h"
+
+#include <cstdio>
+
+JsonWriter::JsonWriter(std::string& buffer) : buffer_(buffer) {
+    buffer_.clear();
+    if (buffer_.capacity() < kInitialCapacity) {
+        buffer_.reserve(kInitialCapacity);
+    }
+    BeginObject();
+}
+
+void JsonWriter::Separator() {
+    uint32_t bit = 1u << depth_;
+    if (has_member_ & bit) {
+        buffer_ += ',';
+    }
+    has_member_ |= bit;
+}
+
+// 转义引号、反斜杠与控制字符，其余字节（包括 UTF-8 多字节序列）原样写入
+JsonWriter& JsonWriter::String(std::string_view value) {
+    buffer_ += '"';
+    size_t plain = 0;
+    for (size_t i = 0; i < value.size(); i++) {
+        uint8_t c = value[i];
+        if (c >= 0x20 && c != '"' && c != '\\') {
+            continue;
+        }
+        buffer_.append(value.data() + plain, i - plain);
+        plain = i + 1;
+        switch (c) {
+        case '"': buffer_ += "\\\""; break;
+        case '\\': buffer_ += "\\\\"; break;
+        case '\n': buffer_ += "\\n"; break;
+        case '\r': buffer_ += "\\r"; break;
+        case '\t': buffer_ += "\\t"; break;
+        case '\b': buffer_ += "\\b"; break;
+        case '\f': buffer_ += "\\f"; break;
+        default: {
+            char escaped[7];
+            snprintf(escaped, sizeof(escaped), "\\u%04x", c);
+            buffer_.append(escaped, 6);
+            break;
+        }
+        }
+    }
+    buffer_.append(value.data() + plain, value.size() - plain);
+    buffer_ += '"';
+    return *this;
+}
+
+JsonWriter& JsonWriter::Int(int64_t value) {
+    char digits[24];
+    int length = snprintf(digits, sizeof(digits), "%lld", (long long)value);
+    buffer_.append(digits, length);
+    return *this;
+}
+
+JsonWriter& JsonWriter::Bool(bool value) {
+    buffer_ += value ? "true" : "false";
+    return *this;
+}
+
+JsonWriter& JsonWriter::Raw(std::string_view json) {
+    buffer_.append(json.data(), json.size());
+    return *this;
+}
+
+JsonWriter& JsonWriter::BeginObject() {
+    if (depth_ + 1 < kMaxDepth) {
+        depth_++;
+    }
+    has_member_ &= ~(1u << depth_);
+    buffer_ += '{';
+    return *this;
+}
+
+JsonWriter& JsonWriter::EndObject() {
+    buffer_ += '}';
+    if (depth_ > 0) {
+        depth_--;
+    }
+    return *this;
+}
@@ -0,0 +1,54 @@
+#ifndef JSON_WRITER_H
+#define JSON_WRITER_H
+
+#include <string>
+#include <string_view>
+#include <cstdint>
+#include <cstddef>
+
+// 直接写入调用方提供的缓冲区的 JSON 生成器，缓冲区复用时容量保留，稳定后生成消息不再分配内存
+// 字段名只接受字符串字面量（长度在编译期确定，不做转义），字符串值统一转义
+//
+//     JsonWriter writer(buffer);
+//     writer.Key("type").String("listen");
+//     writer.Key("audio_params").BeginObject();
+//     writer.Key("sample_rate").Int(16000);
+//     writer.EndObject();
+//     writer.EndObject();  // 与构造时写入的根对象对应
+class JsonWriter {
+public:
+    static constexpr size_t kInitialCapacity = 256;
+    static constexpr int kMaxDepth = 8;
+
+    // 清空缓冲区并开始根对象
+    explicit JsonWriter(std::string& buffer);
+
+    template <size_t N>
+    JsonWriter& Key(const char (&name)[N]) {
+        static_assert(N > 1, "empty JSON key");
+        Separator();
+        buffer_ += '"';
+        buffer_.append(name, N - 1);
+        buffer_ += "\":";
+        return *this;
+    }
+
+    JsonWriter& String(std::string_view value);
+    JsonWriter& Int(int64_t value);
+    JsonWriter& Bool(bool value);
+    // 原样写入已经是合法 JSON 的值，例如 IoT 描述符与时延统计
+    JsonWriter& Raw(std::string_view json);
+    JsonWriter& BeginObject();
+    JsonWriter& EndObject();
+
+    const std::string& str() const { return buffer_; }
+
+private:
+    std::string& buffer_;
+    uint32_t has_member_ = 0;  // 每层嵌套一位，该层已经写过成员时置位，下一个成员前需要逗号
+    int depth_ = 0;
+
+    void Separator();
+};
+
+#endif // JSON_WRITER_H
@@ -0,0 +1,156 @@
+#include "loopback_protocol.h"
+#include "application.h"
+
+#include <cstring>
+#include <esp_log.h>
+#include <esp_timer.h>
+
+#define TAG "Loopback"
+
+// 上行静默超过该时长视为一轮说话结束
+#define LOOPBACK_IDLE_MS 800
+// 轮询上行状态的间隔
+#define LOOPBACK_POLL_MS 20
+
+LoopbackProtocol::LoopbackProtocol() {
+    xTaskCreate([](void* arg) {
+        LoopbackProtocol* protocol = (LoopbackProtocol*)arg;
+        protocol->TaskLoop();
+    }, "loopback", 4096, this, 4, &task_handle_);
+}
+
+LoopbackProtocol::~LoopbackProtocol() {
+    if (task_handle_ != nullptr) {
+        vTaskDelete(task_handle_);
+    }
+}
+
+void LoopbackProtocol::Start() {
+}
+
+bool LoopbackProtocol::OpenAudioChannel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        session_id_ = "loopback";
+        server_sample_rate_ = 16000;
+        opened_ = true;
+        error_occurred_ = false;
+        last_incoming_time_ = std::chrono::steady_clock::now();
+    }
+    if (on_audio_channel_opened_ != nullptr) {
+        on_audio_channel_opened_();
+    }
+    return true;
+}
+
+void LoopbackProtocol::CloseAudioChannel() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        opened_ = false;
+        listening_ = false;
+        abort_ = true;
+        packets_.clear();
+    }
+    if (on_audio_channel_closed_ != nullptr) {
+        on_audio_channel_closed_();
+    }
+}
+
+bool LoopbackProtocol::IsAudioChannelOpened() const {
+    return opened_;
+}
+
+void LoopbackProtocol::SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!listening_ || replaying_) {
+        return;
+    }
+    packets_.push_back(data);
+    last_packet_time_ = esp_timer_get_time();
+}
+
+// 只处理影响回环的 listen/abort 消息，其余消息忽略
+void LoopbackProtocol::SendText(const std::string& text) {
+    JsonObject root;
+    if (!root.Parse(text)) {
+        return;
+    }
+    auto& type = root["type"];
+    auto& state = root["state"];
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (type.Equals("listen")) {
+        if (state.Equals("start")) {
+            listening_ = true;
+            packets_.clear();
+            last_packet_time_ = esp_timer_get_time();
+        } else if (state.Equals("stop")) {
+            listening_ = false;
+        }
+    } else if (type.Equals("abort")) {
+        abort_ = true;
+    }
+}
+
+void LoopbackProtocol::SendJson(const char* type, const char* state, const char* text) {
+    std::string json;
+    JsonWriter writer(json);
+    writer.Key("type").String(type);
+    writer.Key("state").String(state);
+    if (text != nullptr) {
+        writer.Key("text").String(text);
+    }
+    writer.EndObject();
+    // 与服务端下发的消息走同一条扫描分发路径
+    DispatchIncomingJson(json);
+}
+
+// 按数据包时长的节拍下发，与服务端推流的节奏一致
+void LoopbackProtocol::Replay(std::vector<std::vector<uint8_t>>& packets) {
+    ESP_LOGI(TAG, "Replaying %zu packets", packets.size());
+    SendJson("tts", "start");
+    SendJson("tts", "sentence_start", "loopback");
+    int64_t start_time = esp_timer_get_time();
+    for (size_t i = 0; i < packets.size(); i++) {
+        if (abort_) {
+            ESP_LOGI(TAG, "Replay aborted at packet %zu", i);
+            break;
+        }
+        int64_t wait_us = start_time + (int64_t)i * OPUS_FRAME_DURATION_MS * 1000 - esp_timer_get_time();
+        if (wait_us > 0) {
+            vTaskDelay(pdMS_TO_TICKS((wait_us + 999) / 1000));
+        }
+        last_incoming_time_ = std::chrono::steady_clock::now();
+        if (on_incoming_audio_ != nullptr) {
+            on_incoming_audio_(std::move(packets[i]));
+        }
+    }
+    SendJson("tts", "stop");
+}
+
+void LoopbackProtocol::TaskLoop() {
+    std::vector<std::vector<uint8_t>> turn;
+    while (true) {
+        vTaskDelay(pdMS_TO_TICKS(LOOPBACK_POLL_MS));
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!opened_ || packets_.empty()) {
+                continue;
+            }
+            int64_t idle_ms = (esp_timer_get_time() - last_packet_time_) / 1000;
+            int turn_ms = packets_.size() * OPUS_FRAME_DURATION_MS;
+            if (listening_ && idle_ms < LOOPBACK_IDLE_MS && turn_ms < CONFIG_LOOPBACK_MAX_TURN_MS) {
+                continue;
+            }
+            turn.swap(packets_);
+            packets_.clear();
+            replaying_ = true;
+            abort_ = false;
+        }
+
+        Replay(turn);
+        turn.clear();
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        replaying_ = false;
+    }
+}
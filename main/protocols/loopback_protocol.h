@@ -0,0 +1,41 @@
+#ifndef _LOOPBACK_PROTOCOL_H_
+#define _LOOPBACK_PROTOCOL_H_
+
+#include "protocol.h"
+
+#include <freertos/FreeRTOS.h>
+#include <freertos/task.h>
+#include <mutex>
+#include <vector>
+
+// 本地回环协议，不需要服务器：把一轮监听期间上行的 Opus 数据包作为 TTS 原样下发
+// 一轮结束的条件与服务端 VAD 类似：收到 listen stop、上行静默超过 LOOPBACK_IDLE_MS 或累计时长达到上限
+// 配合 WavFileAudioCodec 可以离线回放录音，完整走一遍 InputAudio/OutputAudio 链路
+class LoopbackProtocol : public Protocol {
+public:
+    LoopbackProtocol();
+    ~LoopbackProtocol();
+
+    void Start() override;
+    void SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) override;
+    bool OpenAudioChannel() override;
+    void CloseAudioChannel() override;
+    bool IsAudioChannelOpened() const override;
+
+private:
+    std::mutex mutex_;
+    bool opened_ = false;
+    bool listening_ = false;
+    bool replaying_ = false;
+    bool abort_ = false;
+    int64_t last_packet_time_ = 0;
+    std::vector<std::vector<uint8_t>> packets_;
+    TaskHandle_t task_handle_ = nullptr;
+
+    void TaskLoop();
+    void Replay(std::vector<std::vector<uint8_t>>& packets);
+    void SendJson(const char* type, const char* state, const char* text = nullptr);
+    void SendText(const std::string& text) override;
+};
+
+#endif // _LOOPBACK_PROTOCOL_H_
@@ -13,13 +13,38 @@
 #define TAG "MQTT"  // 定义日志标签
 
 // MqttProtocol 构造函数
-MqttProtocol::MqttProtocol() {
+MqttProtocol::MqttProtocol()
+    : jitter_buffer_(OPUS_FRAME_DURATION_MS, CONFIG_JITTER_BUFFER_MIN_DEPTH_MS, CONFIG_JITTER_BUFFER_MAX_DEPTH_MS) {
     event_group_handle_ = xEventGroupCreate();  // 创建一个事件组，用于任务间同步
+
+    // 抖动缓冲区按序输出的数据包交给上层解码，空数据包表示需要丢包补偿
+    jitter_buffer_.OnOutput([this](std::vector<uint8_t>&& packet) {
+        if (on_incoming_audio_ != nullptr) {
+            on_incoming_audio_(std::move(packet));
+        }
+    });
+
+    // 创建抖动缓冲区的轮询定时器，在没有新数据包到达时也能及时补偿丢失的帧
+    esp_timer_create_args_t jitter_timer_args = {
+        .callback = [](void* arg) {
+            auto protocol = (MqttProtocol*)arg;
+            protocol->jitter_buffer_.Poll();
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "jitter_buffer",
+        .skip_unhandled_events = true,
+    };
+    esp_timer_create(&jitter_timer_args, &jitter_timer_);
 }
 
 // MqttProtocol 析构函数
 MqttProtocol::~MqttProtocol() {
     ESP_LOGI(TAG, "MqttProtocol deinit");  // 记录日志，表示 MqttProtocol 正在销毁
+    if (jitter_timer_ != nullptr) {
+        esp_timer_stop(jitter_timer_);  // 停止抖动缓冲区定时器
+        esp_timer_delete(jitter_timer_);
+    }
     if (udp_ != nullptr) {
         delete udp_;  // 删除 UDP 对象
     }
@@ -67,34 +92,7 @@ bool MqttProtocol::StartMqttClient(bool report_error) {
 
     // 设置 MQTT 消息到达时的回调函数
     mqtt_->OnMessage([this](const std::string& topic, const std::string& payload) {
-        cJSON* root = cJSON_Parse(payload.c_str());  // 解析 JSON 格式的消息
-        if (root == nullptr) {
-            ESP_LOGE(TAG, "Failed to parse json message %s", payload.c_str());  // 如果解析失败，记录错误日志
-            return;
-        }
-        cJSON* type = cJSON_GetObjectItem(root, "type");  // 获取消息类型
-        if (type == nullptr) {
-            ESP_LOGE(TAG, "Message type is not specified");  // 如果消息类型未指定，记录错误日志
-            cJSON_Delete(root);  // 删除 JSON 对象
-            return;
-        }
-
-        // 根据消息类型处理不同的消息
-        if (strcmp(type->valuestring, "hello") == 0) {
-            ParseServerHello(root);  // 处理服务器 hello 消息
-        } else if (strcmp(type->valuestring, "goodbye") == 0) {
-            auto session_id = cJSON_GetObjectItem(root, "session_id");  // 获取会话 ID
-            ESP_LOGI(TAG, "Received goodbye message, session_id: %s", session_id ? session_id->valuestring : "null");  // 记录 goodbye 消息日志
-            if (session_id == nullptr || session_id_ == session_id->valuestring) {
-                Application::GetInstance().Schedule([this]() {
-                    CloseAudioChannel();  // 关闭音频通道
-                });
-            }
-        } else if (on_incoming_json_ != nullptr) {
-            on_incoming_json_(root);  // 调用自定义的 JSON 消息处理函数
-        }
-        cJSON_Delete(root);  // 删除 JSON 对象
-        last_incoming_time_ = std::chrono::steady_clock::now();  // 更新最后接收消息的时间
+        DispatchIncomingJson(payload);  // 扫描 JSON 消息并按类型分发
     });
 
     ESP_LOGI(TAG, "Connecting to endpoint %s", endpoint_.c_str());  // 记录连接日志
@@ -120,30 +118,18 @@ void MqttProtocol::SendText(const std::string& text) {
 }
 
 // 发送音频数据
-void MqttProtocol::SendAudio(const std::vector<uint8_t>& data) {
+void MqttProtocol::SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) {
     std::lock_guard<std::mutex> lock(channel_mutex_);  // 加锁，保护共享资源
     if (udp_ == nullptr) {
         return;  // 如果 UDP 对象为空，直接返回
     }
 
-    // 生成 nonce 并填充数据大小和序列号
-    std::string nonce(aes_nonce_);
-    *(uint16_t*)&nonce[2] = htons(data.size());
-    *(uint32_t*)&nonce[12] = htonl(++local_sequence_);
-
-    // 加密音频数据
-    std::string encrypted;
-    encrypted.resize(aes_nonce_.size() + data.size());
-    memcpy(encrypted.data(), nonce.data(), nonce.size());
-
-    size_t nc_off = 0;
-    uint8_t stream_block[16] = {0};
-    if (mbedtls_aes_crypt_ctr(&aes_ctx_, data.size(), &nc_off, (uint8_t*)nonce.c_str(), stream_block,
-        (uint8_t*)data.data(), (uint8_t*)&encrypted[nonce.size()]) != 0) {
+    // 包头填充数据大小和序列号，密文直接写在包头之后
+    if (!cipher_.Seal(data.data(), data.size(), ++local_sequence_, udp_packet_)) {
         ESP_LOGE(TAG, "Failed to encrypt audio data");  // 如果加密失败，记录错误日志
         return;
     }
-    udp_->Send(encrypted);  // 发送加密后的音频数据
+    udp_->Send(udp_packet_);  // 发送加密后的音频数据
 }
 
 // 关闭音频通道
@@ -155,25 +141,43 @@ void MqttProtocol::CloseAudioChannel() {
             udp_ = nullptr;
         }
     }
+    esp_timer_stop(jitter_timer_);  // 停止抖动缓冲区定时器
+
+    auto stats = jitter_buffer_.GetStats();
+    ESP_LOGI(TAG, "Jitter buffer: received %lu reordered %lu late %lu duplicated %lu concealed %lu skipped %lu, jitter %d ms target %d ms",
+        stats.received, stats.reordered, stats.late, stats.duplicated, stats.concealed, stats.skipped, stats.jitter_ms, stats.target_ms);
 
     // 发送 goodbye 消息
-    std::string message = "{";
-    message += "\"session_id\":\"" + session_id_ + "\",";
-    message += "\"type\":\"goodbye\"";
-    message += "}";
-    SendText(message);
+    SendMessage([this](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("goodbye");
+    });
 
     if (on_audio_channel_closed_ != nullptr) {
         on_audio_channel_closed_();  // 调用音频通道关闭回调函数
     }
 }
 
+// 推测性预连接：MQTT 连接本身常驻，这里只在断线时提前重连，失败不提示用户
+// UDP 通道要等 hello 响应才能建立，不在预连接范围内
+bool MqttProtocol::PreConnect() {
+    std::lock_guard<std::mutex> lock(connect_mutex_);
+    if (mqtt_ != nullptr && mqtt_->IsConnected()) {
+        return true;
+    }
+    return StartMqttClient(false);
+}
+
 // 打开音频通道
 bool MqttProtocol::OpenAudioChannel() {
-    if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
-        ESP_LOGI(TAG, "MQTT is not connected, try to connect now");  // 如果 MQTT 未连接，尝试重新连接
-        if (!StartMqttClient(true)) {
-            return false;  // 如果连接失败，返回 false
+    int64_t start_time = esp_timer_get_time();
+    {
+        std::lock_guard<std::mutex> lock(connect_mutex_);
+        if (mqtt_ == nullptr || !mqtt_->IsConnected()) {
+            ESP_LOGI(TAG, "MQTT is not connected, try to connect now");  // 如果 MQTT 未连接，尝试重新连接
+            if (!StartMqttClient(true)) {
+                return false;  // 如果连接失败，返回 false
+            }
         }
     }
 
@@ -182,14 +186,9 @@ bool MqttProtocol::OpenAudioChannel() {
     xEventGroupClearBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);  // 清除事件组中的 SERVER_HELLO 事件
 
     // 发送 hello 消息申请 UDP 通道
-    std::string message = "{";
-    message += "\"type\":\"hello\",";
-    message += "\"version\": 3,";
-    message += "\"transport\":\"udp\",";
-    message += "\"audio_params\":{";
-    message += "\"format\":\"opus\", \"sample_rate\":16000, \"channels\":1, \"frame_duration\":" + std::to_string(OPUS_FRAME_DURATION_MS);
-    message += "}}";
-    SendText(message);
+    SendMessage([](JsonWriter& writer) {
+        WriteHello(writer, 3, "udp", OPUS_FRAME_DURATION_MS);
+    });
 
     // 等待服务器响应
     EventBits_t bits = xEventGroupWaitBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
@@ -203,9 +202,10 @@ bool MqttProtocol::OpenAudioChannel() {
     if (udp_ != nullptr) {
         delete udp_;  // 删除现有的 UDP 对象
     }
+    jitter_buffer_.Reset();  // 新会话的序列号从头开始，重置抖动缓冲区
     udp_ = Board::GetInstance().CreateUdp();  // 创建新的 UDP 对象
     udp_->OnMessage([this](const std::string& data) {
-        if (data.size() < sizeof(aes_nonce_)) {
+        if (data.size() < UdpAudioCipher::kHeaderSize) {
             ESP_LOGE(TAG, "Invalid audio packet size: %zu", data.size());  // 如果音频包大小无效，记录错误日志
             return;
         }
@@ -214,35 +214,28 @@ bool MqttProtocol::OpenAudioChannel() {
             return;
         }
         uint32_t sequence = ntohl(*(uint32_t*)&data[12]);  // 获取序列号
-        if (sequence < remote_sequence_) {
-            ESP_LOGW(TAG, "Received audio packet with old sequence: %lu, expected: %lu", sequence, remote_sequence_);  // 如果收到旧序列号，记录警告日志
-            return;
-        }
+        // 乱序与丢包交给抖动缓冲区处理，这里只记录日志
         if (sequence != remote_sequence_ + 1) {
-            ESP_LOGW(TAG, "Received audio packet with wrong sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);  // 如果收到错误的序列号，记录警告日志
+            ESP_LOGD(TAG, "Received audio packet with sequence: %lu, expected: %lu", sequence, remote_sequence_ + 1);
         }
 
-        // 解密音频数据
-        std::vector<uint8_t> decrypted;
-        size_t decrypted_size = data.size() - aes_nonce_.size();
-        size_t nc_off = 0;
-        uint8_t stream_block[16] = {0};
-        decrypted.resize(decrypted_size);
-        auto nonce = (uint8_t*)data.data();
-        auto encrypted = (uint8_t*)data.data() + aes_nonce_.size();
-        int ret = mbedtls_aes_crypt_ctr(&aes_ctx_, decrypted_size, &nc_off, nonce, stream_block, encrypted, (uint8_t*)decrypted.data());
-        if (ret != 0) {
-            ESP_LOGE(TAG, "Failed to decrypt audio data, ret: %d", ret);  // 如果解密失败，记录错误日志
-            return;
-        }
-        if (on_incoming_audio_ != nullptr) {
-            on_incoming_audio_(std::move(decrypted));  // 调用音频数据接收回调函数
+        // 直接解密到抖动缓冲区的槽位中，按序输出后交给音频数据接收回调
+        jitter_buffer_.Put(sequence, data.size() - UdpAudioCipher::kHeaderSize, [this, &data](uint8_t* decrypted) {
+            if (!cipher_.Open((const uint8_t*)data.data(), data.size(), decrypted)) {
+                ESP_LOGE(TAG, "Failed to decrypt audio data");  // 如果解密失败，记录错误日志
+                return false;
+            }
+            return true;
+        });
+        if (int32_t(sequence - remote_sequence_) > 0) {
+            remote_sequence_ = sequence;  // 更新已收到的最大远程序列号
         }
-        remote_sequence_ = sequence;  // 更新远程序列号
         last_incoming_time_ = std::chrono::steady_clock::now();  // 更新最后接收消息的时间
     });
 
     udp_->Connect(udp_server_, udp_port_);  // 连接 UDP 服务器
+    esp_timer_start_periodic(jitter_timer_, OPUS_FRAME_DURATION_MS * 1000 / 3);  // 每 1/3 帧轮询一次抖动缓冲区
+    ESP_LOGI(TAG, "Audio channel opened in %lld ms", (esp_timer_get_time() - start_time) / 1000);
 
     if (on_audio_channel_opened_ != nullptr) {
         on_audio_channel_opened_();  // 调用音频通道打开回调函数
@@ -251,46 +244,58 @@ bool MqttProtocol::OpenAudioChannel() {
 }
 
 // 解析服务器 hello 消息
-void MqttProtocol::ParseServerHello(const cJSON* root) {
-    auto transport = cJSON_GetObjectItem(root, "transport");  // 获取传输方式
-    if (transport == nullptr || strcmp(transport->valuestring, "udp") != 0) {
-        ESP_LOGE(TAG, "Unsupported transport: %s", transport->valuestring);  // 如果不支持该传输方式，记录错误日志
+void MqttProtocol::ParseServerHello(const JsonObject& root) {
+    auto& transport = root["transport"];  // 获取传输方式
+    if (!transport.Equals("udp")) {
+        ESP_LOGE(TAG, "Unsupported transport: %.*s", (int)transport.view().size(), transport.view().data());  // 如果不支持该传输方式，记录错误日志
         return;
     }
 
-    auto session_id = cJSON_GetObjectItem(root, "session_id");  // 获取会话 ID
-    if (session_id != nullptr) {
-        session_id_ = session_id->valuestring;  // 设置会话 ID
+    auto& session_id = root["session_id"];  // 获取会话 ID
+    if (session_id.IsString()) {
+        session_id_ = session_id.ToString();  // 设置会话 ID
         ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());  // 记录会话 ID 日志
     }
 
     // 从 hello 消息中获取采样率
-    auto audio_params = cJSON_GetObjectItem(root, "audio_params");
-    if (audio_params != NULL) {
-        auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
-        if (sample_rate != NULL) {
-            server_sample_rate_ = sample_rate->valueint;  // 设置服务器采样率
+    JsonObject audio_params;
+    if (audio_params.Parse(root["audio_params"].raw)) {
+        auto& sample_rate = audio_params["sample_rate"];
+        if (sample_rate.IsNumber()) {
+            server_sample_rate_ = sample_rate.ToInt();  // 设置服务器采样率
         }
     }
 
-    auto udp = cJSON_GetObjectItem(root, "udp");  // 获取 UDP 配置
-    if (udp == nullptr) {
+    JsonObject udp;  // 获取 UDP 配置
+    if (!udp.Parse(root["udp"].raw)) {
         ESP_LOGE(TAG, "UDP is not specified");  // 如果 UDP 配置未指定，记录错误日志
         return;
     }
-    udp_server_ = cJSON_GetObjectItem(udp, "server")->valuestring;  // 获取 UDP 服务器地址
-    udp_port_ = cJSON_GetObjectItem(udp, "port")->valueint;  // 获取 UDP 端口
-    auto key = cJSON_GetObjectItem(udp, "key")->valuestring;  // 获取加密密钥
-    auto nonce = cJSON_GetObjectItem(udp, "nonce")->valuestring;  // 获取 nonce
-
-    aes_nonce_ = DecodeHexString(nonce);  // 解码 nonce
-    mbedtls_aes_init(&aes_ctx_);  // 初始化 AES 上下文
-    mbedtls_aes_setkey_enc(&aes_ctx_, (const unsigned char*)DecodeHexString(key).c_str(), 128);  // 设置 AES 加密密钥
+    udp_server_ = udp["server"].ToString();  // 获取 UDP 服务器地址
+    udp_port_ = udp["port"].ToInt();  // 获取 UDP 端口
+    auto key = udp["key"].ToString();  // 获取加密密钥
+    auto nonce = udp["nonce"].ToString();  // 获取 nonce
+
+    // AES 上下文在构造时已经初始化，这里只更换密钥和 nonce
+    if (!cipher_.SetKey(DecodeHexString(key), DecodeHexString(nonce))) {
+        return;
+    }
     local_sequence_ = 0;  // 重置本地序列号
     remote_sequence_ = 0;  // 重置远程序列号
     xEventGroupSetBits(event_group_handle_, MQTT_PROTOCOL_SERVER_HELLO_EVENT);  // 设置 SERVER_HELLO 事件
 }
 
+// 服务端结束会话，会话 ID 与当前会话一致（或未指定）时关闭音频通道
+void MqttProtocol::OnServerGoodbye(const JsonObject& root) {
+    auto& session_id = root["session_id"];  // 获取会话 ID
+    ESP_LOGI(TAG, "Received goodbye message, session_id: %.*s", (int)session_id.view().size(), session_id.view().data());  // 记录 goodbye 消息日志
+    if (!session_id.IsString() || session_id_ == session_id.view()) {
+        Application::GetInstance().Schedule([this]() {
+            CloseAudioChannel();  // 关闭音频通道
+        });
+    }
+}
+
 // 辅助函数，将单个十六进制字符转换为对应的数值
 static inline uint8_t CharToHex(char c) {
     if (c >= '0' && c <= '9') return c - '0';
@@ -3,12 +3,13 @@
 
 
 #include "protocol.h"
+#include "jitter_buffer.h"
+#include "udp_audio_cipher.h"
 #include <mqtt.h>
 #include <udp.h>
-#include <cJSON.h>
-#include <mbedtls/aes.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <esp_timer.h>
 
 #include <functional>
 #include <string>
@@ -26,10 +27,12 @@ public:
     ~MqttProtocol();
 
     void Start() override;
-    void SendAudio(const std::vector<uint8_t>& data) override;
+    void SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) override;
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    // 预连接只把断开的 MQTT 长连接提前重连，窗口到期后仍按常驻连接保持，不需要 ReleasePreConnect
+    bool PreConnect() override;
 
 private:
     EventGroupHandle_t event_group_handle_;
@@ -41,17 +44,21 @@ private:
     std::string publish_topic_;
 
     std::mutex channel_mutex_;
+    std::mutex connect_mutex_;  // 预连接任务与打开音频通道不会同时重建 MQTT 客户端
     Mqtt* mqtt_ = nullptr;
     Udp* udp_ = nullptr;
-    mbedtls_aes_context aes_ctx_;
-    std::string aes_nonce_;
+    UdpAudioCipher cipher_;  // 整个协议对象生命周期内复用，重新 hello 时只更换密钥
+    std::string udp_packet_;  // 复用的上行数据包缓冲区，只在 channel_mutex_ 内使用
     std::string udp_server_;
     int udp_port_;
     uint32_t local_sequence_;
     uint32_t remote_sequence_;
+    JitterBuffer jitter_buffer_;
+    esp_timer_handle_t jitter_timer_ = nullptr;
 
     bool StartMqttClient(bool report_error=false);
-    void ParseServerHello(const cJSON* root);
+    void ParseServerHello(const JsonObject& root) override;
+    void OnServerGoodbye(const JsonObject& root) override;
     std::string DecodeHexString(const std::string& hex_string);
 
     void SendText(const std::string& text) override;
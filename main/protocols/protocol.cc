@@ -1,11 +1,14 @@
 #include "protocol.h"
 
 #include <esp_log.h>
+#include <esp_timer.h>
+#include <algorithm>
+#include <vector>
 
 #define TAG "Protocol"  // 定义日志标签
 
 // 设置 JSON 消息到达时的回调函数
-void Protocol::OnIncomingJson(std::function<void(const cJSON* root)> callback) {
+void Protocol::OnIncomingJson(std::function<void(const JsonObject& root)> callback) {
     on_incoming_json_ = callback;  // 将传入的回调函数赋值给 on_incoming_json_
 }
 
@@ -29,6 +32,54 @@ void Protocol::OnNetworkError(std::function<void(const std::string& message)> ca
     on_network_error_ = callback;  // 将传入的回调函数赋值给 on_network_error_
 }
 
+// 在接收任务中直接扫描原始文本，整条消息只在栈上记录各字段的位置，不再为每个节点分配 cJSON 对象
+void Protocol::DispatchIncomingJson(std::string_view text) {
+    int64_t start = esp_timer_get_time();
+    JsonObject root;
+    bool parsed = root.Parse(text);
+    auto& type = root["type"];
+    if (!parsed || !type.IsString()) {
+        ESP_LOGE(TAG, "Invalid message: %.*s", (int)text.size(), text.data());
+        std::lock_guard<std::mutex> lock(json_stats_mutex_);
+        json_errors_++;
+        return;
+    }
+    if (type.Equals("hello")) {
+        ParseServerHello(root);
+    } else if (type.Equals("goodbye")) {
+        OnServerGoodbye(root);
+    } else if (on_incoming_json_ != nullptr) {
+        on_incoming_json_(root);
+    }
+    last_incoming_time_ = std::chrono::steady_clock::now();
+
+    // 应用层的处理只是判断字段并 Schedule，耗时计入分发
+    uint32_t elapsed = esp_timer_get_time() - start;
+    std::lock_guard<std::mutex> lock(json_stats_mutex_);
+    json_messages_++;
+    json_bytes_ += text.size();
+    json_parse_us_ += elapsed;
+    json_parse_max_us_ = std::max(json_parse_max_us_, elapsed);
+}
+
+Protocol::JsonStats Protocol::GetJsonStats(bool reset) {
+    std::lock_guard<std::mutex> lock(json_stats_mutex_);
+    JsonStats stats;
+    stats.messages = json_messages_;
+    stats.errors = json_errors_;
+    stats.bytes = json_bytes_;
+    stats.parse_avg_us = json_messages_ > 0 ? json_parse_us_ / json_messages_ : 0;
+    stats.parse_max_us = json_parse_max_us_;
+    if (reset) {
+        json_messages_ = 0;
+        json_errors_ = 0;
+        json_bytes_ = 0;
+        json_parse_us_ = 0;
+        json_parse_max_us_ = 0;
+    }
+    return stats;
+}
+
 // 设置错误信息并触发网络错误回调
 void Protocol::SetError(const std::string& message) {
     error_occurred_ = true;  // 标记错误发生
@@ -39,52 +90,97 @@ void Protocol::SetError(const std::string& message) {
 
 // 发送中止说话的消息
 void Protocol::SendAbortSpeaking(AbortReason reason) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"abort\"";  // 构建中止消息的基本结构
-    if (reason == kAbortReasonWakeWordDetected) {
-        message += ",\"reason\":\"wake_word_detected\"";  // 如果中止原因是唤醒词检测到，添加原因字段
-    }
-    message += "}";
-    SendText(message);  // 发送消息
+    SendMessage([this, reason](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("abort");
+        if (reason == kAbortReasonWakeWordDetected) {
+            writer.Key("reason").String("wake_word_detected");  // 如果中止原因是唤醒词检测到，添加原因字段
+        }
+    });
+}
+
+// 客户端 hello 的字段：协议版本、传输方式以及上行音频参数（格式、采样率、通道数和帧持续时间）
+void Protocol::WriteHello(JsonWriter& writer, int version, std::string_view transport, int frame_duration_ms) {
+    writer.Key("type").String("hello");
+    writer.Key("version").Int(version);
+    writer.Key("transport").String(transport);
+    writer.Key("audio_params").BeginObject();
+    writer.Key("format").String("opus");
+    writer.Key("sample_rate").Int(16000);
+    writer.Key("channels").Int(1);
+    writer.Key("frame_duration").Int(frame_duration_ms);
+    writer.EndObject();
 }
 
 // 发送唤醒词检测到的消息
 void Protocol::SendWakeWordDetected(const std::string& wake_word) {
-    std::string json = "{\"session_id\":\"" + session_id_ + 
-                      "\",\"type\":\"listen\",\"state\":\"detect\",\"text\":\"" + wake_word + "\"}";  // 构建唤醒词检测消息
-    SendText(json);  // 发送消息
+    SendMessage([this, &wake_word](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("listen");
+        writer.Key("state").String("detect");
+        writer.Key("text").String(wake_word);
+    });
 }
 
 // 发送开始监听的消息
 void Protocol::SendStartListening(ListeningMode mode) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\"";  // 构建开始监听消息的基本结构
-    message += ",\"type\":\"listen\",\"state\":\"start\"";  // 添加类型和状态字段
-    if (mode == kListeningModeAlwaysOn) {
-        message += ",\"mode\":\"realtime\"";  // 如果监听模式是始终开启，添加模式字段
-    } else if (mode == kListeningModeAutoStop) {
-        message += ",\"mode\":\"auto\"";  // 如果监听模式是自动停止，添加模式字段
-    } else {
-        message += ",\"mode\":\"manual\"";  // 如果监听模式是手动，添加模式字段
-    }
-    message += "}";
-    SendText(message);  // 发送消息
+    SendMessage([this, mode](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("listen");
+        writer.Key("state").String("start");
+        if (mode == kListeningModeAlwaysOn) {
+            writer.Key("mode").String("realtime");  // 如果监听模式是始终开启，添加模式字段
+        } else if (mode == kListeningModeAutoStop) {
+            writer.Key("mode").String("auto");  // 如果监听模式是自动停止，添加模式字段
+        } else {
+            writer.Key("mode").String("manual");  // 如果监听模式是手动，添加模式字段
+        }
+    });
 }
 
 // 发送停止监听的消息
 void Protocol::SendStopListening() {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"listen\",\"state\":\"stop\"}";  // 构建停止监听消息
-    SendText(message);  // 发送消息
+    SendMessage([this](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("listen");
+        writer.Key("state").String("stop");
+    });
+}
+
+// 上行 VAD 闸门关闭时发送，之后暂停发送音频直到再次检测到人声，服务端可以据此立即判定说话结束
+void Protocol::SendSilenceMarker() {
+    SendMessage([this](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("listen");
+        writer.Key("state").String("silence");
+    });
 }
 
-// 发送 IoT 描述符的消息
+// 发送 IoT 描述符的消息，descriptors 是 ThingManager 生成的 JSON 数组
 void Protocol::SendIotDescriptors(const std::string& descriptors) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"iot\",\"descriptors\":" + descriptors + "}";  // 构建 IoT 描述符消息
-    SendText(message);  // 发送消息
+    SendMessage([this, &descriptors](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("iot");
+        writer.Key("descriptors").Raw(descriptors);
+    });
 }
 
-// 发送 IoT 状态的消息
+// 发送 IoT 状态的消息，states 是 ThingManager 生成的 JSON 数组
 void Protocol::SendIotStates(const std::string& states) {
-    std::string message = "{\"session_id\":\"" + session_id_ + "\",\"type\":\"iot\",\"states\":" + states + "}";  // 构建 IoT 状态消息
-    SendText(message);  // 发送消息
+    SendMessage([this, &states](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("iot");
+        writer.Key("states").Raw(states);
+    });
+}
+
+// 发送帧级时延统计，report 为 LatencyTracer::GetJson 生成的 JSON 对象
+void Protocol::SendLatencyReport(const std::string& report) {
+    SendMessage([this, &report](JsonWriter& writer) {
+        writer.Key("session_id").String(session_id_);
+        writer.Key("type").String("latency");
+        writer.Key("stages").Raw(report);
+    });
 }
 
 // 检查是否超时
@@ -97,4 +193,4 @@ bool Protocol::IsTimeout() const {
         ESP_LOGE(TAG, "Channel timeout %lld seconds", duration.count());  // 如果超时，记录错误日志
     }
     return timeout;  // 返回是否超时
-}
\ No newline at end of file
+}
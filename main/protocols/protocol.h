@@ -1,10 +1,14 @@
 #ifndef PROTOCOL_H
 #define PROTOCOL_H
 
-#include <cJSON.h>
+#include "json_scanner.h"
+#include "json_writer.h"
+
 #include <string>
+#include <string_view>
 #include <functional>
 #include <chrono>
+#include <mutex>
 
 struct BinaryProtocol3 {
     uint8_t type;
@@ -13,6 +17,21 @@ struct BinaryProtocol3 {
     uint8_t payload[];
 } __attribute__((packed));
 
+// WebSocket 二进制音频帧 v4（hello 协商 version 为 4 时启用），多字节字段为网络字节序，帧头之后是 Opus 数据
+struct BinaryProtocol4 {
+    uint8_t version;    // 固定为 4
+    uint8_t flags;      // kAudioFrameFlag*
+    uint16_t duration;  // 本帧音频时长（毫秒）
+    uint32_t sequence;  // 每个会话从 1 开始，每帧加一
+    uint32_t timestamp; // 上行为采集时间，下行为服务端的渲染时间，单位毫秒；0 表示未知
+    uint8_t payload[];
+} __attribute__((packed));
+
+enum AudioFrameFlags : uint8_t {
+    kAudioFrameFlagEndOfUtterance = 1 << 0,  // 一段话结束，该帧负载为空
+    kAudioFrameFlagFec = 1 << 1,             // Opus 数据包含带内 FEC
+};
+
 enum AbortReason {
     kAbortReasonNone,
     kAbortReasonWakeWordDetected
@@ -26,6 +45,15 @@ enum ListeningMode {
 
 class Protocol {
 public:
+    // 收到的控制消息解析与分发的开销，全程不分配内存
+    struct JsonStats {
+        uint32_t messages;
+        uint32_t errors;       // 格式错误或缺少 type 的消息数
+        uint32_t bytes;
+        uint32_t parse_avg_us;  // 扫描加分发（不含应用层处理）的平均耗时
+        uint32_t parse_max_us;
+    };
+
     virtual ~Protocol() = default;
 
     inline int server_sample_rate() const {
@@ -36,7 +64,7 @@ public:
     }
 
     void OnIncomingAudio(std::function<void(std::vector<uint8_t>&& data)> callback);
-    void OnIncomingJson(std::function<void(const cJSON* root)> callback);
+    void OnIncomingJson(std::function<void(const JsonObject& root)> callback);
     void OnAudioChannelOpened(std::function<void()> callback);
     void OnAudioChannelClosed(std::function<void()> callback);
     void OnNetworkError(std::function<void(const std::string& message)> callback);
@@ -45,16 +73,24 @@ public:
     virtual bool OpenAudioChannel() = 0;
     virtual void CloseAudioChannel() = 0;
     virtual bool IsAudioChannelOpened() const = 0;
-    virtual void SendAudio(const std::vector<uint8_t>& data) = 0;
+    // 推测性预连接：提前建立传输层连接但不发送 hello，随后的 OpenAudioChannel 直接复用；连接可用时返回 true
+    virtual bool PreConnect() { return false; }
+    // 预连接窗口内没有开始对话时释放连接
+    virtual void ReleasePreConnect() {}
+    // capture_time_us 为这包音频的采集时间（esp_timer_get_time），未知时为 0
+    virtual void SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) = 0;
     virtual void SendWakeWordDetected(const std::string& wake_word);
     virtual void SendStartListening(ListeningMode mode);
     virtual void SendStopListening();
+    virtual void SendSilenceMarker();
     virtual void SendAbortSpeaking(AbortReason reason);
     virtual void SendIotDescriptors(const std::string& descriptors);
     virtual void SendIotStates(const std::string& states);
+    virtual void SendLatencyReport(const std::string& report);
+    JsonStats GetJsonStats(bool reset = false);
 
 protected:
-    std::function<void(const cJSON* root)> on_incoming_json_;
+    std::function<void(const JsonObject& root)> on_incoming_json_;
     std::function<void(std::vector<uint8_t>&& data)> on_incoming_audio_;
     std::function<void()> on_audio_channel_opened_;
     std::function<void()> on_audio_channel_closed_;
@@ -65,7 +101,32 @@ protected:
     std::string session_id_;
     std::chrono::time_point<std::chrono::steady_clock> last_incoming_time_;
 
+    std::mutex json_stats_mutex_;
+    uint32_t json_messages_ = 0;
+    uint32_t json_errors_ = 0;
+    uint32_t json_bytes_ = 0;
+    uint64_t json_parse_us_ = 0;
+    uint32_t json_parse_max_us_ = 0;
+
+    std::mutex send_mutex_;
+    std::string send_buffer_;  // 复用的发送缓冲区，只在 send_mutex_ 内使用
+
     virtual void SendText(const std::string& text) = 0;
+    // 在复用的缓冲区上生成一条 JSON 对象消息（build 写入各字段），整条消息一次交给 SendText
+    template <typename Builder>
+    void SendMessage(Builder&& build) {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        JsonWriter writer(send_buffer_);
+        build(writer);
+        writer.EndObject();
+        SendText(send_buffer_);
+    }
+    // 写入客户端 hello 的各字段（不含根对象的结束），WebSocket 与 MQTT+UDP 只有版本和传输方式不同
+    static void WriteHello(JsonWriter& writer, int version, std::string_view transport, int frame_duration_ms);
+    // 扫描服务端发来的一条 JSON 文本，hello/goodbye 由协议自己处理，其余交给应用层
+    void DispatchIncomingJson(std::string_view text);
+    virtual void ParseServerHello(const JsonObject& root) {}
+    virtual void OnServerGoodbye(const JsonObject& root) {}
     virtual void SetError(const std::string& message);
     virtual bool IsTimeout() const;
 };
@@ -0,0 +1,63 @@
+#include "udp_audio_cipher.h"
+
+#include <esp_log.h>
+#include <arpa/inet.h>
+#include <cstring>
+
+#define TAG "UdpAudioCipher"
+
+UdpAudioCipher::UdpAudioCipher() {
+    mbedtls_aes_init(&context_);
+}
+
+UdpAudioCipher::~UdpAudioCipher() {
+    mbedtls_aes_free(&context_);
+}
+
+bool UdpAudioCipher::SetKey(const std::string& key, const std::string& nonce) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    ready_ = false;
+    if (key.size() != 16 || nonce.size() != kHeaderSize) {
+        ESP_LOGE(TAG, "Invalid key size %zu or nonce size %zu", key.size(), nonce.size());
+        return false;
+    }
+    // CTR 模式加解密都只用加密方向的轮密钥
+    if (mbedtls_aes_setkey_enc(&context_, (const uint8_t*)key.data(), 128) != 0) {
+        ESP_LOGE(TAG, "Failed to set AES key");
+        return false;
+    }
+    memcpy(nonce_, nonce.data(), kHeaderSize);
+    ready_ = true;
+    return true;
+}
+
+bool UdpAudioCipher::Seal(const uint8_t* payload, size_t size, uint32_t sequence, std::string& packet) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_ || size > UINT16_MAX) {
+        return false;
+    }
+    packet.resize(kHeaderSize + size);
+    auto header = (uint8_t*)packet.data();
+    memcpy(header, nonce_, kHeaderSize);
+    *(uint16_t*)&header[2] = htons(size);
+    *(uint32_t*)&header[12] = htonl(sequence);
+
+    // 计数器在加密过程中递增，不能直接用包头
+    uint8_t counter[kHeaderSize];
+    memcpy(counter, header, kHeaderSize);
+    uint8_t stream_block[16];
+    size_t nc_off = 0;
+    return mbedtls_aes_crypt_ctr(&context_, size, &nc_off, counter, stream_block, payload, header + kHeaderSize) == 0;
+}
+
+bool UdpAudioCipher::Open(const uint8_t* packet, size_t size, uint8_t* out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    if (!ready_ || size < kHeaderSize) {
+        return false;
+    }
+    uint8_t counter[kHeaderSize];
+    memcpy(counter, packet, kHeaderSize);
+    uint8_t stream_block[16];
+    size_t nc_off = 0;
+    return mbedtls_aes_crypt_ctr(&context_, size - kHeaderSize, &nc_off, counter, stream_block, packet + kHeaderSize, out) == 0;
+}
@@ -0,0 +1,35 @@
+#ifndef UDP_AUDIO_CIPHER_H
+#define UDP_AUDIO_CIPHER_H
+
+#include <mbedtls/aes.h>
+#include <string>
+#include <mutex>
+#include <cstdint>
+#include <cstddef>
+
+// UDP 音频包的 AES-128-CTR 加解密
+// 包头 16 字节同时是 CTR 计数器初值：类型、保留、负载长度、服务端下发的 nonce 与序列号，之后是密文
+// AES 上下文在对象生命周期内只初始化一次，重新 hello 时只更换密钥与 nonce 模板
+// 启用 CONFIG_MBEDTLS_HARDWARE_AES 时 mbedtls_aes_* 由芯片的 AES 外设完成
+class UdpAudioCipher {
+public:
+    static constexpr size_t kHeaderSize = 16;
+
+    UdpAudioCipher();
+    ~UdpAudioCipher();
+
+    // key 与 nonce 都是解码后的 16 字节二进制
+    bool SetKey(const std::string& key, const std::string& nonce);
+    // 加密 payload 写入 packet：先写包头再把密文直接写在包头之后，packet 的容量在各包之间复用
+    bool Seal(const uint8_t* payload, size_t size, uint32_t sequence, std::string& packet);
+    // 解密 packet 的负载写入 out（至少 size - kHeaderSize 字节），out 可以指向 packet + kHeaderSize 原地解密
+    bool Open(const uint8_t* packet, size_t size, uint8_t* out);
+
+private:
+    std::mutex mutex_;
+    mbedtls_aes_context context_;
+    uint8_t nonce_[kHeaderSize] = {};
+    bool ready_ = false;
+};
+
+#endif // UDP_AUDIO_CIPHER_H
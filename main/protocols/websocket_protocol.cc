@@ -4,26 +4,55 @@
 #include "application.h"
 
 #include <cstring>
-#include <cJSON.h>
 #include <esp_log.h>
+#include <esp_timer.h>
 #include <arpa/inet.h>
 #include "assets/lang_config.h"
 
 #define TAG "WS" // 定义日志标签
 
+#if CONFIG_WEBSOCKET_BINARY_PROTOCOL_V4
+static constexpr int kBinaryProtocolVersion = 4;
+#else
+static constexpr int kBinaryProtocolVersion = 1;
+#endif
+
+#if CONFIG_WEBSOCKET_KEEP_WARM
+static constexpr bool kKeepWarm = true;
+#else
+static constexpr bool kKeepWarm = false;
+#endif
+
 // WebsocketProtocol 构造函数
 WebsocketProtocol::WebsocketProtocol()
 {
     event_group_handle_ = xEventGroupCreate(); // 创建一个事件组，用于任务间同步
+
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    // 保温连接的保活定时器，在会话之间周期触发，实际处理放到主循环中，避免与发送并发
+    esp_timer_create_args_t keepalive_timer_args = {
+        .callback = [](void* arg) {
+            auto protocol = (WebsocketProtocol*)arg;
+            Application::GetInstance().Schedule([protocol]() {
+                protocol->KeepAlive();
+            });
+        },
+        .arg = this,
+        .dispatch_method = ESP_TIMER_TASK,
+        .name = "ws_keepalive"
+    };
+    esp_timer_create(&keepalive_timer_args, &keepalive_timer_);
+#endif
 }
 
 // WebsocketProtocol 析构函数
 WebsocketProtocol::~WebsocketProtocol()
 {
-    if (websocket_ != nullptr)
-    {
-        delete websocket_; // 删除 WebSocket 对象
-    }
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    esp_timer_stop(keepalive_timer_);
+    esp_timer_delete(keepalive_timer_);
+#endif
+    DestroyWebsocket(); // 删除 WebSocket 对象
     vEventGroupDelete(event_group_handle_); // 删除事件组
 }
 
@@ -34,145 +63,403 @@ void WebsocketProtocol::Start()
 }
 
 // 发送音频数据
-void WebsocketProtocol::SendAudio(const std::vector<uint8_t> &data)
+void WebsocketProtocol::SendAudio(const std::vector<uint8_t> &data, int64_t capture_time_us)
 {
+    SendAudioFrame(data.data(), data.size(), 0, capture_time_us);
+}
+
+// 按协商的格式发送一帧二进制音频，v4 时在复用的缓冲区中拼上帧头后一次发送
+void WebsocketProtocol::SendAudioFrame(const uint8_t* data, size_t size, uint8_t flags, int64_t capture_time_us)
+{
+    std::lock_guard<std::mutex> lock(channel_mutex_); // 加锁，防止与打开/关闭音频通道并发
     if (websocket_ == nullptr)
     {
         return; // 如果 WebSocket 对象为空，直接返回
     }
 
-    websocket_->Send(data.data(), data.size(), true); // 发送二进制音频数据
+    if (binary_version_ != 4)
+    {
+        if (size > 0)
+        {
+            websocket_->Send(data, size, true); // 发送二进制音频数据
+        }
+        return;
+    }
+
+    uplink_frame_.resize(sizeof(BinaryProtocol4) + size);
+    auto frame = (BinaryProtocol4*)uplink_frame_.data();
+    frame->version = 4;
+    frame->flags = flags;
+    frame->duration = htons(size > 0 ? OPUS_FRAME_DURATION_MS : 0);
+    frame->sequence = htonl(++uplink_sequence_);
+    frame->timestamp = htonl((uint32_t)(capture_time_us / 1000));
+    if (size > 0)
+    {
+        memcpy(frame->payload, data, size);
+    }
+    websocket_->Send(uplink_frame_.data(), uplink_frame_.size(), true);
+}
+
+// v4 下用一个空负载的帧标记一段话结束，紧跟在最后一个音频帧之后，服务端不必等 JSON 消息
+void WebsocketProtocol::SendStopListening()
+{
+    SendAudioFrame(nullptr, 0, kAudioFrameFlagEndOfUtterance, esp_timer_get_time());
+    Protocol::SendStopListening();
+}
+
+void WebsocketProtocol::SendSilenceMarker()
+{
+    SendAudioFrame(nullptr, 0, kAudioFrameFlagEndOfUtterance, esp_timer_get_time());
+    Protocol::SendSilenceMarker();
+}
+
+// 解析下行二进制帧：v4 时去掉帧头，统计服务端帧序号的缺口与渲染时间戳的到达抖动
+void WebsocketProtocol::OnIncomingAudioFrame(const uint8_t* data, size_t size)
+{
+    if (binary_version_ != 4)
+    {
+        if (on_incoming_audio_ != nullptr)
+        {
+            on_incoming_audio_(std::vector<uint8_t>(data, data + size));
+        }
+        return;
+    }
+
+    if (size < sizeof(BinaryProtocol4) || data[0] != 4)
+    {
+        ESP_LOGE(TAG, "Invalid audio frame, size %zu", size);
+        return;
+    }
+    auto frame = (const BinaryProtocol4*)data;
+    uint32_t sequence = ntohl(frame->sequence);
+    if (downlink_frames_ > 0 && int32_t(sequence - downlink_sequence_) > 1)
+    {
+        downlink_lost_ += sequence - downlink_sequence_ - 1;
+    }
+    downlink_sequence_ = sequence;
+    uint32_t timestamp = ntohl(frame->timestamp);
+    if (timestamp != 0)
+    {
+        // 两端时钟不同步，只看传输时间的变化量
+        int64_t transit = esp_timer_get_time() / 1000 - timestamp;
+        if (downlink_frames_ > 0)
+        {
+            int64_t delta = transit - downlink_transit_ms_;
+            if (delta < 0)
+            {
+                delta = -delta;
+            }
+            downlink_jitter_q4_ += (int32_t)(delta * 16 - downlink_jitter_q4_) / 16;
+        }
+        downlink_transit_ms_ = transit;
+    }
+    downlink_frames_++;
+
+    // 一段话结束的标记帧没有音频，空数据包在解码端表示丢包补偿，不能交给上层
+    size_t payload_size = size - sizeof(BinaryProtocol4);
+    if (payload_size > 0 && on_incoming_audio_ != nullptr)
+    {
+        on_incoming_audio_(std::vector<uint8_t>(frame->payload, frame->payload + payload_size));
+    }
 }
 
 // 发送文本消息
 void WebsocketProtocol::SendText(const std::string &text)
 {
-    if (websocket_ == nullptr)
     {
-        return; // 如果 WebSocket 对象为空，直接返回
+        // 加锁，防止与打开/关闭音频通道并发；接收任务与主循环都会发送消息
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (websocket_ == nullptr)
+        {
+            return; // 如果 WebSocket 对象为空，直接返回
+        }
+        if (websocket_->Send(text))
+        {
+            return;
+        }
     }
+    ESP_LOGE(TAG, "Failed to send text: %s", text.c_str()); // 如果发送失败，记录错误日志
+    SetError(Lang::Strings::SERVER_ERROR);                  // 设置错误信息
+}
 
-    if (!websocket_->Send(text))
-    {                                                           // 发送文本消息
-        ESP_LOGE(TAG, "Failed to send text: %s", text.c_str()); // 如果发送失败，记录错误日志
-        SetError(Lang::Strings::SERVER_ERROR);                  // 设置错误信息
+// 在锁内取下 websocket_，在锁外删除：析构时会等待接收任务退出，
+// 而接收任务中的回调可能正在 SendText 里等待 channel_mutex_
+void WebsocketProtocol::DestroyWebsocket()
+{
+    WebSocket* websocket;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        websocket = websocket_;
+        websocket_ = nullptr;
     }
+    delete websocket;
 }
 
 // 检查音频通道是否已打开
 bool WebsocketProtocol::IsAudioChannelOpened() const
 {
-    return websocket_ != nullptr && websocket_->IsConnected() && !error_occurred_ && !IsTimeout(); // 如果 WebSocket 已连接且无错误且未超时，返回 true
+    {
+        // websocket_ 可能正被其他任务重建或删除，加锁后再访问
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (websocket_ == nullptr || !websocket_->IsConnected())
+        {
+            return false;
+        }
+    }
+    return session_active_ && !error_occurred_ && !IsTimeout(); // 如果 WebSocket 已连接、会话进行中且无错误且未超时，返回 true
 }
 
 // 关闭音频通道
 void WebsocketProtocol::CloseAudioChannel()
 {
-    if (websocket_ != nullptr)
+    EndSession(true);
+}
+
+// 结束当前会话，send_goodbye 为 false 表示服务端已经发来 goodbye，不再回复
+void WebsocketProtocol::EndSession(bool send_goodbye)
+{
+    if (binary_version_ == 4 && downlink_frames_ > 0)
     {
-        delete websocket_; // 删除 WebSocket 对象
-        websocket_ = nullptr;
+        ESP_LOGI(TAG, "Downlink frames: %lu received, %lu lost, jitter %ld ms",
+            downlink_frames_, downlink_lost_, downlink_jitter_q4_ / 16);
+    }
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    // 连接仍然可用时只结束会话，保留连接供下一次对话使用
+    bool connected;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        connected = websocket_ != nullptr && websocket_->IsConnected();
+    }
+    if (connected && !error_occurred_)
+    {
+        if (session_active_.exchange(false))
+        {
+            if (send_goodbye)
+            {
+                SendMessage([this](JsonWriter& writer) {
+                    writer.Key("session_id").String(session_id_);
+                    writer.Key("type").String("goodbye");
+                });
+            }
+            idle_since_ = esp_timer_get_time();
+            esp_timer_start_periodic(keepalive_timer_, CONFIG_WEBSOCKET_PING_INTERVAL * 1000000LL);
+            if (on_audio_channel_closed_ != nullptr)
+            {
+                on_audio_channel_closed_();
+            }
+        }
+        return;
+    }
+    esp_timer_stop(keepalive_timer_);
+#endif
+    bool was_active = session_active_.exchange(false);
+    DestroyWebsocket(); // 删除 WebSocket 对象
+    // 保温模式下断开回调不再通知应用层，会话中关闭时在这里通知
+    if (kKeepWarm && was_active && on_audio_channel_closed_ != nullptr)
+    {
+        on_audio_channel_closed_();
     }
 }
 
-// 打开音频通道
-// 此方法用于打开音频通道，返回值表示是否成功打开音频通道
-bool WebsocketProtocol::OpenAudioChannel()
+// 推测性预连接：在独立任务中调用，只建立连接不发送 hello
+bool WebsocketProtocol::PreConnect()
 {
-    // 如果当前的 WebSocket 对象已经存在，则先删除它，释放资源
-    if (websocket_ != nullptr)
+    std::lock_guard<std::mutex> open_lock(open_mutex_);
+    if (session_active_)
     {
-        delete websocket_;
+        return true;
     }
-
-    // 重置错误发生标志，将其设为 false，表示当前没有发生错误
+    bool connected;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        connected = websocket_ != nullptr && websocket_->IsConnected();
+    }
+    if (connected && !error_occurred_)
+    {
+        preconnected_ = true;
+        return true;
+    }
+    DestroyWebsocket();
     error_occurred_ = false;
+    preconnected_ = true;
+    if (!Connect(false))
+    {
+        preconnected_ = false;
+        return false;
+    }
+    return true;
+}
+
+// 预连接窗口到期：没有被 OpenAudioChannel 取走的连接在非保温模式下断开
+// 应用层在预连接任务返回后才调用；此时 OpenAudioChannel 正在进行则不等待，连接交给它复用或替换
+void WebsocketProtocol::ReleasePreConnect()
+{
+    std::unique_lock<std::mutex> open_lock(open_mutex_, std::try_to_lock);
+    if (!open_lock.owns_lock() || session_active_ || !preconnected_)
+    {
+        return;
+    }
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    // 保温模式下按空闲超时管理
+    idle_since_ = esp_timer_get_time();
+    esp_timer_start_periodic(keepalive_timer_, CONFIG_WEBSOCKET_PING_INTERVAL * 1000000LL);
+#else
+    DestroyWebsocket();
+#endif
+    // 断开之后再清除标志，断开回调不会通知应用层
+    preconnected_ = false;
+}
+
+#if CONFIG_WEBSOCKET_KEEP_WARM
+// 会话之间在主循环中周期调用：连接已断开或空闲超时则释放连接，否则发送 ping 保活
+void WebsocketProtocol::KeepAlive()
+{
+    std::unique_lock<std::mutex> open_lock(open_mutex_, std::try_to_lock);
+    if (!open_lock.owns_lock() || session_active_)
+    {
+        return;
+    }
+    int64_t idle_seconds = (esp_timer_get_time() - idle_since_) / 1000000;
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (websocket_ == nullptr)
+        {
+            return;
+        }
+        if (websocket_->IsConnected() && idle_seconds < CONFIG_WEBSOCKET_IDLE_TIMEOUT)
+        {
+            websocket_->Ping();
+            return;
+        }
+    }
+
+    ESP_LOGI(TAG, "Closing idle websocket after %lld seconds", idle_seconds);
+    esp_timer_stop(keepalive_timer_);
+    DestroyWebsocket();
+}
+#endif
+
+// 建立 WebSocket 连接：TCP 连接、TLS 握手与 HTTP 升级
+bool WebsocketProtocol::Connect(bool report_error)
+{
     // 获取配置文件中定义的 WebSocket 服务器的 URL
     std::string url = CONFIG_WEBSOCKET_URL;
     // 构建认证令牌，格式为 "Bearer " 加上配置文件中定义的访问令牌
     std::string token = "Bearer " + std::string(CONFIG_WEBSOCKET_ACCESS_TOKEN);
-    // 通过 Board 单例对象创建一个新的 WebSocket 对象
-    websocket_ = Board::GetInstance().CreateWebSocket();
+    // 通过 Board 单例对象创建一个新的 WebSocket 对象，设置完成并连接成功后才在锁内发布到 websocket_，
+    // 其它任务不会看到未配置或正在连接的对象
+    auto websocket = Board::GetInstance().CreateWebSocket();
     // 设置 WebSocket 请求头中的 Authorization 字段，用于身份认证
-    websocket_->SetHeader("Authorization", token.c_str());
+    websocket->SetHeader("Authorization", token.c_str());
     // 设置 WebSocket 请求头中的 Protocol-Version 字段，指定协议版本
-    websocket_->SetHeader("Protocol-Version", "1");
+    websocket->SetHeader("Protocol-Version", std::to_string(kBinaryProtocolVersion).c_str());
     // 设置 WebSocket 请求头中的 Device-Id 字段，使用系统的 MAC 地址作为设备 ID
-    websocket_->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
+    websocket->SetHeader("Device-Id", SystemInfo::GetMacAddress().c_str());
     // 设置 WebSocket 请求头中的 Client-Id 字段，使用 Board 的 UUID 作为客户端 ID
-    websocket_->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
+    websocket->SetHeader("Client-Id", Board::GetInstance().GetUuid().c_str());
 
     // 设置 WebSocket 数据到达时的回调函数
-    websocket_->OnData([this](const char *data, size_t len, bool binary)
-                       {
+    websocket->OnData([this](const char *data, size_t len, bool binary)
+                      {
         // 如果接收到的数据是二进制数据
         if (binary) {
-            // 如果已经设置了处理二进制音频数据的回调函数 on_incoming_audio_，则调用它来处理数据
-            if (on_incoming_audio_ != nullptr) {
-                on_incoming_audio_(std::vector<uint8_t>((uint8_t*)data, (uint8_t*)data + len));  
-            }
+            // 按协商的帧格式解析后交给音频数据回调 on_incoming_audio_
+            OnIncomingAudioFrame((const uint8_t*)data, len);
         } else {
-            // 如果接收到的数据不是二进制数据，即可能是 JSON 数据，解析 JSON 数据
-            auto root = cJSON_Parse(data);  
-            // 从解析后的 JSON 数据中获取 "type" 字段，以确定消息类型
-            auto type = cJSON_GetObjectItem(root, "type");  
-            // 如果成功获取到了消息类型字段
-            if (type != NULL) {
-                // 如果消息类型为 "hello"，则调用 ParseServerHello 方法处理服务器的 hello 消息
-                if (strcmp(type->valuestring, "hello") == 0) {
-                    ParseServerHello(root);  
-                } else {
-                    // 如果消息类型不是 "hello"，且已经设置了处理 JSON 数据的回调函数 on_incoming_json_，则调用它来处理数据
-                    if (on_incoming_json_ != nullptr) {
-                        on_incoming_json_(root);  
-                    }
-                }
-            } else {
-                // 如果没有获取到消息类型字段，记录错误日志，显示消息数据
-                ESP_LOGE(TAG, "Missing message type, data: %s", data);  
-            }
-            // 释放解析后的 JSON 对象占用的内存
-            cJSON_Delete(root);  
+            // 文本帧为 JSON 控制消息，直接在接收缓冲区上扫描，不复制也不分配内存
+            DispatchIncomingJson(std::string_view(data, len));
         }
         // 更新最后接收到消息的时间，记录当前时间
         last_incoming_time_ = std::chrono::steady_clock::now(); });
 
     // 设置 WebSocket 断开连接时的回调函数
-    websocket_->OnDisconnected([this]()
-                               {
+    websocket->OnDisconnected([this]()
+                              {
         // 记录 WebSocket 断开连接的日志信息
         ESP_LOGI(TAG, "Websocket disconnected");  
+        // 保温或预连接的连接在会话之外断开时不通知应用层，下一次打开音频通道时重新连接
+        if (!session_active_.exchange(false) && (kKeepWarm || preconnected_)) {
+            return;
+        }
         // 如果已经设置了音频通道关闭的回调函数 on_audio_channel_closed_，则调用它
         if (on_audio_channel_closed_ != nullptr) {
             on_audio_channel_closed_();  
         } });
 
     // 尝试连接到指定的 WebSocket 服务器
-    if (!websocket_->Connect(url.c_str()))
+    if (!websocket->Connect(url.c_str()))
     {
         // 如果连接失败，记录错误日志，显示连接服务器失败的信息
         ESP_LOGE(TAG, "Failed to connect to websocket server");
-        // 设置错误信息为 "服务器未找到"
-        SetError(Lang::Strings::SERVER_NOT_FOUND);
+        // 设置错误信息为 "服务器未找到"，预连接失败不提示用户
+        if (report_error)
+        {
+            SetError(Lang::Strings::SERVER_NOT_FOUND);
+        }
+        delete websocket;
         // 返回 false，表示打开音频通道失败
         return false;
     }
 
-    // 发送 hello 消息，描述客户端的信息
-    std::string message = "{";
-    // 添加消息类型字段
-    message += "\"type\":\"hello\",";
-    // 添加协议版本字段
-    message += "\"version\": 1,";
-    // 添加传输方式字段
-    message += "\"transport\":\"websocket\",";
-    // 添加音频参数字段
-    message += "\"audio_params\":{";
-    // 添加音频参数的具体内容，包括格式、采样率、通道数和帧持续时间
-    message += "\"format\":\"opus\", \"sample_rate\":16000, \"channels\":1, \"frame_duration\":" + std::to_string(OPUS_FRAME_DURATION_MS);
-    message += "}}";
-    // 发送构建好的 hello 消息到服务器
-    websocket_->Send(message);
+    std::lock_guard<std::mutex> lock(channel_mutex_);
+    websocket_ = websocket;
+    return true;
+}
+
+// 打开音频通道
+// 此方法用于打开音频通道，返回值表示是否成功打开音频通道
+// 保温模式下连接仍然可用时直接在现有连接上发送 hello 开始新的会话
+bool WebsocketProtocol::OpenAudioChannel()
+{
+    int64_t start_time = esp_timer_get_time();
+    // 预连接仍在进行时等待它完成后复用
+    std::lock_guard<std::mutex> open_lock(open_mutex_);
+    bool warm = false;
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    esp_timer_stop(keepalive_timer_);
+#endif
+    {
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        if (websocket_ != nullptr && (kKeepWarm || preconnected_) && websocket_->IsConnected() && !error_occurred_)
+        {
+            warm = true;
+        }
+    }
+    // 如果当前的 WebSocket 对象已经存在且不能复用，则先删除它，释放资源
+    if (!warm)
+    {
+        DestroyWebsocket();
+    }
+
+    // 重置错误发生标志，将其设为 false，表示当前没有发生错误
+    error_occurred_ = false;
+    session_active_ = false;
+    preconnected_ = false;
+    {
+        // 新会话的帧序号从头开始，收到服务端 hello 之前按不带帧头的格式处理
+        std::lock_guard<std::mutex> lock(channel_mutex_);
+        binary_version_ = 1;
+        uplink_sequence_ = 0;
+    }
+    if (!warm && !Connect(true))
+    {
+        return false;
+    }
+
+    // 发送 hello 消息，描述客户端的信息：消息类型、协议版本、传输方式以及音频参数（格式、采样率、通道数和帧持续时间）
+    {
+        std::lock_guard<std::mutex> lock(send_mutex_);
+        JsonWriter writer(send_buffer_);
+        WriteHello(writer, kBinaryProtocolVersion, "websocket", OPUS_FRAME_DURATION_MS);
+        writer.EndObject();
+        // 发送构建好的 hello 消息到服务器
+        xEventGroupClearBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
+        std::lock_guard<std::mutex> channel_lock(channel_mutex_);
+        if (websocket_ != nullptr)
+        {
+            websocket_->Send(send_buffer_);
+        }
+    }
 
     // 等待服务器的 hello 响应，设置等待时间为 10 秒（10000 毫秒）
     EventBits_t bits = xEventGroupWaitBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT, pdTRUE, pdFALSE, pdMS_TO_TICKS(10000));
@@ -187,6 +474,23 @@ bool WebsocketProtocol::OpenAudioChannel()
         return false;
     }
 
+    session_active_ = true;
+    int64_t open_us = esp_timer_get_time() - start_time;
+    if (warm)
+    {
+        warm_opens_++;
+        warm_open_us_ += open_us;
+    }
+    else
+    {
+        cold_opens_++;
+        cold_open_us_ += open_us;
+    }
+    ESP_LOGI(TAG, "Audio channel opened in %lld ms (%s), avg warm %llu ms in %lu, cold %llu ms in %lu",
+        open_us / 1000, warm ? "warm" : "cold",
+        warm_opens_ > 0 ? warm_open_us_ / warm_opens_ / 1000 : 0, warm_opens_,
+        cold_opens_ > 0 ? cold_open_us_ / cold_opens_ / 1000 : 0, cold_opens_);
+
     // 如果已经设置了音频通道打开的回调函数 on_audio_channel_opened_，则调用它
     if (on_audio_channel_opened_ != nullptr)
     {
@@ -199,36 +503,58 @@ bool WebsocketProtocol::OpenAudioChannel()
 
 // 解析服务器 hello 消息
 // 此方法用于解析服务器的 Hello 消息，属于 WebsocketProtocol 类
-// 传入的参数 root 是一个指向 cJSON 对象的指针，代表服务器发送的 Hello 消息的 JSON 数据
-void WebsocketProtocol::ParseServerHello(const cJSON *root)
+// 传入的参数 root 是服务器发送的 Hello 消息扫描后的顶层字段
+void WebsocketProtocol::ParseServerHello(const JsonObject& root)
 {
-    // 从 JSON 数据根节点中获取名为 "transport" 的子项，用于获取传输方式信息
-    auto transport = cJSON_GetObjectItem(root, "transport");
-    // 如果获取到的 "transport" 子项为空，或者其值不是 "websocket"
-    if (transport == nullptr || strcmp(transport->valuestring, "websocket") != 0)
+    // 获取传输方式，只支持 "websocket"
+    auto& transport = root["transport"];
+    if (!transport.Equals("websocket"))
     {
         // 记录错误日志，显示不支持的传输方式
-        ESP_LOGE(TAG, "Unsupported transport: %s", transport->valuestring);
+        ESP_LOGE(TAG, "Unsupported transport: %.*s", (int)transport.view().size(), transport.view().data());
         // 直接返回，不再继续解析后续内容
         return;
     }
 
-    // 从 JSON 数据根节点中获取名为 "audio_params" 的子项，用于获取音频参数信息
-    auto audio_params = cJSON_GetObjectItem(root, "audio_params");
-    // 如果成功获取到了音频参数子项
-    if (audio_params != NULL)
+    // 获取会话 ID，保温连接上的每次会话都由服务端重新分配，没有时清空，避免沿用上一次会话的 ID
+    auto& session_id = root["session_id"];
+    session_id_ = session_id.IsString() ? session_id.ToString() : std::string();
+    if (!session_id_.empty())
     {
-        // 从音频参数子项中获取名为 "sample_rate" 的子项，用于获取采样率信息
-        auto sample_rate = cJSON_GetObjectItem(audio_params, "sample_rate");
-        // 如果成功获取到了采样率子项
-        if (sample_rate != NULL)
+        ESP_LOGI(TAG, "Session ID: %s", session_id_.c_str());
+    }
+
+    // "audio_params" 是嵌套对象，单独再扫描一次以获取采样率
+    JsonObject audio_params;
+    if (audio_params.Parse(root["audio_params"].raw))
+    {
+        // 如果采样率字段是数字，赋给成员变量 server_sample_rate_，设置服务器采样率
+        auto& sample_rate = audio_params["sample_rate"];
+        if (sample_rate.IsNumber())
         {
-            // 将采样率的值（为整数类型）赋给成员变量 server_sample_rate_，设置服务器采样率
-            server_sample_rate_ = sample_rate->valueint;
+            server_sample_rate_ = sample_rate.ToInt();
         }
     }
 
+    // 服务端回复 version 4 表示接受带帧头的二进制音频帧，否则两个方向都使用不带帧头的 Opus 数据
+    binary_version_ = kBinaryProtocolVersion == 4 && root["version"].ToInt(1) == 4 ? 4 : 1;
+    downlink_frames_ = 0;
+    downlink_lost_ = 0;
+    downlink_jitter_q4_ = 0;
+    ESP_LOGI(TAG, "Binary protocol version %d", binary_version_.load());
+
     // 使用 xEventGroupSetBits 函数设置事件组 event_group_handle_ 中的 WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT 事件位
     // 用于通知其他部分服务器的 Hello 消息已成功解析
     xEventGroupSetBits(event_group_handle_, WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT);
+}
+
+// 服务端结束会话：保温模式下只关闭音频通道，连接保留，会话由服务端发起结束，不再回复 goodbye；
+// 否则忽略，由服务端断开连接
+void WebsocketProtocol::OnServerGoodbye(const JsonObject& root)
+{
+    if (kKeepWarm) {
+        Application::GetInstance().Schedule([this]() {
+            EndSession(false);
+        });
+    }
 }
\ No newline at end of file
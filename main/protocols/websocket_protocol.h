@@ -7,6 +7,10 @@
 #include <web_socket.h>
 #include <freertos/FreeRTOS.h>
 #include <freertos/event_groups.h>
+#include <esp_timer.h>
+#include <mutex>
+#include <atomic>
+#include <vector>
 
 #define WEBSOCKET_PROTOCOL_SERVER_HELLO_EVENT (1 << 0)
 
@@ -16,16 +20,53 @@ public:
     ~WebsocketProtocol();
 
     void Start() override;
-    void SendAudio(const std::vector<uint8_t>& data) override;
+    void SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) override;
+    void SendStopListening() override;
+    void SendSilenceMarker() override;
     bool OpenAudioChannel() override;
     void CloseAudioChannel() override;
     bool IsAudioChannelOpened() const override;
+    bool PreConnect() override;
+    void ReleasePreConnect() override;
 
 private:
     EventGroupHandle_t event_group_handle_;
     WebSocket* websocket_ = nullptr;
+    mutable std::mutex channel_mutex_;  // 保护 websocket_，SendAudio 会在上行编码任务中调用
+    std::mutex open_mutex_;  // 串行化建立连接：预连接任务与打开音频通道不会同时重建 websocket_
+    std::atomic<bool> session_active_ = false;  // hello 完成到 goodbye 之间为 true
+    std::atomic<bool> preconnected_ = false;    // 已预连接、等待 OpenAudioChannel 复用
 
-    void ParseServerHello(const cJSON* root);
+    // 二进制音频帧格式：服务端 hello 确认 version 4 时收发都带 BinaryProtocol4 帧头，否则为不带帧头的 Opus 数据
+    std::atomic<int> binary_version_ = 1;
+    uint32_t uplink_sequence_ = 0;       // channel_mutex_ 保护
+    std::vector<uint8_t> uplink_frame_;  // 复用的上行帧缓冲区，channel_mutex_ 保护
+    // 下行 v4 帧统计，只在接收回调中访问
+    uint32_t downlink_frames_ = 0;
+    uint32_t downlink_lost_ = 0;
+    uint32_t downlink_sequence_ = 0;
+    int64_t downlink_transit_ms_ = 0;
+    int32_t downlink_jitter_q4_ = 0;  // RFC 3550 到达间隔抖动，单位 1/16 毫秒
+
+    // 打开音频通道的耗时统计，区分新建连接与复用保温连接
+    uint32_t cold_opens_ = 0;
+    uint32_t warm_opens_ = 0;
+    uint64_t cold_open_us_ = 0;
+    uint64_t warm_open_us_ = 0;
+
+#if CONFIG_WEBSOCKET_KEEP_WARM
+    esp_timer_handle_t keepalive_timer_ = nullptr;
+    int64_t idle_since_ = 0;
+
+    void KeepAlive();
+#endif
+    bool Connect(bool report_error);
+    void DestroyWebsocket();
+    void EndSession(bool send_goodbye);
+    void SendAudioFrame(const uint8_t* data, size_t size, uint8_t flags, int64_t capture_time_us);
+    void OnIncomingAudioFrame(const uint8_t* data, size_t size);
+    void ParseServerHello(const JsonObject& root) override;
+    void OnServerGoodbye(const JsonObject& root) override;
     void SendText(const std::string& text) override;
 };
 
@@ -108,6 +108,41 @@ void Settings::SetInt(const std::string& key, int32_t value) {
     }
 }
 
+// 获取二进制配置项，不存在时返回空
+// 参数:
+// - key: 配置项的键
+std::vector<uint8_t> Settings::GetBlob(const std::string& key) {
+    std::vector<uint8_t> value;
+    if (nvs_handle_ == 0) {
+        return value;
+    }
+    size_t length = 0;
+    if (nvs_get_blob(nvs_handle_, key.c_str(), nullptr, &length) != ESP_OK) {
+        return value;
+    }
+    value.resize(length);
+    if (nvs_get_blob(nvs_handle_, key.c_str(), value.data(), &length) != ESP_OK) {
+        value.clear();
+    }
+    return value;
+}
+
+// 设置二进制配置项
+// 参数:
+// - key: 配置项的键
+// - data/size: 配置项的内容
+void Settings::SetBlob(const std::string& key, const uint8_t* data, size_t size) {
+    // 如果以写模式打开
+    if (read_write_) {
+        ESP_ERROR_CHECK(nvs_set_blob(nvs_handle_, key.c_str(), data, size));
+        // 标记数据为已修改
+        dirty_ = true;
+    } else {
+        // 如果以只读模式打开，记录警告日志
+        ESP_LOGW(TAG, "Namespace %s is not open for writing", ns_.c_str());
+    }
+}
+
 // 删除指定的配置项
 // 参数:
 // - key: 配置项的键
@@ -0,0 +1,102 @@
+#include "uplink_gate.h"
+
+#include <esp_log.h>
+#include <algorithm>
+#include <cstring>
+
+#define TAG "UplinkGate"
+
+void UplinkGate::Configure(int sample_rate, int preroll_ms, int hangover_ms) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    sample_rate_ = sample_rate;
+    hangover_samples_ = (size_t)sample_rate * hangover_ms / 1000;
+    preroll_.assign((size_t)sample_rate * preroll_ms / 1000, 0);
+    preroll_pos_ = 0;
+    preroll_used_ = 0;
+    ESP_LOGI(TAG, "Uplink gate: preroll %d ms, hangover %d ms", preroll_ms, hangover_ms);
+}
+
+// 会话开头一律发送：唤醒词之后紧接着就是用户说话，此时 VAD 的状态还没有跟上
+void UplinkGate::Reset() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    open_ = true;
+    silent_samples_ = 0;
+    preroll_pos_ = 0;
+    preroll_used_ = 0;
+    passed_samples_ = 0;
+    gated_samples_ = 0;
+    closes_ = 0;
+}
+
+void UplinkGate::SetVoiceActive(bool active) {
+    voice_active_ = active;
+}
+
+UplinkGate::Action UplinkGate::Process(const std::vector<int16_t>& pcm) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    bool voice = voice_active_;
+    if (open_) {
+        silent_samples_ = voice ? 0 : silent_samples_ + pcm.size();
+        if (silent_samples_ < hangover_samples_) {
+            passed_samples_ += pcm.size();
+            return kActionPass;
+        }
+        open_ = false;
+        closes_++;
+        StorePreroll(pcm.data(), pcm.size());
+        return kActionClose;
+    }
+
+    if (voice) {
+        open_ = true;
+        silent_samples_ = 0;
+        passed_samples_ += pcm.size();
+        return kActionOpen;
+    }
+    StorePreroll(pcm.data(), pcm.size());
+    return kActionGate;
+}
+
+void UplinkGate::StorePreroll(const int16_t* data, size_t samples) {
+    gated_samples_ += samples;
+    const size_t capacity = preroll_.size();
+    if (capacity == 0) {
+        return;
+    }
+    // 只保留最后 capacity 个样本
+    if (samples > capacity) {
+        data += samples - capacity;
+        samples = capacity;
+    }
+    size_t first = std::min(samples, capacity - preroll_pos_);
+    memcpy(preroll_.data() + preroll_pos_, data, first * sizeof(int16_t));
+    memcpy(preroll_.data(), data + first, (samples - first) * sizeof(int16_t));
+    preroll_pos_ = (preroll_pos_ + samples) % capacity;
+    preroll_used_ = std::min(preroll_used_ + samples, capacity);
+}
+
+void UplinkGate::TakePreroll(std::vector<int16_t>& out) {
+    std::lock_guard<std::mutex> lock(mutex_);
+    const size_t capacity = preroll_.size();
+    size_t count = preroll_used_;
+    size_t existing = out.size();
+    out.resize(existing + count);
+    // 预录在前，原有数据后移
+    memmove(out.data() + count, out.data(), existing * sizeof(int16_t));
+    size_t start = (preroll_pos_ + capacity - count) % std::max<size_t>(capacity, 1);
+    size_t first = std::min(count, capacity - start);
+    memcpy(out.data(), preroll_.data() + start, first * sizeof(int16_t));
+    memcpy(out.data() + first, preroll_.data(), (count - first) * sizeof(int16_t));
+    preroll_used_ = 0;
+    gated_samples_ -= count;
+    passed_samples_ += count;
+}
+
+UplinkGate::Stats UplinkGate::GetStats() {
+    std::lock_guard<std::mutex> lock(mutex_);
+    Stats stats;
+    stats.passed_ms = passed_samples_ * 1000 / sample_rate_;
+    stats.gated_ms = gated_samples_ * 1000 / sample_rate_;
+    stats.closes = closes_;
+    return stats;
+}
@@ -0,0 +1,56 @@
+#ifndef UPLINK_GATE_H
+#define UPLINK_GATE_H
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+
+// 上行 VAD 闸门：监听状态下持续静音超过拖尾时长后停止编码和发送，
+// 闸门关闭期间保留最近 preroll_ms 的 PCM，检测到人声时先补发这段预录再继续发送，避免吞掉字头
+// Process 只在 AFE 输出任务中调用，SetVoiceActive 可以在任意任务中调用
+class UplinkGate {
+public:
+    enum Action {
+        kActionPass,   // 闸门打开，正常发送本帧
+        kActionGate,   // 闸门关闭，本帧已存入预录，不发送
+        kActionOpen,   // 闸门刚打开，先取出预录放在本帧之前一起发送
+        kActionClose,  // 拖尾结束，本帧存入预录，需要发送一次静音标记
+    };
+
+    struct Stats {
+        uint32_t passed_ms;  // 发送的音频时长（含补发的预录）
+        uint32_t gated_ms;   // 被拦下、未编码未发送的音频时长
+        uint32_t closes;     // 闸门关闭（发送静音标记）的次数
+    };
+
+    void Configure(int sample_rate, int preroll_ms, int hangover_ms);
+    // 开始新的监听会话：闸门打开，清空预录与统计
+    void Reset();
+    void SetVoiceActive(bool active);
+    Action Process(const std::vector<int16_t>& pcm);
+    // 按时间顺序取出预录 PCM 并清空，out 中原有数据放在预录之后
+    void TakePreroll(std::vector<int16_t>& out);
+    Stats GetStats();
+
+private:
+    std::mutex mutex_;
+    std::atomic<bool> voice_active_ = false;
+    int sample_rate_ = 16000;
+    size_t hangover_samples_ = 0;
+    bool open_ = true;
+    size_t silent_samples_ = 0;  // 闸门打开状态下自最后一次人声起的样本数
+
+    std::vector<int16_t> preroll_;  // 环形缓冲区，容量为 preroll_ms 的样本数
+    size_t preroll_pos_ = 0;
+    size_t preroll_used_ = 0;
+
+    uint64_t passed_samples_ = 0;
+    uint64_t gated_samples_ = 0;
+    uint32_t closes_ = 0;
+
+    void StorePreroll(const int16_t* data, size_t samples);
+};
+
+#endif // UPLINK_GATE_H
@@ -0,0 +1,428 @@
+#! /usr/bin/env python3
+"""
+端到端对话基准测试：在本进程中启动 protocol_test_server.TestServer，驱动设备完成若干轮对话并统计
+  - channel_open_ms：打开音频通道的耗时（WebSocket 含建立连接，MQTT+UDP 为 hello 往返与 UDP 建立）
+  - wake_to_first_tts_ms：从唤醒（开始打开音频通道）到第一帧 TTS 音频
+  - speech_end_to_first_tts_ms：最后一个上行音频帧到第一帧 TTS 音频
+  - uplink_kbps / downlink_kbps 与 realtime_factor：上下行码率，以及音频时长与实际耗时之比
+
+设备端为内置的设备模拟器（--emulate websocket|mqtt），按固件的消息时序收发，
+可用 --clients 并发、--fast 不按实时节拍上行。
+测得的是模拟器与测试服务器之间的协议时延，不包含固件代码：linux-host 主机构建目前只支持回环连接方式，
+还不能以 WebSocket 或 MQTT+UDP 连接测试服务器，驱动固件的端到端基准测试尚未提供
+
+用法：
+    python scripts/protocol_benchmark.py --emulate websocket --runs 10
+    python scripts/protocol_benchmark.py --emulate mqtt --clients 4 --runs 5 --fast
+"""
+import argparse
+import asyncio
+import json
+import os
+import struct
+import sys
+import ssl
+import time
+
+import protocol_test_server as server_module
+from protocol_test_server import (
+    AUDIO_FRAME_FLAG_END_OF_UTTERANCE, BINARY_PROTOCOL4, MQTT_CONNECT, MQTT_DISCONNECT, MQTT_PUBLISH,
+    OPUS_FRAME_DURATION_MS, UDP_HEADER_SIZE, WS_OPCODE_BINARY, WS_OPCODE_CLOSE, WS_OPCODE_PING, WS_OPCODE_PONG,
+    WS_OPCODE_TEXT, aes_ctr, load_p3, make_block_cipher, mqtt_encode_packet, mqtt_encode_string,
+    mqtt_parse_publish, mqtt_read_packet, ws_encode_frame, ws_read_message,
+)
+
+REPO_DIR = os.path.dirname(os.path.dirname(os.path.abspath(__file__)))
+DEFAULT_INPUT = os.path.join(REPO_DIR, "main", "assets", "zh-CN", "activation.p3")
+
+METRICS = [
+    "connect_ms",
+    "channel_open_ms",
+    "wake_to_first_tts_ms",
+    "speech_end_to_first_tts_ms",
+    "uplink_kbps",
+    "downlink_kbps",
+    "realtime_factor",
+]
+
+
+def percentile(values, p):
+    """最近秩百分位数"""
+    ordered = sorted(values)
+    index = max(0, min(len(ordered) - 1, int(round(p / 100 * len(ordered) + 0.5)) - 1))
+    return ordered[index]
+
+
+def summarize(samples):
+    summary = {}
+    for name in METRICS:
+        values = [s[name] for s in samples if s.get(name) is not None]
+        if values:
+            summary[name] = {
+                "n": len(values),
+                "min": min(values),
+                "p50": percentile(values, 50),
+                "p90": percentile(values, 90),
+                "max": max(values),
+                "mean": sum(values) / len(values),
+            }
+    return summary
+
+
+def print_summary(summary, extra):
+    print()
+    for key, value in extra.items():
+        print(f"{key}: {value}")
+    print(f"{'metric':28s} {'n':>4s} {'min':>9s} {'p50':>9s} {'p90':>9s} {'max':>9s} {'mean':>9s}")
+    for name, s in summary.items():
+        print(f"{name:28s} {s['n']:4d} {s['min']:9.1f} {s['p50']:9.1f} {s['p90']:9.1f} {s['max']:9.1f} {s['mean']:9.1f}")
+
+
+# ---- 设备模拟器 ----
+
+class EmulatedDevice:
+    """按固件的时序完成一次对话：唤醒后打开音频通道、发送 detect 与 listen start、
+    上行一段录音、发送结束标记与 listen stop、接收完整的 TTS 后结束会话"""
+
+    def __init__(self, options, server, packets, index):
+        self.options = options
+        self.server = server
+        self.packets = packets
+        self.device_id = f"02:00:00:00:00:{index:02x}"
+        self.client_id = f"benchmark-{index}"
+        self.loop = asyncio.get_running_loop()
+        self.reset()
+
+    def reset(self):
+        self.hello = asyncio.Event()
+        self.tts_stopped = asyncio.Event()
+        self.server_hello = None
+        self.first_tts_time = None
+        self.downlink_frames = 0
+        self.downlink_bytes = 0
+
+    def now(self):
+        return self.loop.time()
+
+    def on_json(self, message):
+        kind = message.get("type")
+        if kind == "hello":
+            self.server_hello = message
+            self.hello.set()
+        elif kind == "tts" and message.get("state") == "stop":
+            self.tts_stopped.set()
+
+    def on_audio(self, opus):
+        if not opus:
+            return
+        if self.first_tts_time is None:
+            self.first_tts_time = self.now()
+        self.downlink_frames += 1
+        self.downlink_bytes += len(opus)
+
+    def hello_message(self, transport, version):
+        return {
+            "type": "hello",
+            "version": version,
+            "transport": transport,
+            "audio_params": {"format": "opus", "sample_rate": 16000, "channels": 1,
+                             "frame_duration": OPUS_FRAME_DURATION_MS},
+        }
+
+    async def run_session(self):
+        self.reset()
+        sample = {}
+        wake = self.now()
+        connect_ms = await self.connect()
+        if connect_ms is not None:
+            sample["connect_ms"] = connect_ms
+        await self.send_json(self.hello_message(self.transport, self.version))
+        await asyncio.wait_for(self.hello.wait(), self.options.timeout)
+        await self.on_server_hello()
+        sample["channel_open_ms"] = (self.now() - self.open_start) * 1000
+
+        await self.send_json({"session_id": "", "type": "listen", "state": "detect", "text": "你好小智"})
+        await self.send_json({"session_id": "", "type": "listen", "state": "start", "mode": "manual"})
+        start = self.now()
+        uplink_bytes = 0
+        for i, opus in enumerate(self.packets):
+            if not self.options.fast:
+                delay = start + i * OPUS_FRAME_DURATION_MS / 1000 - self.now()
+                if delay > 0:
+                    await asyncio.sleep(delay)
+            await self.send_audio(opus, i + 1)
+            uplink_bytes += len(opus)
+        speech_end = self.now()
+        await self.send_end_of_utterance(len(self.packets) + 1)
+        await self.send_json({"session_id": "", "type": "listen", "state": "stop"})
+        await asyncio.wait_for(self.tts_stopped.wait(), self.options.timeout)
+        end = self.now()
+        await self.close_session()
+
+        if self.first_tts_time is not None:
+            sample["wake_to_first_tts_ms"] = (self.first_tts_time - wake) * 1000
+            sample["speech_end_to_first_tts_ms"] = (self.first_tts_time - speech_end) * 1000
+        # 不按节拍上行时数据只是进了套接字缓冲区，单会话码率没有意义，只看汇总的帧率与处理倍速
+        if not self.options.fast:
+            sample["uplink_kbps"] = uplink_bytes * 8 / max(speech_end - start, 1e-3) / 1000
+            if self.first_tts_time is not None:
+                downlink_s = max(end - self.first_tts_time, 1e-3)
+                sample["downlink_kbps"] = self.downlink_bytes * 8 / downlink_s / 1000
+        audio_s = (len(self.packets) + self.downlink_frames) * OPUS_FRAME_DURATION_MS / 1000
+        sample["realtime_factor"] = audio_s / max(end - wake, 1e-3)
+        sample["uplink_bytes"] = uplink_bytes
+        sample["downlink_frames"] = self.downlink_frames
+        sample["downlink_bytes"] = self.downlink_bytes
+        return sample
+
+
+class WebSocketDevice(EmulatedDevice):
+    transport = "websocket"
+
+    def __init__(self, options, server, packets, index):
+        super().__init__(options, server, packets, index)
+        self.version = options.device_version
+        self.binary_version = 1
+        self.writer = None
+        self.reader_task = None
+
+    async def connect(self):
+        # 与固件一致：每个会话重新建立连接，通道打开时间包含连接与升级
+        self.open_start = self.now()
+        reader, writer = await asyncio.open_connection("127.0.0.1", self.server.port)
+        key = "dGhlIHNhbXBsZSBub25jZQ=="
+        writer.write((f"GET /xiaozhi/v1/ HTTP/1.1\r\nHost: 127.0.0.1:{self.server.port}\r\n"
+                      "Upgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Key: {key}\r\nSec-WebSocket-Version: 13\r\n"
+                      f"Authorization: Bearer {self.options.token}\r\nProtocol-Version: {self.version}\r\n"
+                      f"Device-Id: {self.device_id}\r\nClient-Id: {self.client_id}\r\n\r\n").encode())
+        await writer.drain()
+        status = await reader.readline()
+        if b" 101 " not in status:
+            raise RuntimeError(f"WebSocket upgrade failed: {status!r}")
+        while (await reader.readline()) not in (b"\r\n", b"\n", b""):
+            pass
+        self.reader = reader
+        self.writer = writer
+        self.reader_task = asyncio.ensure_future(self.read_loop())
+        return (self.now() - self.open_start) * 1000
+
+    async def read_loop(self):
+        async def on_control(opcode, payload):
+            if opcode == WS_OPCODE_PING:
+                self.writer.write(ws_encode_frame(WS_OPCODE_PONG, payload, mask=True))
+            return opcode != WS_OPCODE_CLOSE
+
+        try:
+            while True:
+                opcode, payload = await ws_read_message(self.reader, on_control)
+                if opcode is None:
+                    break
+                if opcode == WS_OPCODE_TEXT:
+                    self.on_json(json.loads(payload))
+                elif opcode == WS_OPCODE_BINARY:
+                    if self.binary_version == 4:
+                        payload = payload[BINARY_PROTOCOL4.size:]
+                    self.on_audio(payload)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+
+    async def on_server_hello(self):
+        self.binary_version = 4 if self.version == 4 and self.server_hello.get("version") == 4 else 1
+
+    async def send_json(self, message):
+        self.writer.write(ws_encode_frame(WS_OPCODE_TEXT, json.dumps(message, ensure_ascii=False).encode(),
+                                          mask=True))
+        await self.writer.drain()
+
+    async def send_frame(self, opus, sequence, flags):
+        if self.binary_version == 4:
+            duration = OPUS_FRAME_DURATION_MS if opus else 0
+            timestamp = int(self.now() * 1000) & 0xFFFFFFFF
+            opus = BINARY_PROTOCOL4.pack(4, flags, duration, sequence, timestamp) + opus
+        self.writer.write(ws_encode_frame(WS_OPCODE_BINARY, opus, mask=True))
+        await self.writer.drain()
+
+    async def send_audio(self, opus, sequence):
+        await self.send_frame(opus, sequence, 0)
+
+    async def send_end_of_utterance(self, sequence):
+        if self.binary_version == 4:
+            await self.send_frame(b"", sequence, AUDIO_FRAME_FLAG_END_OF_UTTERANCE)
+
+    async def close_session(self):
+        self.writer.write(ws_encode_frame(WS_OPCODE_CLOSE, struct.pack(">H", 1000), mask=True))
+        await self.writer.drain()
+        try:
+            await asyncio.wait_for(self.reader_task, 2)
+        except asyncio.TimeoutError:
+            self.reader_task.cancel()
+        self.writer.close()
+
+
+class MqttDevice(EmulatedDevice):
+    transport = "udp"
+
+    class _UdpProtocol(asyncio.DatagramProtocol):
+        def __init__(self, device):
+            self.device = device
+
+        def datagram_received(self, data, addr):
+            self.device.on_udp(data)
+
+    def __init__(self, options, server, packets, index):
+        super().__init__(options, server, packets, index)
+        self.version = 3
+        self.reader = None
+        self.writer = None
+        self.reader_task = None
+        self.udp = None
+        self.encrypt_block = None
+        self.nonce = b""
+
+    async def connect(self):
+        # 与固件一致：MQTT 连接常驻，只在首次会话时建立，不计入通道打开时间
+        connect_ms = None
+        if self.writer is None or self.writer.is_closing():
+            start = self.now()
+            context = None
+            if self.server.mqtt_tls:
+                # 测试服务器一般使用自签名证书，模拟设备不校验
+                context = ssl.create_default_context()
+                context.check_hostname = False
+                context.verify_mode = ssl.CERT_NONE
+            self.reader, self.writer = await asyncio.open_connection("127.0.0.1", self.server.mqtt_port, ssl=context)
+            body = (mqtt_encode_string("MQTT") + bytes([4, 0xC2]) + struct.pack(">H", 90) +
+                    mqtt_encode_string(self.client_id) + mqtt_encode_string("test") + mqtt_encode_string("test"))
+            self.writer.write(mqtt_encode_packet(MQTT_CONNECT, 0, body))
+            await self.writer.drain()
+            packet_type, _, body = await mqtt_read_packet(self.reader)
+            if packet_type != 2 or body[1:2] != b"\x00":
+                raise RuntimeError(f"MQTT connect refused: {packet_type} {body!r}")
+            self.reader_task = asyncio.ensure_future(self.read_loop())
+            connect_ms = (self.now() - start) * 1000
+        self.open_start = self.now()
+        return connect_ms
+
+    async def read_loop(self):
+        try:
+            while True:
+                packet_type, flags, body = await mqtt_read_packet(self.reader)
+                if packet_type == MQTT_PUBLISH:
+                    _, _, payload = mqtt_parse_publish(flags, body)
+                    self.on_json(json.loads(payload))
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+
+    async def on_server_hello(self):
+        udp = self.server_hello["udp"]
+        self.encrypt_block = make_block_cipher(bytes.fromhex(udp["key"]))
+        self.nonce = bytes.fromhex(udp["nonce"])
+        self.udp, _ = await self.loop.create_datagram_endpoint(
+            lambda: self._UdpProtocol(self), remote_addr=("127.0.0.1", udp["port"]))
+
+    def on_udp(self, data):
+        if len(data) < UDP_HEADER_SIZE:
+            return
+        header = data[:UDP_HEADER_SIZE]
+        size = struct.unpack_from(">H", header, 2)[0]
+        self.on_audio(aes_ctr(self.encrypt_block, header, data[UDP_HEADER_SIZE:UDP_HEADER_SIZE + size]))
+
+    async def send_json(self, message):
+        payload = json.dumps(message, ensure_ascii=False).encode()
+        self.writer.write(mqtt_encode_packet(MQTT_PUBLISH, 0, mqtt_encode_string("device-server") + payload))
+        await self.writer.drain()
+
+    async def send_audio(self, opus, sequence):
+        header = bytearray(self.nonce)
+        struct.pack_into(">H", header, 2, len(opus))
+        struct.pack_into(">I", header, 12, sequence)
+        self.udp.sendto(bytes(header) + aes_ctr(self.encrypt_block, header, opus))
+
+    async def send_end_of_utterance(self, sequence):
+        pass
+
+    async def close_session(self):
+        await self.send_json({"session_id": self.server_hello.get("session_id", ""), "type": "goodbye"})
+        self.udp.close()
+        self.udp = None
+
+    async def disconnect(self):
+        if self.writer is not None:
+            self.writer.write(mqtt_encode_packet(MQTT_DISCONNECT, 0, b""))
+            await self.writer.drain()
+            self.writer.close()
+            self.reader_task.cancel()
+
+
+async def run_emulator(options, server):
+    packets = load_p3(options.input)
+    if not packets:
+        raise RuntimeError(f"No packets in {options.input}")
+    device_class = WebSocketDevice if options.emulate == "websocket" else MqttDevice
+    samples = []
+
+    async def client(index):
+        device = device_class(options, server, packets, index)
+        for run in range(options.runs):
+            sample = await device.run_session()
+            sample.update({"client": index, "run": run})
+            samples.append(sample)
+            if options.verbose:
+                print(json.dumps(sample, ensure_ascii=False))
+        if isinstance(device, MqttDevice):
+            await device.disconnect()
+
+    start = time.monotonic()
+    await asyncio.gather(*(client(i) for i in range(options.clients)))
+    elapsed = time.monotonic() - start
+    uplink_frames = len(packets) * len(samples)
+    downlink_frames = sum(s["downlink_frames"] for s in samples)
+    extra = {
+        "device": f"emulated {options.emulate} x{options.clients}",
+        "input": f"{options.input} ({len(packets)} frames, {len(packets) * OPUS_FRAME_DURATION_MS} ms)",
+        "sessions": len(samples),
+        "aggregate": f"{uplink_frames / elapsed:.1f} uplink frames/s, {downlink_frames / elapsed:.1f} downlink frames/s "
+                     f"in {elapsed:.1f} s",
+    }
+    return samples, extra
+
+
+async def benchmark(options):
+    server = server_module.TestServer(options)
+    await server.start()
+    try:
+        samples, extra = await run_emulator(options, server)
+    finally:
+        await server.stop()
+        server.recorder.close()
+
+    summary = summarize(samples)
+    print_summary(summary, extra)
+    if options.json:
+        with open(options.json, "w", encoding="utf-8") as f:
+            json.dump({"info": extra, "summary": summary, "samples": samples}, f, ensure_ascii=False, indent=2)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="小智协议端到端对话基准测试")
+    parser.add_argument("--emulate", required=True, choices=["websocket", "mqtt"], help="模拟设备使用的连接方式")
+    parser.add_argument("--runs", type=int, default=5, help="每个设备的会话次数")
+    parser.add_argument("--clients", type=int, default=1, help="并发的模拟设备数")
+    parser.add_argument("--input", default=DEFAULT_INPUT, help="模拟设备上行的 P3 文件")
+    parser.add_argument("--device-version", type=int, default=4, choices=[1, 4],
+                        help="模拟设备在 hello 中声明的 WebSocket 二进制帧版本")
+    parser.add_argument("--fast", action="store_true", help="不按实时节拍上行")
+    parser.add_argument("--timeout", type=float, default=120, help="单次会话的超时秒数")
+    parser.add_argument("--json", default="", help="把样本与统计结果写入 JSON 文件")
+    parser.add_argument("--verbose", action="store_true", help="打印服务端事件与每个样本")
+    server_module.add_server_arguments(parser)
+    options = server_module.normalize_options(parser.parse_args())
+    options.quiet = not options.verbose
+    if options.emulate == "mqtt" and options.mqtt_port is None:
+        parser.error("--emulate mqtt requires the MQTT port")
+    asyncio.run(benchmark(options))
+
+
+if __name__ == "__main__":
+    sys.exit(main())
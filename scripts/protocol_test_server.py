@@ -0,0 +1,930 @@
+#! /usr/bin/env python3
+"""
+本地协议测试服务器，代替生产后端测试 docs/websocket.md 中的 WebSocket 协议与 MQTT+UDP 协议。
+只依赖 Python 标准库；安装了 pycryptodome 或 cryptography 时用它们做 AES，否则使用内置的纯 Python 实现。
+
+同一个 HTTP 端口提供：
+  - OTA 检查接口（路径中包含 /ota）：回显设备当前版本（不触发升级），下发服务器时间，
+    开启 MQTT 端口时同时下发指向本服务器的 MQTT 配置
+  - WebSocket 接口（其它路径上的 Upgrade 请求）：hello 协商（包括 v4 二进制帧头）与音频收发
+另有一个最小实现的 MQTT 3.1.1 端口（只服务于连接上来的设备，不做主题路由，指定证书时为 TLS）
+和一个 UDP 音频端口（AES-128-CTR）。
+
+每一轮对话：设备 listen start 后收集上行 Opus，收到结束标记（v4 空帧、listen stop/silence）、
+上行静默超过 --turn-idle-ms 或累计超过 --max-turn-ms 时结束本轮，依次下发 stt、llm、iot（可选）、
+tts start/sentence_start、按帧时长节拍推送的 Opus（回放本轮上行，或 --tts-file 指定的 P3 文件）和 tts stop。
+所有事件带时间戳写入 --record 指定的 JSON Lines 文件，protocol_benchmark.py 据此统计时延与吞吐。
+
+用法：
+    python scripts/protocol_test_server.py --port 8000 --udp-port 8884 --record events.jsonl
+
+固件在 menuconfig 中配置：
+    OTA Version URL = http://<本机地址>:8000/xiaozhi/ota/
+    Websocket URL   = ws://<本机地址>:8000/xiaozhi/v1/
+MQTT+UDP 方式下 endpoint 由 OTA 接口下发为本机地址（不带端口），固件固定以 TLS 连接 8883 端口，
+所以 MQTT 端口保持默认的 8883，并用 --mqtt-certfile/--mqtt-keyfile 提供设备信任的证书。
+"""
+import argparse
+import asyncio
+import base64
+import datetime
+import hashlib
+import json
+import os
+import secrets
+import ssl
+import struct
+import sys
+import time
+
+OPUS_FRAME_DURATION_MS = 60
+SAMPLE_RATE = 16000
+
+WS_GUID = "258EAFA5-E914-47DA-95CA-C5AB0DC85B11"
+WS_OPCODE_CONTINUATION = 0x0
+WS_OPCODE_TEXT = 0x1
+WS_OPCODE_BINARY = 0x2
+WS_OPCODE_CLOSE = 0x8
+WS_OPCODE_PING = 0x9
+WS_OPCODE_PONG = 0xA
+
+# v4 二进制帧头：version, flags, duration(ms), sequence, timestamp(ms)，网络字节序
+BINARY_PROTOCOL4 = struct.Struct(">BBHII")
+AUDIO_FRAME_FLAG_END_OF_UTTERANCE = 0x01
+
+UDP_HEADER_SIZE = 16
+UDP_PACKET_TYPE_AUDIO = 0x01
+
+MQTT_CONNECT = 1
+MQTT_PUBLISH = 3
+MQTT_PUBACK = 4
+MQTT_SUBSCRIBE = 8
+MQTT_UNSUBSCRIBE = 10
+MQTT_PINGREQ = 12
+MQTT_DISCONNECT = 14
+
+
+# ---- AES-128-CTR ----
+
+def _rotl8(x, shift):
+    return ((x << shift) | (x >> (8 - shift))) & 0xFF
+
+
+def _xtime(a):
+    return ((a << 1) ^ 0x1B) & 0xFF if a & 0x80 else a << 1
+
+
+def _build_sbox():
+    """按 GF(2^8) 求逆加仿射变换生成 AES 的 S 盒"""
+    sbox = [0] * 256
+    p = q = 1
+    while True:
+        p = p ^ ((p << 1) & 0xFF) ^ (0x1B if p & 0x80 else 0)
+        q ^= q << 1
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        sbox[p] = q ^ _rotl8(q, 1) ^ _rotl8(q, 2) ^ _rotl8(q, 3) ^ _rotl8(q, 4) ^ 0x63
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    return sbox
+
+
+_SBOX = _build_sbox()
+
+
+class _PyAes128:
+    """纯 Python 的 AES-128 加密方向，CTR 模式只需要这一半"""
+
+    def __init__(self, key):
+        round_keys = list(key)
+        rcon = 1
+        for i in range(16, 176, 4):
+            word = round_keys[i - 4:i]
+            if i % 16 == 0:
+                word = [_SBOX[word[1]] ^ rcon, _SBOX[word[2]], _SBOX[word[3]], _SBOX[word[0]]]
+                rcon = _xtime(rcon)
+            round_keys += [round_keys[i - 16 + j] ^ word[j] for j in range(4)]
+        self.round_keys = round_keys
+
+    def encrypt_block(self, block):
+        state = [b ^ k for b, k in zip(block, self.round_keys[:16])]
+        for r in range(1, 11):
+            state = [_SBOX[b] for b in state]
+            # 行移位：状态按列存放，第 r 行左移 r 个位置
+            state = [state[(i + 4 * (i % 4)) % 16] for i in range(16)]
+            if r != 10:
+                mixed = []
+                for c in range(0, 16, 4):
+                    a = state[c:c + 4]
+                    t = a[0] ^ a[1] ^ a[2] ^ a[3]
+                    mixed += [a[j] ^ t ^ _xtime(a[j] ^ a[(j + 1) % 4]) for j in range(4)]
+                state = mixed
+            round_key = self.round_keys[16 * r:16 * r + 16]
+            state = [b ^ k for b, k in zip(state, round_key)]
+        return bytes(state)
+
+
+def make_block_cipher(key):
+    """返回 AES-128 单块加密函数，优先使用已安装的加密库"""
+    try:
+        from Crypto.Cipher import AES
+        return AES.new(key, AES.MODE_ECB).encrypt
+    except ImportError:
+        pass
+    try:
+        from cryptography.hazmat.primitives.ciphers import Cipher, algorithms, modes
+        return Cipher(algorithms.AES(key), modes.ECB()).encryptor().update
+    except ImportError:
+        pass
+    return _PyAes128(key).encrypt_block
+
+
+def aes_ctr(encrypt_block, counter, data):
+    """与 mbedtls_aes_crypt_ctr 相同：128 位计数器按大端整体加一，加密解密相同"""
+    value = int.from_bytes(counter, "big")
+    out = bytearray(data)
+    for offset in range(0, len(out), 16):
+        stream = encrypt_block(value.to_bytes(16, "big"))
+        for i in range(min(16, len(out) - offset)):
+            out[offset + i] ^= stream[i]
+        value = (value + 1) & ((1 << 128) - 1)
+    return bytes(out)
+
+
+# ---- 公共编解码 ----
+
+def load_p3(path):
+    """读取 P3 文件：[1 字节类型, 1 字节保留, 2 字节长度, Opus 数据] 的序列"""
+    packets = []
+    with open(path, "rb") as f:
+        while True:
+            header = f.read(4)
+            if len(header) < 4:
+                break
+            _, _, size = struct.unpack(">BBH", header)
+            data = f.read(size)
+            if len(data) < size:
+                break
+            packets.append(data)
+    return packets
+
+
+async def ws_read_frame(reader):
+    """读取一个 WebSocket 帧，返回 (fin, opcode, payload)，自动去掉掩码"""
+    b0, b1 = await reader.readexactly(2)
+    length = b1 & 0x7F
+    if length == 126:
+        length = struct.unpack(">H", await reader.readexactly(2))[0]
+    elif length == 127:
+        length = struct.unpack(">Q", await reader.readexactly(8))[0]
+    mask = await reader.readexactly(4) if b1 & 0x80 else None
+    payload = await reader.readexactly(length)
+    if mask:
+        key = int.from_bytes((mask * (length // 4 + 1))[:length], "big")
+        payload = (int.from_bytes(payload, "big") ^ key).to_bytes(length, "big")
+    return bool(b0 & 0x80), b0 & 0x0F, payload
+
+
+async def ws_read_message(reader, on_control):
+    """读取一条完整消息（合并分片），控制帧交给 on_control 处理；连接关闭时返回 (None, None)"""
+    opcode = None
+    chunks = []
+    while True:
+        fin, frame_opcode, payload = await ws_read_frame(reader)
+        if frame_opcode >= WS_OPCODE_CLOSE:
+            if not await on_control(frame_opcode, payload):
+                return None, None
+            continue
+        if frame_opcode != WS_OPCODE_CONTINUATION:
+            opcode = frame_opcode
+            chunks = []
+        chunks.append(payload)
+        if fin:
+            return opcode, b"".join(chunks)
+
+
+def ws_encode_frame(opcode, payload, mask=False):
+    """编码一个不分片的帧，客户端发送时需要加掩码"""
+    header = bytearray([0x80 | opcode])
+    mask_bit = 0x80 if mask else 0
+    length = len(payload)
+    if length < 126:
+        header.append(mask_bit | length)
+    elif length < 65536:
+        header.append(mask_bit | 126)
+        header += struct.pack(">H", length)
+    else:
+        header.append(mask_bit | 127)
+        header += struct.pack(">Q", length)
+    if mask:
+        key = os.urandom(4)
+        header += key
+        if length:
+            stream = int.from_bytes((key * (length // 4 + 1))[:length], "big")
+            payload = (int.from_bytes(payload, "big") ^ stream).to_bytes(length, "big")
+    return bytes(header) + payload
+
+
+def ws_accept_key(key):
+    return base64.b64encode(hashlib.sha1((key + WS_GUID).encode()).digest()).decode()
+
+
+def mqtt_encode_length(length):
+    out = bytearray()
+    while True:
+        byte = length % 128
+        length //= 128
+        out.append(byte | 0x80 if length else byte)
+        if not length:
+            return bytes(out)
+
+
+def mqtt_encode_string(text):
+    data = text.encode() if isinstance(text, str) else text
+    return struct.pack(">H", len(data)) + data
+
+
+def mqtt_encode_packet(packet_type, flags, body):
+    return bytes([packet_type << 4 | flags]) + mqtt_encode_length(len(body)) + body
+
+
+async def mqtt_read_packet(reader):
+    """读取一个 MQTT 控制报文，返回 (type, flags, body)"""
+    first = (await reader.readexactly(1))[0]
+    length = 0
+    multiplier = 1
+    while True:
+        byte = (await reader.readexactly(1))[0]
+        length += (byte & 0x7F) * multiplier
+        multiplier *= 128
+        if not byte & 0x80:
+            break
+    body = await reader.readexactly(length) if length else b""
+    return first >> 4, first & 0x0F, body
+
+
+def mqtt_parse_publish(flags, body):
+    """解析 PUBLISH 报文体，返回 (topic, packet_id, payload)，QoS 0 时 packet_id 为 None"""
+    topic_length = struct.unpack(">H", body[:2])[0]
+    topic = body[2:2 + topic_length].decode()
+    offset = 2 + topic_length
+    packet_id = None
+    if (flags >> 1) & 0x03:
+        packet_id = body[offset:offset + 2]
+        offset += 2
+    return topic, packet_id, body[offset:]
+
+
+# ---- 事件记录 ----
+
+class Recorder:
+    """以服务器启动时刻为零点的毫秒时间戳记录事件，可同时写入 JSON Lines 文件"""
+
+    def __init__(self, path=None, quiet=False):
+        self.start = time.monotonic()
+        self.events = []
+        self.listeners = []
+        self.quiet = quiet
+        self.file = open(path, "a", encoding="utf-8") if path else None
+
+    def now_ms(self):
+        return (time.monotonic() - self.start) * 1000
+
+    def record(self, session, transport, event, **fields):
+        entry = {"t": round(self.now_ms(), 3), "session": session, "transport": transport, "event": event}
+        entry.update(fields)
+        self.events.append(entry)
+        if self.file:
+            self.file.write(json.dumps(entry, ensure_ascii=False) + "\n")
+            self.file.flush()
+        if not self.quiet:
+            extra = " ".join(f"{k}={v}" for k, v in fields.items() if k != "stages")
+            print(f"[{entry['t']:10.1f}] {transport:9s} {session or '-':16s} {event} {extra}", flush=True)
+        for listener in self.listeners:
+            listener(entry)
+
+    def close(self):
+        if self.file:
+            self.file.close()
+            self.file = None
+
+
+# ---- 会话逻辑 ----
+
+class Session:
+    """与传输方式无关的一次音频会话：收集上行、判定一轮结束并下发回复，子类实现具体的收发"""
+
+    transport = ""
+    # listen stop 之后仍然接受上行音频的时长，音频与控制消息不在同一条有序通道上时使用
+    stop_grace_ms = 0
+
+    def __init__(self, server):
+        self.server = server
+        self.options = server.options
+        self.id = ""
+        self.listening = False
+        self.mode = ""
+        self.stop_time = 0
+        self.turn = []
+        self.turn_start = 0
+        self.last_audio = 0
+        self.turns = 0
+        self.abort = False
+        self.reply_task = None
+        self.poll_task = None
+        self.uplink_frames = 0
+        self.uplink_bytes = 0
+        self.uplink_dropped = 0
+        self.downlink_frames = 0
+        self.downlink_bytes = 0
+
+    def record(self, event, **fields):
+        self.server.recorder.record(self.id, self.transport, event, **fields)
+
+    def begin(self):
+        """收到 hello 后开始新的会话"""
+        self.end()
+        self.id = secrets.token_hex(8)
+        self.listening = False
+        self.turn = []
+        self.turns = 0
+        self.uplink_frames = self.uplink_bytes = self.uplink_dropped = 0
+        self.downlink_frames = self.downlink_bytes = 0
+        self.poll_task = asyncio.ensure_future(self.poll_loop())
+
+    def end(self):
+        if self.poll_task:
+            self.poll_task.cancel()
+            self.poll_task = None
+        if self.reply_task and not self.reply_task.done():
+            self.abort = True
+        if self.id:
+            self.record("session_end", uplink_frames=self.uplink_frames, uplink_bytes=self.uplink_bytes,
+                        uplink_dropped=self.uplink_dropped, downlink_frames=self.downlink_frames,
+                        downlink_bytes=self.downlink_bytes, turns=self.turns)
+            self.id = ""
+
+    def speaking(self):
+        return self.reply_task is not None and not self.reply_task.done()
+
+    async def handle_json(self, message):
+        kind = message.get("type")
+        state = message.get("state")
+        if kind == "hello":
+            await self.on_hello(message)
+        elif not self.id:
+            self.record("message_without_session", type=kind)
+        elif kind == "listen":
+            if state == "start":
+                self.listening = True
+                self.mode = message.get("mode", "")
+                self.record("listen_start", mode=self.mode)
+            elif state == "detect":
+                self.record("wake_word", text=message.get("text", ""))
+            elif state == "stop":
+                self.listening = False
+                self.stop_time = self.server.recorder.now_ms()
+                self.record("listen_stop")
+                if self.stop_grace_ms > 0:
+                    asyncio.get_running_loop().call_later(self.stop_grace_ms / 1000, self.end_turn, "listen_stop")
+                else:
+                    self.end_turn("listen_stop")
+            elif state == "silence":
+                self.record("silence")
+                self.end_turn("silence")
+        elif kind == "abort":
+            self.record("abort", reason=message.get("reason", ""))
+            self.abort = True
+        elif kind == "iot":
+            self.record("iot", descriptors="descriptors" in message, states="states" in message)
+        elif kind == "latency":
+            self.record("device_latency", stages=message.get("stages"))
+        elif kind == "goodbye":
+            self.record("goodbye")
+            await self.on_goodbye()
+        else:
+            self.record("message", type=kind)
+
+    def on_audio(self, opus):
+        self.uplink_frames += 1
+        self.uplink_bytes += len(opus)
+        # 播放期间（非实时模式）设备不应上行，收到的数据计为丢弃
+        now = self.server.recorder.now_ms()
+        listening = self.listening or now - self.stop_time < self.stop_grace_ms
+        if not listening or (self.speaking() and self.mode != "realtime"):
+            self.uplink_dropped += 1
+            return
+        if not self.turn:
+            self.turn_start = now
+            self.record("first_uplink_audio")
+        self.turn.append(opus)
+        self.last_audio = now
+
+    def on_end_of_utterance(self):
+        self.record("end_of_utterance")
+        self.end_turn("end_of_utterance")
+
+    async def poll_loop(self):
+        while True:
+            await asyncio.sleep(0.02)
+            if not self.turn:
+                continue
+            now = self.server.recorder.now_ms()
+            if now - self.last_audio >= self.options.turn_idle_ms:
+                self.end_turn("idle")
+            elif len(self.turn) * OPUS_FRAME_DURATION_MS >= self.options.max_turn_ms:
+                self.end_turn("max_turn")
+
+    def end_turn(self, reason):
+        if not self.turn or self.speaking():
+            return
+        packets = self.turn
+        self.turn = []
+        self.record("turn_end", reason=reason, frames=len(packets),
+                    last_uplink_t=round(self.last_audio, 3))
+        self.reply_task = asyncio.ensure_future(self.reply(packets))
+
+    async def reply(self, packets):
+        options = self.options
+        self.turns += 1
+        self.abort = False
+        if options.reply_delay_ms > 0:
+            await asyncio.sleep(options.reply_delay_ms / 1000)
+        await self.send_json({"session_id": self.id, "type": "stt",
+                              "text": options.stt_text or f"上行 {len(packets)} 帧"})
+        self.record("stt")
+        await self.send_json({"session_id": self.id, "type": "llm", "text": "😀", "emotion": options.emotion})
+        for commands in options.iot_commands:
+            await self.send_json({"session_id": self.id, "type": "iot", "commands": commands})
+            self.record("iot_command", commands=len(commands))
+
+        tts = self.server.tts_packets or packets
+        await self.send_json({"session_id": self.id, "type": "tts", "state": "start"})
+        self.record("tts_start")
+        await self.send_json({"session_id": self.id, "type": "tts", "state": "sentence_start",
+                              "text": options.tts_text})
+        loop = asyncio.get_running_loop()
+        start = loop.time()
+        sent = 0
+        for i, opus in enumerate(tts):
+            if self.abort:
+                break
+            if options.tts_rate > 0:
+                delay = start + i * OPUS_FRAME_DURATION_MS / 1000 / options.tts_rate - loop.time()
+                if delay > 0:
+                    await asyncio.sleep(delay)
+            render_ms = self.server.recorder.now_ms() + options.tts_render_delay_ms
+            if not await self.send_audio(opus, render_ms):
+                break
+            if sent == 0:
+                self.record("first_tts_frame")
+            sent += 1
+            self.downlink_frames += 1
+            self.downlink_bytes += len(opus)
+        await self.send_end_of_stream()
+        await self.send_json({"session_id": self.id, "type": "tts", "state": "stop"})
+        self.record("tts_stop", frames=sent, aborted=self.abort)
+        if options.query_latency:
+            await self.send_json({"type": "latency", "reset": True})
+        if options.goodbye_after and self.turns >= options.goodbye_after:
+            await self.send_json({"session_id": self.id, "type": "goodbye"})
+            self.record("server_goodbye")
+            self.end()
+
+    async def on_hello(self, message):
+        raise NotImplementedError
+
+    async def on_goodbye(self):
+        self.end()
+
+    async def send_json(self, message):
+        raise NotImplementedError
+
+    async def send_audio(self, opus, render_ms):
+        raise NotImplementedError
+
+    async def send_end_of_stream(self):
+        pass
+
+
+class WebSocketSession(Session):
+    """一个 WebSocket 连接；保温模式下同一连接上可以有多次 hello/goodbye"""
+
+    transport = "websocket"
+
+    def __init__(self, server, reader, writer, headers):
+        super().__init__(server)
+        self.reader = reader
+        self.writer = writer
+        self.headers = headers
+        self.binary_version = 1
+        self.uplink_sequence = 0
+        self.uplink_lost = 0
+        self.downlink_sequence = 0
+
+    def write(self, opcode, payload):
+        if self.writer.is_closing():
+            return False
+        self.writer.write(ws_encode_frame(opcode, payload))
+        return True
+
+    async def send_json(self, message):
+        self.write(WS_OPCODE_TEXT, json.dumps(message, ensure_ascii=False).encode())
+        await self.writer.drain()
+
+    async def send_audio(self, opus, render_ms):
+        if self.binary_version == 4:
+            self.downlink_sequence += 1
+            header = BINARY_PROTOCOL4.pack(4, 0, OPUS_FRAME_DURATION_MS, self.downlink_sequence,
+                                           int(render_ms) & 0xFFFFFFFF or 1)
+            opus = header + opus
+        if not self.write(WS_OPCODE_BINARY, opus):
+            return False
+        await self.writer.drain()
+        return True
+
+    async def send_end_of_stream(self):
+        if self.binary_version == 4:
+            self.downlink_sequence += 1
+            self.write(WS_OPCODE_BINARY, BINARY_PROTOCOL4.pack(4, AUDIO_FRAME_FLAG_END_OF_UTTERANCE, 0,
+                                                                self.downlink_sequence, 0))
+            await self.writer.drain()
+
+    async def on_hello(self, message):
+        self.begin()
+        requested = message.get("version", 1)
+        self.binary_version = 4 if requested == 4 and self.options.binary_version >= 4 else 1
+        self.uplink_sequence = 0
+        self.uplink_lost = 0
+        self.downlink_sequence = 0
+        self.record("hello", version=requested, negotiated=self.binary_version,
+                    header_version=self.headers.get("protocol-version", ""))
+        await self.send_json({
+            "type": "hello",
+            "transport": "websocket",
+            "session_id": self.id,
+            "version": self.binary_version,
+            "audio_params": {"format": "opus", "sample_rate": self.options.sample_rate,
+                             "channels": 1, "frame_duration": OPUS_FRAME_DURATION_MS},
+        })
+        self.record("hello_reply")
+
+    def on_binary(self, data):
+        if not self.id:
+            return
+        if self.binary_version != 4:
+            self.on_audio(data)
+            return
+        if len(data) < BINARY_PROTOCOL4.size or data[0] != 4:
+            self.record("invalid_frame", size=len(data))
+            return
+        _, flags, _, sequence, _ = BINARY_PROTOCOL4.unpack_from(data)
+        if self.uplink_sequence and sequence - self.uplink_sequence > 1:
+            self.uplink_lost += sequence - self.uplink_sequence - 1
+        self.uplink_sequence = sequence
+        payload = data[BINARY_PROTOCOL4.size:]
+        if payload:
+            self.on_audio(payload)
+        elif flags & AUDIO_FRAME_FLAG_END_OF_UTTERANCE:
+            self.on_end_of_utterance()
+
+    async def on_control(self, opcode, payload):
+        if opcode == WS_OPCODE_PING:
+            self.write(WS_OPCODE_PONG, payload)
+            return True
+        if opcode == WS_OPCODE_CLOSE:
+            self.write(WS_OPCODE_CLOSE, payload[:2])
+            return False
+        return True
+
+    async def run(self):
+        try:
+            while True:
+                opcode, payload = await ws_read_message(self.reader, self.on_control)
+                if opcode is None:
+                    break
+                if opcode == WS_OPCODE_TEXT:
+                    await self.handle_json(json.loads(payload))
+                elif opcode == WS_OPCODE_BINARY:
+                    self.on_binary(payload)
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            if self.uplink_lost:
+                self.record("uplink_lost", frames=self.uplink_lost)
+            self.end()
+
+
+class MqttSession(Session):
+    """一个 MQTT 连接：控制消息走 MQTT，音频走 UDP，每次 hello 分配新的 AES 密钥与 nonce"""
+
+    transport = "mqtt-udp"
+
+    def __init__(self, server, reader, writer):
+        super().__init__(server)
+        self.reader = reader
+        self.writer = writer
+        # UDP 音频与 MQTT 上的 listen stop 没有先后保证
+        self.stop_grace_ms = self.options.udp_stop_grace_ms
+        self.client_id = ""
+        self.ssrc = b""
+        self.encrypt_block = None
+        self.nonce = b""
+        self.remote_addr = None
+        self.remote_sequence = 0
+        self.uplink_lost = 0
+        self.local_sequence = 0
+
+    async def send_json(self, message):
+        if self.writer.is_closing():
+            return
+        payload = json.dumps(message, ensure_ascii=False).encode()
+        topic = f"devices/p2p/{self.client_id}"
+        self.writer.write(mqtt_encode_packet(MQTT_PUBLISH, 0, mqtt_encode_string(topic) + payload))
+        await self.writer.drain()
+
+    async def send_audio(self, opus, render_ms):
+        if self.remote_addr is None:
+            # 设备还没有发过 UDP 包，不知道它的地址
+            self.record("udp_peer_unknown")
+            return False
+        self.local_sequence += 1
+        header = bytearray(self.nonce)
+        struct.pack_into(">H", header, 2, len(opus))
+        struct.pack_into(">I", header, 8, int(render_ms) & 0xFFFFFFFF)
+        struct.pack_into(">I", header, 12, self.local_sequence)
+        packet = bytes(header) + aes_ctr(self.encrypt_block, header, opus)
+        self.server.udp_transport.sendto(packet, self.remote_addr)
+        return True
+
+    async def on_hello(self, message):
+        self.begin()
+        key = os.urandom(16)
+        self.encrypt_block = make_block_cipher(key)
+        # nonce：类型、保留、长度占位、4 字节会话标识（服务端据此找到会话）、时间戳与序号占位
+        self.ssrc = os.urandom(4)
+        self.nonce = bytes([UDP_PACKET_TYPE_AUDIO, 0, 0, 0]) + self.ssrc + bytes(8)
+        self.remote_addr = None
+        self.remote_sequence = 0
+        self.uplink_lost = 0
+        self.local_sequence = 0
+        self.server.udp_sessions[self.ssrc] = self
+        self.record("hello", version=message.get("version", 1), client_id=self.client_id)
+        host = self.writer.get_extra_info("sockname")[0]
+        await self.send_json({
+            "type": "hello",
+            "transport": "udp",
+            "session_id": self.id,
+            "audio_params": {"format": "opus", "sample_rate": self.options.sample_rate,
+                             "channels": 1, "frame_duration": OPUS_FRAME_DURATION_MS},
+            "udp": {"server": self.options.advertise or host, "port": self.server.udp_port,
+                    "key": key.hex(), "nonce": self.nonce.hex()},
+        })
+        self.record("hello_reply")
+
+    def end(self):
+        if self.ssrc:
+            self.server.udp_sessions.pop(self.ssrc, None)
+            self.ssrc = b""
+        if self.uplink_lost:
+            self.record("uplink_lost", frames=self.uplink_lost)
+            self.uplink_lost = 0
+        super().end()
+
+    def on_udp(self, data, addr):
+        self.remote_addr = addr
+        header = data[:UDP_HEADER_SIZE]
+        size = struct.unpack_from(">H", header, 2)[0]
+        sequence = struct.unpack_from(">I", header, 12)[0]
+        if self.remote_sequence and sequence - self.remote_sequence > 1:
+            self.uplink_lost += sequence - self.remote_sequence - 1
+        self.remote_sequence = max(self.remote_sequence, sequence)
+        payload = data[UDP_HEADER_SIZE:UDP_HEADER_SIZE + size]
+        self.on_audio(aes_ctr(self.encrypt_block, header, payload))
+
+    async def run(self):
+        try:
+            while True:
+                packet_type, flags, body = await mqtt_read_packet(self.reader)
+                if packet_type == MQTT_CONNECT:
+                    # 协议名、级别、连接标志、保活时间之后是客户端 ID
+                    offset = 2 + struct.unpack(">H", body[:2])[0] + 4
+                    length = struct.unpack(">H", body[offset:offset + 2])[0]
+                    self.client_id = body[offset + 2:offset + 2 + length].decode()
+                    self.server.recorder.record("", self.transport, "mqtt_connect", client_id=self.client_id)
+                    self.writer.write(mqtt_encode_packet(2, 0, b"\x00\x00"))
+                elif packet_type == MQTT_PUBLISH:
+                    _, packet_id, payload = mqtt_parse_publish(flags, body)
+                    if packet_id is not None:
+                        self.writer.write(mqtt_encode_packet(MQTT_PUBACK, 0, packet_id))
+                    await self.handle_json(json.loads(payload))
+                elif packet_type == MQTT_SUBSCRIBE:
+                    self.writer.write(mqtt_encode_packet(9, 0, body[:2] + b"\x00"))
+                elif packet_type == MQTT_UNSUBSCRIBE:
+                    self.writer.write(mqtt_encode_packet(11, 0, body[:2]))
+                elif packet_type == MQTT_PINGREQ:
+                    self.writer.write(mqtt_encode_packet(13, 0, b""))
+                elif packet_type == MQTT_DISCONNECT:
+                    break
+                await self.writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            self.end()
+            self.server.recorder.record("", self.transport, "mqtt_disconnect", client_id=self.client_id)
+            self.writer.close()
+
+
+class UdpAudioProtocol(asyncio.DatagramProtocol):
+    def __init__(self, server):
+        self.server = server
+
+    def datagram_received(self, data, addr):
+        if len(data) < UDP_HEADER_SIZE or data[0] != UDP_PACKET_TYPE_AUDIO:
+            return
+        session = self.server.udp_sessions.get(bytes(data[4:8]))
+        if session is not None:
+            session.on_udp(data, addr)
+
+
+class TestServer:
+    def __init__(self, options, recorder=None):
+        self.options = options
+        self.recorder = recorder or Recorder(options.record, options.quiet)
+        self.tts_packets = load_p3(options.tts_file) if options.tts_file else []
+        self.udp_sessions = {}
+        self.udp_transport = None
+        self.servers = []
+        self.port = options.port
+        self.mqtt_port = options.mqtt_port
+        self.mqtt_tls = False
+        self.udp_port = options.udp_port
+
+    async def start(self):
+        options = self.options
+        http = await asyncio.start_server(self.handle_http, options.host, options.port)
+        self.port = http.sockets[0].getsockname()[1]
+        self.servers.append(http)
+        if options.mqtt_port is not None:
+            loop = asyncio.get_running_loop()
+            self.udp_transport, _ = await loop.create_datagram_endpoint(
+                lambda: UdpAudioProtocol(self), local_addr=(options.host, options.udp_port))
+            self.udp_port = self.udp_transport.get_extra_info("sockname")[1]
+            context = None
+            if options.mqtt_certfile:
+                context = ssl.create_default_context(ssl.Purpose.CLIENT_AUTH)
+                context.load_cert_chain(options.mqtt_certfile, options.mqtt_keyfile or None)
+                self.mqtt_tls = True
+            mqtt = await asyncio.start_server(self.handle_mqtt, options.host, options.mqtt_port, ssl=context)
+            self.mqtt_port = mqtt.sockets[0].getsockname()[1]
+            self.servers.append(mqtt)
+        self.recorder.record("", "server", "listening", http_port=self.port, mqtt_port=self.mqtt_port,
+                             mqtt_tls=self.mqtt_tls, udp_port=self.udp_port, tts_frames=len(self.tts_packets))
+
+    async def stop(self):
+        for server in self.servers:
+            server.close()
+            await server.wait_closed()
+        if self.udp_transport:
+            self.udp_transport.close()
+
+    async def handle_mqtt(self, reader, writer):
+        await MqttSession(self, reader, writer).run()
+
+    async def handle_http(self, reader, writer):
+        try:
+            request = (await reader.readline()).decode().split()
+            headers = {}
+            while True:
+                line = (await reader.readline()).decode()
+                if line in ("\r\n", "\n", ""):
+                    break
+                name, _, value = line.partition(":")
+                headers[name.strip().lower()] = value.strip()
+            if len(request) < 2:
+                return
+            method, path = request[0], request[1]
+            if headers.get("upgrade", "").lower() == "websocket":
+                await self.handle_websocket(reader, writer, path, headers)
+            elif "/ota" in path:
+                body = await reader.readexactly(int(headers.get("content-length", "0")))
+                self.respond(writer, 200, self.ota_response(writer, headers, body))
+            else:
+                self.respond(writer, 404, {"error": f"{method} {path} not found"})
+            await writer.drain()
+        except (asyncio.IncompleteReadError, ConnectionError):
+            pass
+        finally:
+            writer.close()
+
+    def respond(self, writer, status, body):
+        data = json.dumps(body, ensure_ascii=False).encode()
+        reason = "OK" if status == 200 else "Error"
+        writer.write(f"HTTP/1.1 {status} {reason}\r\nContent-Type: application/json\r\n"
+                     f"Content-Length: {len(data)}\r\nConnection: close\r\n\r\n".encode() + data)
+
+    def ota_response(self, writer, headers, body):
+        # User-Agent 为 "板子名/版本"，回显当前版本，设备不会尝试升级
+        version = headers.get("user-agent", "").rpartition("/")[2] or "0.0.0"
+        offset = datetime.datetime.now().astimezone().utcoffset()
+        response = {
+            "firmware": {"version": version, "url": ""},
+            "server_time": {"timestamp": int(time.time() * 1000),
+                            "timezone_offset": int(offset.total_seconds() // 60)},
+        }
+        device_id = headers.get("device-id", "")
+        if self.mqtt_port is not None:
+            host = self.options.advertise or writer.get_extra_info("sockname")[0]
+            response["mqtt"] = {
+                "endpoint": host,
+                "client_id": f"GID_test@@@{device_id.replace(':', '_')}@@@{headers.get('client-id', '')}",
+                "username": "test",
+                "password": "test",
+                "publish_topic": "device-server",
+            }
+        self.recorder.record("", "http", "ota_check", device_id=device_id, version=version,
+                             request_bytes=len(body))
+        return response
+
+    async def handle_websocket(self, reader, writer, path, headers):
+        token = self.options.token
+        if token and headers.get("authorization", "") != f"Bearer {token}":
+            self.respond(writer, 401, {"error": "invalid token"})
+            self.recorder.record("", "websocket", "unauthorized", path=path)
+            return
+        accept = ws_accept_key(headers.get("sec-websocket-key", ""))
+        writer.write(("HTTP/1.1 101 Switching Protocols\r\nUpgrade: websocket\r\nConnection: Upgrade\r\n"
+                      f"Sec-WebSocket-Accept: {accept}\r\n\r\n").encode())
+        await writer.drain()
+        self.recorder.record("", "websocket", "connect", path=path, device_id=headers.get("device-id", ""),
+                             protocol_version=headers.get("protocol-version", ""))
+        await WebSocketSession(self, reader, writer, headers).run()
+        self.recorder.record("", "websocket", "disconnect", device_id=headers.get("device-id", ""))
+
+
+def add_server_arguments(parser):
+    """服务器参数，protocol_benchmark.py 复用同一组参数"""
+    group = parser.add_argument_group("测试服务器")
+    group.add_argument("--host", default="0.0.0.0", help="监听地址")
+    group.add_argument("--port", type=int, default=8000, help="HTTP（OTA）与 WebSocket 端口")
+    group.add_argument("--mqtt-port", type=int, default=8883,
+                       help="MQTT 端口，设为 -1 关闭 MQTT+UDP；固件固定连接 8883，其它端口只适用于模拟设备")
+    group.add_argument("--mqtt-certfile", default="", help="MQTT 端口的 TLS 证书（PEM），为空时使用明文 MQTT")
+    group.add_argument("--mqtt-keyfile", default="", help="证书对应的私钥，为空时从证书文件中读取")
+    group.add_argument("--udp-port", type=int, default=8884, help="UDP 音频端口")
+    group.add_argument("--advertise", default="", help="下发给设备的服务器地址，默认为设备连接上来的本机地址")
+    group.add_argument("--token", default="", help="校验 WebSocket 的 Authorization: Bearer <token>，为空不校验")
+    group.add_argument("--binary-version", type=int, default=4, choices=[1, 4],
+                       help="WebSocket 二进制帧格式的最高版本，1 表示不接受 v4 帧头")
+    group.add_argument("--sample-rate", type=int, default=SAMPLE_RATE, help="hello 中下发的下行采样率")
+    group.add_argument("--tts-file", default="", help="用 P3 文件作为 TTS 音频，默认回放本轮的上行音频")
+    group.add_argument("--tts-rate", type=float, default=1.0, help="下行推流速度倍数，0 表示不限速")
+    group.add_argument("--tts-render-delay-ms", type=int, default=0, help="v4/UDP 帧头时间戳相对发送时刻的渲染延迟")
+    group.add_argument("--tts-text", default="测试回复", help="sentence_start 的文本")
+    group.add_argument("--stt-text", default="", help="stt 消息的文本，默认为本轮上行帧数")
+    group.add_argument("--emotion", default="happy", help="llm 消息的表情")
+    group.add_argument("--iot", dest="iot_commands", action="append", default=[], type=json.loads,
+                       metavar="JSON", help="每轮在 stt 之后下发的 iot commands 数组，可重复")
+    group.add_argument("--reply-delay-ms", type=int, default=0, help="一轮结束到下发 stt 的模拟处理时延")
+    group.add_argument("--turn-idle-ms", type=int, default=800, help="上行静默超过该时长视为一轮结束")
+    group.add_argument("--max-turn-ms", type=int, default=10000, help="一轮上行的最大时长")
+    group.add_argument("--udp-stop-grace-ms", type=int, default=100,
+                       help="MQTT+UDP 下 listen stop 之后继续接收上行音频的时长，计入说话结束到首帧 TTS 的时延")
+    group.add_argument("--goodbye-after", type=int, default=0, help="每个会话在该轮数后由服务端发送 goodbye，0 表示不发送")
+    group.add_argument("--query-latency", action="store_true", help="每轮结束后下发 latency 消息，记录设备的时延统计")
+    group.add_argument("--record", default="", help="事件记录文件（JSON Lines）")
+    group.add_argument("--quiet", action="store_true", help="不在终端打印事件")
+
+
+def normalize_options(options):
+    if options.mqtt_port is not None and options.mqtt_port < 0:
+        options.mqtt_port = None
+    return options
+
+
+async def serve(options):
+    server = TestServer(options)
+    await server.start()
+    try:
+        await asyncio.Event().wait()
+    finally:
+        await server.stop()
+        server.recorder.close()
+
+
+def main():
+    parser = argparse.ArgumentParser(description="小智 WebSocket / MQTT+UDP 本地协议测试服务器")
+    add_server_arguments(parser)
+    options = normalize_options(parser.parse_args())
+    try:
+        asyncio.run(serve(options))
+    except KeyboardInterrupt:
+        pass
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,77 @@
+// AfeFeedRing 与原先“追加到 vector 再 erase 已喂入部分”的 AFE 输入缓冲的对比
+// 按 30ms 一帧写入，每凑满 512 个采样（乘以通道数）喂入一次，统计每秒音频的平均耗时
+// 喂入回调累加块内样本作为校验和，两种实现的结果必须一致，同时防止编译器优化掉喂入
+#include "audio_processing/afe_feed_ring.h"
+
+#include <chrono>
+#include <cstdio>
+#include <vector>
+
+#define SAMPLE_RATE 16000
+#define FRAME_MS 30
+#define FEED_CHUNK_SAMPLES 512
+
+class VectorEraseFeed {
+public:
+    void Initialize(size_t chunk_samples) {
+        chunk_samples_ = chunk_samples;
+        buffer_.clear();
+    }
+
+    template <typename Feed>
+    void Write(const int16_t* data, size_t samples, Feed feed) {
+        buffer_.insert(buffer_.end(), data, data + samples);
+        while (buffer_.size() >= chunk_samples_) {
+            feed(buffer_.data());
+            buffer_.erase(buffer_.begin(), buffer_.begin() + chunk_samples_);
+        }
+    }
+
+private:
+    std::vector<int16_t> buffer_;
+    size_t chunk_samples_ = 0;
+};
+
+static double NowNs() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+template <typename Buffer>
+static double Run(Buffer& buffer, int channels, int seconds, int64_t& checksum) {
+    const size_t chunk = FEED_CHUNK_SAMPLES * channels;
+    std::vector<int16_t> frame(SAMPLE_RATE / 1000 * FRAME_MS * channels);
+    for (size_t i = 0; i < frame.size(); i++) {
+        frame[i] = (int16_t)(i * 37);
+    }
+    buffer.Initialize(chunk);
+
+    const int frames = seconds * 1000 / FRAME_MS;
+    checksum = 0;
+    double start = NowNs();
+    for (int i = 0; i < frames; i++) {
+        buffer.Write(frame.data(), frame.size(), [&checksum, chunk](const int16_t* data) {
+            checksum += data[0] + data[chunk - 1];
+        });
+    }
+    return (NowNs() - start) / 1000.0 / seconds;
+}
+
+int main() {
+    const int seconds = 2000;
+    printf("%d s of audio, %d ms frames, %d-sample feed chunks\n", seconds, FRAME_MS, FEED_CHUNK_SAMPLES);
+    printf("%-8s %-22s %-22s\n", "channels", "AfeFeedRing us/s", "vector+erase us/s");
+    for (int channels = 1; channels <= 2; channels++) {
+        AfeFeedRing ring;
+        VectorEraseFeed vector;
+        int64_t ring_checksum = 0;
+        int64_t vector_checksum = 0;
+        // 先各跑一次预热
+        Run(ring, channels, 10, ring_checksum);
+        Run(vector, channels, 10, vector_checksum);
+        double ring_us = Run(ring, channels, seconds, ring_checksum);
+        double vector_us = Run(vector, channels, seconds, vector_checksum);
+        printf("%-8d %-22.2f %-22.2f%s\n", channels, ring_us, vector_us,
+            ring_checksum == vector_checksum ? "" : "  CHECKSUM MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,131 @@
+// UdpAudioCipher 原地加解密与原先逐包复制的 UDP 音频加解密的对比
+// 原先的做法：每包复制一份 nonce 作计数器、新分配密文字符串，接收时再分配明文数组
+// 每包加密一次再解密一次，统计每个数据包的平均耗时；两种实现的密文与解密结果必须一致
+// 主机上的 mbedtls_aes_* 由 shim/mbedtls/aes.h 转到 OpenSSL，只比较两种做法在缓冲区处理上的差别
+#include "protocols/udp_audio_cipher.h"
+
+#include <arpa/inet.h>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+static constexpr size_t kHeaderSize = UdpAudioCipher::kHeaderSize;
+
+class CopyingCipher {
+public:
+    CopyingCipher() {
+        mbedtls_aes_init(&context_);
+    }
+    ~CopyingCipher() {
+        mbedtls_aes_free(&context_);
+    }
+
+    void SetKey(const std::string& key, const std::string& nonce) {
+        mbedtls_aes_setkey_enc(&context_, (const uint8_t*)key.data(), 128);
+        nonce_ = nonce;
+    }
+
+    std::string Seal(const std::vector<uint8_t>& data, uint32_t sequence) {
+        std::string nonce(nonce_);
+        *(uint16_t*)&nonce[2] = htons(data.size());
+        *(uint32_t*)&nonce[12] = htonl(sequence);
+
+        std::string encrypted;
+        encrypted.resize(nonce_.size() + data.size());
+        memcpy(encrypted.data(), nonce.data(), nonce.size());
+        size_t nc_off = 0;
+        uint8_t stream_block[16] = {0};
+        mbedtls_aes_crypt_ctr(&context_, data.size(), &nc_off, (uint8_t*)nonce.data(), stream_block,
+            data.data(), (uint8_t*)&encrypted[nonce.size()]);
+        return encrypted;
+    }
+
+    std::vector<uint8_t> Open(const std::string& data) {
+        std::vector<uint8_t> decrypted(data.size() - nonce_.size());
+        uint8_t nonce[kHeaderSize];
+        memcpy(nonce, data.data(), kHeaderSize);
+        size_t nc_off = 0;
+        uint8_t stream_block[16] = {0};
+        mbedtls_aes_crypt_ctr(&context_, decrypted.size(), &nc_off, nonce, stream_block,
+            (const uint8_t*)data.data() + kHeaderSize, decrypted.data());
+        return decrypted;
+    }
+
+private:
+    mbedtls_aes_context context_;
+    std::string nonce_;
+};
+
+static double NowNs() {
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// 校验和累加每包密文与解密结果的首尾字节，防止编译器优化掉加解密
+static double RunCopying(CopyingCipher& cipher, const std::vector<uint8_t>& payload, int packets, uint64_t& checksum) {
+    checksum = 0;
+    double start = NowNs();
+    for (int n = 0; n < packets; n++) {
+        auto packet = cipher.Seal(payload, n);
+        auto decrypted = cipher.Open(packet);
+        checksum += (uint8_t)packet[kHeaderSize] + (uint8_t)packet.back() + decrypted.front() + decrypted.back();
+    }
+    return (NowNs() - start) / packets;
+}
+
+static double RunInPlace(UdpAudioCipher& cipher, const std::vector<uint8_t>& payload, int packets, uint64_t& checksum) {
+    checksum = 0;
+    std::string packet;
+    double start = NowNs();
+    for (int n = 0; n < packets; n++) {
+        cipher.Seal(payload.data(), payload.size(), n, packet);
+        auto data = (uint8_t*)packet.data();
+        checksum += data[kHeaderSize] + data[packet.size() - 1];
+        cipher.Open(data, packet.size(), data + kHeaderSize);
+        checksum += data[kHeaderSize] + data[packet.size() - 1];
+    }
+    return (NowNs() - start) / packets;
+}
+
+int main() {
+    // 60ms 一包：上行 16kHz Opus 约 120 字节，下行 24kHz 约 180 字节，再加一个大包看吞吐上限
+    const size_t sizes[] = {120, 180, 1024};
+    const int packets = 200000;
+    const std::string key(16, '\x5a');
+    std::string nonce(kHeaderSize, '\0');
+    nonce[0] = 0x01;
+    for (size_t i = 4; i < 12; i++) {
+        nonce[i] = (char)(i * 17);
+    }
+
+    printf("%d packets, seal + open per packet\n", packets);
+    printf("%-8s %-22s %-22s\n", "bytes", "in place ns/packet", "copying ns/packet");
+    for (size_t size : sizes) {
+        std::vector<uint8_t> payload(size);
+        for (size_t i = 0; i < size; i++) {
+            payload[i] = (uint8_t)(i * 31 + 7);
+        }
+
+        UdpAudioCipher in_place;
+        CopyingCipher copying;
+        in_place.SetKey(key, nonce);
+        copying.SetKey(key, nonce);
+
+        // 同一序列号下两种实现的密文必须逐字节一致
+        std::string sealed;
+        in_place.Seal(payload.data(), size, 1, sealed);
+        bool match = sealed == copying.Seal(payload, 1);
+
+        uint64_t in_place_checksum = 0;
+        uint64_t copying_checksum = 0;
+        // 先各跑一次预热
+        RunInPlace(in_place, payload, packets / 10, in_place_checksum);
+        RunCopying(copying, payload, packets / 10, copying_checksum);
+        double in_place_ns = RunInPlace(in_place, payload, packets, in_place_checksum);
+        double copying_ns = RunCopying(copying, payload, packets, copying_checksum);
+        match &= in_place_checksum == copying_checksum;
+        printf("%-8zu %-22.1f %-22.1f%s\n", size, in_place_ns, copying_ns, match ? "" : "  MISMATCH");
+    }
+    return 0;
+}
@@ -0,0 +1,26 @@
+#include <esp_timer.h>
+#include <esp_cpu.h>
+
+#include <atomic>
+#include <time.h>
+
+static std::atomic<int64_t> fixed_time_us{-1};
+
+static int64_t MonotonicNs() {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return int64_t(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+extern "C" int64_t esp_timer_get_time(void) {
+    int64_t fixed = fixed_time_us.load(std::memory_order_relaxed);
+    return fixed >= 0 ? fixed : MonotonicNs() / 1000;
+}
+
+extern "C" void host_test_set_time_us(int64_t time_us) {
+    fixed_time_us.store(time_us, std::memory_order_relaxed);
+}
+
+extern "C" esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void) {
+    return esp_cpu_cycle_count_t(MonotonicNs());
+}
@@ -0,0 +1,42 @@
+#ifndef HOST_TEST_H
+#define HOST_TEST_H
+
+// 主机单元测试的断言与用例注册，每个测试可执行文件在 main 中调用 RUN_TEST 逐个运行用例
+// 任一断言失败时打印位置并记为失败，main 返回非 0 让 ctest 判定为失败
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstdint>
+
+inline int& HostTestFailures() {
+    static int failures = 0;
+    return failures;
+}
+
+#define TEST_ASSERT(cond) do { \
+        if (!(cond)) { \
+            fprintf(stderr, "%s:%d: assertion failed: %s\n", __FILE__, __LINE__, #cond); \
+            HostTestFailures()++; \
+            return; \
+        } \
+    } while (0)
+
+#define TEST_ASSERT_EQUAL(expected, actual) do { \
+        long long _e = (long long)(expected); \
+        long long _a = (long long)(actual); \
+        if (_e != _a) { \
+            fprintf(stderr, "%s:%d: %s: expected %lld, got %lld\n", __FILE__, __LINE__, #actual, _e, _a); \
+            HostTestFailures()++; \
+            return; \
+        } \
+    } while (0)
+
+#define RUN_TEST(func) do { \
+        int _before = HostTestFailures(); \
+        func(); \
+        printf("%s %s\n", HostTestFailures() == _before ? "PASS" : "FAIL", #func); \
+    } while (0)
+
+#define TEST_EXIT() (HostTestFailures() == 0 ? EXIT_SUCCESS : EXIT_FAILURE)
+
+#endif // HOST_TEST_H
@@ -0,0 +1,20 @@
+#ifndef _HOST_TEST_ESP_CPU_H_
+#define _HOST_TEST_ESP_CPU_H_
+
+// 主机单元测试用的 esp_cpu.h，与 linux-host 板子相同，以单调时钟的纳秒数代替 CPU 周期
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef uint32_t esp_cpu_cycle_count_t;
+
+esp_cpu_cycle_count_t esp_cpu_get_cycle_count(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HOST_TEST_ESP_CPU_H_
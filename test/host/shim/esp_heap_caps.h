@@ -0,0 +1,30 @@
+#ifndef _HOST_TEST_ESP_HEAP_CAPS_H_
+#define _HOST_TEST_ESP_HEAP_CAPS_H_
+
+// 主机单元测试用的 esp_heap_caps.h，所有内存能力都映射到 malloc/free
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define MALLOC_CAP_8BIT     (1 << 2)
+#define MALLOC_CAP_DMA      (1 << 3)
+#define MALLOC_CAP_SPIRAM   (1 << 10)
+#define MALLOC_CAP_INTERNAL (1 << 11)
+#define MALLOC_CAP_DEFAULT  (1 << 12)
+
+static inline void* heap_caps_malloc(size_t size, uint32_t caps) {
+    (void)caps;
+    return malloc(size);
+}
+
+static inline void* heap_caps_aligned_alloc(size_t alignment, size_t size, uint32_t caps) {
+    (void)caps;
+    return aligned_alloc(alignment, (size + alignment - 1) / alignment * alignment);
+}
+
+static inline void heap_caps_free(void* ptr) {
+    free(ptr);
+}
+
+#endif // _HOST_TEST_ESP_HEAP_CAPS_H_
@@ -0,0 +1,14 @@
+#ifndef _HOST_TEST_ESP_LOG_H_
+#define _HOST_TEST_ESP_LOG_H_
+
+// 主机单元测试用的 esp_log.h，日志直接输出到 stderr，DEBUG/VERBOSE 级别不输出
+
+#include <stdio.h>
+
+#define ESP_LOGE(tag, format, ...) fprintf(stderr, "E (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGW(tag, format, ...) fprintf(stderr, "W (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGI(tag, format, ...) fprintf(stderr, "I (%s) " format "\n", tag, ##__VA_ARGS__)
+#define ESP_LOGD(tag, format, ...) do { } while (0)
+#define ESP_LOGV(tag, format, ...) do { } while (0)
+
+#endif // _HOST_TEST_ESP_LOG_H_
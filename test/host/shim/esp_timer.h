@@ -0,0 +1,22 @@
+#ifndef _HOST_TEST_ESP_TIMER_H_
+#define _HOST_TEST_ESP_TIMER_H_
+
+// 主机单元测试用的 esp_timer.h，只提供 esp_timer_get_time
+// 测试可以通过 host_test_set_time_us 固定当前时间，以便回放带时间戳的报文序列
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+int64_t esp_timer_get_time(void);
+
+// time_us 小于 0 时恢复使用单调时钟
+void host_test_set_time_us(int64_t time_us);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // _HOST_TEST_ESP_TIMER_H_
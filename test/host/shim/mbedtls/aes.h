@@ -0,0 +1,58 @@
+#ifndef _HOST_TEST_MBEDTLS_AES_H_
+#define _HOST_TEST_MBEDTLS_AES_H_
+
+// 主机基准测试用的 mbedtls/aes.h，只实现 UdpAudioCipher 用到的 CTR 模式接口
+// 分组加密由 OpenSSL 的 AES-128-ECB 完成，计数器与 nc_off 的处理与 mbedtls_aes_crypt_ctr 一致
+
+#include <openssl/evp.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct {
+    EVP_CIPHER_CTX* evp;
+} mbedtls_aes_context;
+
+static inline void mbedtls_aes_init(mbedtls_aes_context* ctx) {
+    ctx->evp = EVP_CIPHER_CTX_new();
+}
+
+static inline void mbedtls_aes_free(mbedtls_aes_context* ctx) {
+    EVP_CIPHER_CTX_free(ctx->evp);
+    ctx->evp = NULL;
+}
+
+static inline int mbedtls_aes_setkey_enc(mbedtls_aes_context* ctx, const unsigned char* key, unsigned int keybits) {
+    if (keybits != 128 || EVP_EncryptInit_ex(ctx->evp, EVP_aes_128_ecb(), NULL, key, NULL) != 1) {
+        return -1;
+    }
+    EVP_CIPHER_CTX_set_padding(ctx->evp, 0);
+    return 0;
+}
+
+static inline int mbedtls_aes_crypt_ctr(mbedtls_aes_context* ctx, size_t length, size_t* nc_off,
+    unsigned char nonce_counter[16], unsigned char stream_block[16], const unsigned char* input, unsigned char* output) {
+    size_t n = *nc_off;
+    if (n > 15) {
+        return -1;
+    }
+    while (length--) {
+        if (n == 0) {
+            int out_len = 0;
+            if (EVP_EncryptUpdate(ctx->evp, stream_block, &out_len, nonce_counter, 16) != 1) {
+                return -1;
+            }
+            // 计数器按 128 位大端整数加一
+            for (int i = 16; i > 0; i--) {
+                if (++nonce_counter[i - 1] != 0) {
+                    break;
+                }
+            }
+        }
+        *output++ = *input++ ^ stream_block[n];
+        n = (n + 1) & 0x0F;
+    }
+    *nc_off = n;
+    return 0;
+}
+
+#endif // _HOST_TEST_MBEDTLS_AES_H_
@@ -0,0 +1,6 @@
+#ifndef _HOST_TEST_SDKCONFIG_H_
+#define _HOST_TEST_SDKCONFIG_H_
+
+// 主机单元测试不使用 menuconfig，所有 CONFIG_ 选项视为未定义（取默认的可移植实现）
+
+#endif // _HOST_TEST_SDKCONFIG_H_
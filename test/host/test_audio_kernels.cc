@@ -0,0 +1,99 @@
+#include "host_test.h"
+#include "audio_codecs/audio_kernels.h"
+
+#include <cstring>
+#include <vector>
+
+// 帧数不是 8 的倍数，同时覆盖展开的主循环与尾部
+static constexpr size_t kFrames = 1443;
+
+// xorshift32 生成满量程数据，确保饱和分支都被覆盖
+static uint32_t Next(uint32_t& seed) {
+    seed ^= seed << 13;
+    seed ^= seed >> 17;
+    seed ^= seed << 5;
+    return seed;
+}
+
+struct Buffers {
+    std::vector<int16_t> stereo, stereo_out, stereo_ref;
+    std::vector<int16_t> left, right, left_ref, right_ref;
+    std::vector<int32_t> wide, wide_out, wide_ref;
+
+    explicit Buffers(size_t frames)
+        : stereo(frames * 2), stereo_out(frames * 2), stereo_ref(frames * 2),
+          left(frames), right(frames), left_ref(frames), right_ref(frames),
+          wide(frames), wide_out(frames), wide_ref(frames) {
+        uint32_t seed = 0x2545F491;
+        for (auto& sample : stereo) {
+            sample = static_cast<int16_t>(Next(seed));
+        }
+        for (auto& sample : wide) {
+            sample = static_cast<int32_t>(Next(seed));
+        }
+        // 极值样本
+        stereo[0] = INT16_MIN;
+        stereo[1] = INT16_MAX;
+        wide[0] = INT32_MIN;
+        wide[1] = INT32_MAX;
+    }
+};
+
+template <typename T>
+static bool Same(const std::vector<T>& a, const std::vector<T>& b) {
+    return memcmp(a.data(), b.data(), a.size() * sizeof(T)) == 0;
+}
+
+static void test_deinterleave_interleave_match_reference() {
+    for (size_t frames : {size_t(0), size_t(1), size_t(7), size_t(8), kFrames}) {
+        Buffers b(kFrames);
+        AudioKernels::Deinterleave(b.stereo.data(), b.left.data(), b.right.data(), frames);
+        AudioKernels::DeinterleaveReference(b.stereo.data(), b.left_ref.data(), b.right_ref.data(), frames);
+        TEST_ASSERT(Same(b.left, b.left_ref));
+        TEST_ASSERT(Same(b.right, b.right_ref));
+
+        AudioKernels::Interleave(b.left_ref.data(), b.right_ref.data(), b.stereo_out.data(), frames);
+        AudioKernels::InterleaveReference(b.left_ref.data(), b.right_ref.data(), b.stereo_ref.data(), frames);
+        TEST_ASSERT(Same(b.stereo_out, b.stereo_ref));
+    }
+}
+
+static void test_int32_to_int16_matches_reference() {
+    Buffers b(kFrames);
+    for (int shift : {0, 12, 16, 31}) {
+        AudioKernels::Int32ToInt16(b.wide.data(), b.left.data(), kFrames, shift);
+        AudioKernels::Int32ToInt16Reference(b.wide.data(), b.left_ref.data(), kFrames, shift);
+        TEST_ASSERT(Same(b.left, b.left_ref));
+    }
+}
+
+static void test_gain_to_int32_matches_reference() {
+    Buffers b(kFrames);
+    for (int32_t gain : {0, 1, 12345, 65535, 65536}) {
+        AudioKernels::GainToInt32(b.stereo.data(), b.wide_out.data(), kFrames, gain);
+        AudioKernels::GainToInt32Reference(b.stereo.data(), b.wide_ref.data(), kFrames, gain);
+        TEST_ASSERT(Same(b.wide_out, b.wide_ref));
+    }
+}
+
+static void test_mix_matches_reference() {
+    Buffers b(kFrames);
+    AudioKernels::DeinterleaveReference(b.stereo.data(), b.left_ref.data(), b.right_ref.data(), kFrames);
+    AudioKernels::Mix(b.left_ref.data(), b.right_ref.data(), b.left.data(), kFrames);
+    AudioKernels::MixReference(b.left_ref.data(), b.right_ref.data(), b.right.data(), kFrames);
+    TEST_ASSERT(Same(b.left, b.right));
+    // 同号满量程相加必须饱和
+    int16_t a[2] = {INT16_MAX, INT16_MIN};
+    int16_t out[2];
+    AudioKernels::Mix(a, a, out, 2);
+    TEST_ASSERT_EQUAL(INT16_MAX, out[0]);
+    TEST_ASSERT_EQUAL(INT16_MIN, out[1]);
+}
+
+int main() {
+    RUN_TEST(test_deinterleave_interleave_match_reference);
+    RUN_TEST(test_int32_to_int16_matches_reference);
+    RUN_TEST(test_gain_to_int32_matches_reference);
+    RUN_TEST(test_mix_matches_reference);
+    return TEST_EXIT();
+}
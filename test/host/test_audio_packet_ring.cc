@@ -0,0 +1,164 @@
+#include "host_test.h"
+#include "audio_packet_ring.h"
+
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+static std::vector<uint8_t> MakePacket(uint32_t sequence, size_t size) {
+    std::vector<uint8_t> packet(size);
+    for (size_t i = 0; i < size; i++) {
+        packet[i] = uint8_t(sequence * 31 + i);
+    }
+    if (size >= sizeof(sequence)) {
+        memcpy(packet.data(), &sequence, sizeof(sequence));
+    }
+    return packet;
+}
+
+// 按入队顺序出队，时间戳随数据包取回，长度为 0 的数据包同样保序
+static void test_fifo_order_and_timestamps() {
+    AudioPacketRing ring(1024);
+    for (uint32_t i = 0; i < 8; i++) {
+        auto packet = MakePacket(i, i == 3 ? 0 : 20 + i);
+        TEST_ASSERT(ring.Push(packet.data(), packet.size(), 1000 + i));
+    }
+    std::vector<uint8_t> packet;
+    for (uint32_t i = 0; i < 8; i++) {
+        int64_t timestamp = 0;
+        TEST_ASSERT(ring.Pop(packet, &timestamp));
+        TEST_ASSERT_EQUAL(1000 + i, timestamp);
+        TEST_ASSERT(packet == MakePacket(i, i == 3 ? 0 : 20 + i));
+    }
+    TEST_ASSERT(!ring.Pop(packet));
+    TEST_ASSERT(ring.Empty());
+}
+
+// 反复回绕后内容不被破坏
+static void test_wrap_around() {
+    AudioPacketRing ring(256);
+    std::vector<uint8_t> packet;
+    for (uint32_t i = 0; i < 1000; i++) {
+        auto in = MakePacket(i, 4 + (i * 7) % 60);
+        TEST_ASSERT(ring.Push(in.data(), in.size()));
+        if (i % 2 == 1) {
+            auto expected = MakePacket(i - 1, 4 + ((i - 1) * 7) % 60);
+            TEST_ASSERT(ring.Pop(packet));
+            TEST_ASSERT(packet == expected);
+            TEST_ASSERT(ring.Pop(packet));
+            TEST_ASSERT(packet == in);
+        }
+    }
+    TEST_ASSERT(ring.Empty());
+}
+
+// 空队列的读写位置停在任意位置时，最大长度的数据包都能入队，不需要把索引复位到起点
+static void test_empty_ring_accepts_max_packet_at_any_position() {
+    const size_t capacity = 256;
+    const size_t max_payload = capacity / 2 - 12;
+    AudioPacketRing ring(capacity);
+    std::vector<uint8_t> packet;
+    for (size_t step = 0; step < capacity / 4; step++) {
+        auto in = MakePacket(step, max_payload);
+        TEST_ASSERT(ring.Push(in.data(), in.size()));
+        TEST_ASSERT(ring.Pop(packet));
+        TEST_ASSERT(packet == in);
+        TEST_ASSERT(ring.Empty());
+        // 每次前移 4 字节（只有记录头的空数据包），遍历所有对齐位置
+        TEST_ASSERT(ring.Push(nullptr, 0));
+        TEST_ASSERT(ring.Pop(packet));
+    }
+    TEST_ASSERT_EQUAL(0, ring.GetStats().dropped);
+}
+
+static void test_oversized_packet_dropped() {
+    const size_t capacity = 256;
+    AudioPacketRing ring(capacity);
+    std::vector<uint8_t> big(capacity / 2 - 12 + 1);
+    TEST_ASSERT(!ring.Push(big.data(), big.size()));
+    TEST_ASSERT_EQUAL(1, ring.GetStats().dropped);
+    TEST_ASSERT(ring.Empty());
+}
+
+static void test_overflow_policies() {
+    std::vector<uint8_t> packet;
+    {
+        AudioPacketRing ring(256, AudioPacketRing::kOverflowDropNewest);
+        uint32_t accepted = 0;
+        for (uint32_t i = 0; i < 20; i++) {
+            auto in = MakePacket(i, 36);
+            accepted += ring.Push(in.data(), in.size()) ? 1 : 0;
+        }
+        TEST_ASSERT(accepted > 0 && accepted < 20);
+        TEST_ASSERT_EQUAL(20 - accepted, ring.GetStats().dropped);
+        TEST_ASSERT(ring.Pop(packet));
+        TEST_ASSERT(packet == MakePacket(0, 36));
+    }
+    {
+        AudioPacketRing ring(256, AudioPacketRing::kOverflowDropOldest);
+        for (uint32_t i = 0; i < 20; i++) {
+            auto in = MakePacket(i, 36);
+            TEST_ASSERT(ring.Push(in.data(), in.size()));
+        }
+        auto stats = ring.GetStats();
+        TEST_ASSERT(stats.evicted > 0);
+        // 留下的是最新的数据包，且仍然按序
+        uint32_t expected = stats.evicted;
+        while (ring.Pop(packet)) {
+            TEST_ASSERT(packet == MakePacket(expected, 36));
+            expected++;
+        }
+        TEST_ASSERT_EQUAL(20, expected);
+    }
+}
+
+// 一个生产者线程（淘汰最旧）与一个消费者线程并发运行：出队的序列号严格递增、内容完整，
+// 计数满足 pushed == popped + evicted
+static void test_concurrent_producer_consumer() {
+    const uint32_t count = 200000;
+    AudioPacketRing ring(4096, AudioPacketRing::kOverflowDropOldest);
+    std::atomic<bool> done{false};
+    std::atomic<int> errors{0};
+    std::thread consumer([&]() {
+        std::vector<uint8_t> packet;
+        int64_t last = -1;
+        while (true) {
+            bool finished = done.load(std::memory_order_acquire);
+            if (!ring.Pop(packet)) {
+                if (finished) {
+                    break;
+                }
+                std::this_thread::yield();
+                continue;
+            }
+            uint32_t sequence;
+            memcpy(&sequence, packet.data(), sizeof(sequence));
+            if (int64_t(sequence) <= last || packet != MakePacket(sequence, 8 + sequence % 120)) {
+                errors++;
+            }
+            last = sequence;
+        }
+    });
+    for (uint32_t i = 0; i < count; i++) {
+        auto in = MakePacket(i, 8 + i % 120);
+        ring.Push(in.data(), in.size());
+    }
+    done.store(true, std::memory_order_release);
+    consumer.join();
+
+    auto stats = ring.GetStats();
+    TEST_ASSERT_EQUAL(0, errors.load());
+    TEST_ASSERT_EQUAL(count, stats.pushed);
+    TEST_ASSERT_EQUAL(stats.pushed, stats.popped + stats.evicted);
+}
+
+int main() {
+    RUN_TEST(test_fifo_order_and_timestamps);
+    RUN_TEST(test_wrap_around);
+    RUN_TEST(test_empty_ring_accepts_max_packet_at_any_position);
+    RUN_TEST(test_oversized_packet_dropped);
+    RUN_TEST(test_overflow_policies);
+    RUN_TEST(test_concurrent_producer_consumer);
+    return TEST_EXIT();
+}
@@ -0,0 +1,224 @@
+#include "host_test.h"
+#include "protocols/jitter_buffer.h"
+
+#include <cstring>
+#include <vector>
+
+// 回放带到达时间的报文序列：Put/Poll 前把 esp_timer 固定到该时刻，输出记录为序列号，丢包补偿记为 -1
+class Replay {
+public:
+    Replay(int min_depth_ms = 60, int max_depth_ms = 360) : buffer_(60, min_depth_ms, max_depth_ms) {
+        buffer_.OnOutput([this](std::vector<uint8_t>&& packet) {
+            if (packet.empty()) {
+                output.push_back(-1);
+                return;
+            }
+            uint32_t sequence;
+            memcpy(&sequence, packet.data(), sizeof(sequence));
+            output.push_back(sequence);
+        });
+    }
+
+    void Put(uint32_t sequence, int64_t time_ms) {
+        host_test_set_time_us(time_ms * 1000);
+        buffer_.Put(sequence, sizeof(sequence), [sequence](uint8_t* data) {
+            memcpy(data, &sequence, sizeof(sequence));
+            return true;
+        });
+    }
+
+    void Poll(int64_t time_ms) {
+        host_test_set_time_us(time_ms * 1000);
+        buffer_.Poll();
+    }
+
+    JitterBuffer::Stats Stats() { return buffer_.GetStats(); }
+
+    std::vector<int> output;
+
+private:
+    JitterBuffer buffer_;
+};
+
+static void test_in_order_stream_passes_through() {
+    Replay replay;
+    for (uint32_t i = 0; i < 50; i++) {
+        replay.Put(i, i * 60);
+    }
+    TEST_ASSERT_EQUAL(50, replay.output.size());
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL(i, replay.output[i]);
+    }
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(50, stats.received);
+    TEST_ASSERT_EQUAL(0, stats.concealed);
+    TEST_ASSERT_EQUAL(0, stats.reordered);
+    TEST_ASSERT_EQUAL(60, stats.target_ms);
+}
+
+// 乱序到达但仍在等待窗口（目标深度）内的数据包被重排，不做补偿
+static void test_reorder_within_window() {
+    Replay replay;
+    replay.Put(0, 0);
+    replay.Put(1, 60);
+    replay.Put(3, 180);
+    replay.Poll(200);
+    replay.Put(2, 230);  // 空缺已等待 50 ms，目标深度 60 ms
+    replay.Put(4, 240);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1, 2, 3, 4}));
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(1, stats.reordered);
+    TEST_ASSERT_EQUAL(0, stats.concealed);
+    TEST_ASSERT_EQUAL(0, stats.late);
+}
+
+// 空缺等待超过目标深度后输出一帧补偿，之后到达的原数据包计为过晚并丢弃
+static void test_loss_concealed_after_window() {
+    Replay replay;
+    replay.Put(0, 0);
+    replay.Put(1, 60);
+    replay.Put(3, 180);
+    replay.Poll(239);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1}));
+    replay.Poll(240);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1, -1, 3}));
+    replay.Put(2, 250);
+    replay.Put(4, 260);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1, -1, 3, 4}));
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(1, stats.concealed);
+    TEST_ASSERT_EQUAL(1, stats.late);
+    TEST_ASSERT_EQUAL(0, stats.skipped);
+}
+
+// 连续丢失超过 5 帧时只补偿前 5 帧，其余跳过
+static void test_burst_loss_limits_concealment() {
+    Replay replay;
+    replay.Put(0, 0);
+    replay.Put(10, 600);
+    replay.Poll(660);
+    TEST_ASSERT(replay.output == std::vector<int>({0, -1, -1, -1, -1, -1, 10}));
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(5, stats.concealed);
+    TEST_ASSERT_EQUAL(4, stats.skipped);
+}
+
+// 重复的数据包只输出一次；序列号跳出缓冲范围时输出已缓存的数据包并重新同步
+static void test_duplicate_and_resync() {
+    Replay replay;
+    replay.Put(0, 0);
+    replay.Put(1, 60);
+    replay.Put(3, 120);
+    replay.Put(3, 130);
+    TEST_ASSERT_EQUAL(1, replay.Stats().duplicated);
+    replay.Put(100, 180);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1, 3, 100}));
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(97, stats.skipped);
+    TEST_ASSERT_EQUAL(0, stats.concealed);
+}
+
+// 网络停顿后一批数据包集中到达：抖动估计抬高目标深度（不超过最大深度），之后平稳到达时逐渐回落
+static void test_target_depth_adapts_to_jitter() {
+    Replay replay;
+    int64_t now = 0;
+    uint32_t sequence = 0;
+    for (; sequence < 10; sequence++, now += 60) {
+        replay.Put(sequence, now);
+    }
+    TEST_ASSERT_EQUAL(60, replay.Stats().target_ms);
+
+    // 停顿 360 ms，期间的 5 个数据包在停顿结束时一起到达，重复两次
+    for (int stall = 0; stall < 2; stall++) {
+        now += 360;
+        for (int i = 0; i < 6; i++, sequence++) {
+            replay.Put(sequence, now);
+        }
+    }
+    auto stats = replay.Stats();
+    TEST_ASSERT(stats.jitter_ms >= 20);
+    TEST_ASSERT(stats.target_ms >= 70);
+    TEST_ASSERT_EQUAL(0, stats.concealed);
+
+    // 频繁的停顿受最大深度限制
+    for (int stall = 0; stall < 20; stall++) {
+        now += 400;
+        replay.Put(sequence++, now);
+    }
+    TEST_ASSERT_EQUAL(360, replay.Stats().target_ms);
+
+    for (int i = 0; i < 200; i++, sequence++) {
+        now += 60;
+        replay.Put(sequence, now);
+    }
+    TEST_ASSERT_EQUAL(60, replay.Stats().target_ms);
+
+    TEST_ASSERT_EQUAL(sequence, replay.output.size());
+    for (uint32_t i = 0; i < sequence; i++) {
+        TEST_ASSERT_EQUAL(i, replay.output[i]);
+    }
+}
+
+// 句子或轮次之间的停顿（远超最大深度）是语段边界而不是抖动：目标深度保持不变，
+// 停顿之后的丢包仍按最小深度等待后补偿，而不是等到最大深度
+static void test_sentence_pause_keeps_target() {
+    Replay replay;
+    int64_t now = 0;
+    uint32_t sequence = 0;
+    for (int sentence = 0; sentence < 5; sentence++) {
+        for (int i = 0; i < 20; i++, sequence++, now += 60) {
+            replay.Put(sequence, now);
+        }
+        now += 2000;
+    }
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(0, stats.jitter_ms);
+    TEST_ASSERT_EQUAL(60, stats.target_ms);
+
+    uint32_t lost = sequence++;
+    replay.Put(sequence++, now + 60);
+    replay.Poll(now + 60 + 59);
+    TEST_ASSERT_EQUAL(lost, replay.output.size());
+    replay.Poll(now + 60 + 60);
+    TEST_ASSERT_EQUAL(-1, replay.output[lost]);
+    TEST_ASSERT_EQUAL(1, replay.Stats().concealed);
+}
+
+// 乱序延迟计入目标深度：目标深度已被抖动抬高时，晚到 150 ms 的数据包仍能补上空缺，并让目标深度保持在该延迟之上
+static void test_reorder_delay_raises_target() {
+    Replay replay(60, 360);
+    int64_t now = 0;
+    uint32_t sequence = 0;
+    for (; sequence < 5; sequence++, now += 60) {
+        replay.Put(sequence, now);
+    }
+    // 连续几次 300 ms 的网络停顿让目标深度升到 150 ms 以上
+    for (int stall = 0; stall < 4; stall++) {
+        now += 300;
+        replay.Put(sequence++, now);
+    }
+    TEST_ASSERT(replay.Stats().target_ms > 150);
+
+    uint32_t missing = sequence++;
+    now += 60;
+    replay.Put(sequence++, now);
+    replay.Poll(now + 100);
+    replay.Put(missing, now + 150);
+    auto stats = replay.Stats();
+    TEST_ASSERT_EQUAL(1, stats.reordered);
+    TEST_ASSERT_EQUAL(0, stats.concealed);
+    TEST_ASSERT(stats.target_ms >= 150);
+    TEST_ASSERT(replay.output == std::vector<int>({0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10}));
+}
+
+int main() {
+    RUN_TEST(test_in_order_stream_passes_through);
+    RUN_TEST(test_reorder_within_window);
+    RUN_TEST(test_loss_concealed_after_window);
+    RUN_TEST(test_burst_loss_limits_concealment);
+    RUN_TEST(test_duplicate_and_resync);
+    RUN_TEST(test_target_depth_adapts_to_jitter);
+    RUN_TEST(test_sentence_pause_keeps_target);
+    RUN_TEST(test_reorder_delay_raises_target);
+    return TEST_EXIT();
+}
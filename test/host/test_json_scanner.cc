@@ -0,0 +1,116 @@
+#include "host_test.h"
+#include "protocols/json_scanner.h"
+
+#include <string>
+
+static void test_member_types() {
+    JsonObject root;
+    TEST_ASSERT(root.Parse(R"( {"type":"tts", "n":-42, "ok":true, "off":false, "none":null, "o":{"a":[1,"}"]}, "l":[{}, []]} )"));
+    TEST_ASSERT_EQUAL(7, root.size());
+    TEST_ASSERT(root["type"].Equals("tts"));
+    TEST_ASSERT(!root["type"].Equals("tt"));
+    TEST_ASSERT(root["n"].IsNumber());
+    TEST_ASSERT(root["ok"].IsTrue());
+    TEST_ASSERT(!root["off"].IsTrue());
+    TEST_ASSERT_EQUAL(JsonValue::kNull, root["none"].type);
+    TEST_ASSERT(root["o"].IsObject());
+    TEST_ASSERT(root["o"].raw == R"({"a":[1,"}"]})");
+    TEST_ASSERT(root["l"].IsArray());
+    TEST_ASSERT_EQUAL(JsonValue::kMissing, root["missing"].type);
+    TEST_ASSERT(!root["missing"].Equals(""));
+}
+
+static void test_to_int() {
+    JsonObject root;
+    TEST_ASSERT(root.Parse(R"({"a":24000,"b":-7,"c":1.9,"d":"5","e":99999999999})"));
+    TEST_ASSERT_EQUAL(24000, root["a"].ToInt());
+    TEST_ASSERT_EQUAL(-7, root["b"].ToInt());
+    TEST_ASSERT_EQUAL(1, root["c"].ToInt());
+    TEST_ASSERT_EQUAL(-1, root["d"].ToInt(-1));
+    TEST_ASSERT_EQUAL(-1, root["e"].ToInt(-1));
+    TEST_ASSERT_EQUAL(3, root["missing"].ToInt(3));
+}
+
+static void test_string_escapes() {
+    JsonObject root;
+    TEST_ASSERT(root.Parse(R"({"plain":"hi","esc":"a\"b\\c\/d\n\t","cn":"今天","emoji":"😊","lone":"\ud83d!"})"));
+    TEST_ASSERT(!root["plain"].escaped);
+    TEST_ASSERT(root["plain"].ToString() == "hi");
+    TEST_ASSERT(root["esc"].escaped);
+    TEST_ASSERT(!root["esc"].Equals("a\"b\\c/d\n\t"));
+    TEST_ASSERT(root["esc"].ToString() == "a\"b\\c/d\n\t");
+    TEST_ASSERT(root["cn"].ToString() == "今天");
+    TEST_ASSERT(root["emoji"].ToString() == "😊");
+    TEST_ASSERT(root["lone"].ToString() == "\xEF\xBF\xBD!");
+    TEST_ASSERT(root["missing"].ToString().empty());
+}
+
+static void test_nested_reparse() {
+    JsonObject root;
+    TEST_ASSERT(root.Parse(R"({"type":"iot","command":{"name":"Speaker","method":"SetVolume","parameters":{"volume":80}}})"));
+    JsonObject command;
+    TEST_ASSERT(command.Parse(root["command"].raw));
+    TEST_ASSERT(command["method"].Equals("SetVolume"));
+    JsonObject parameters;
+    TEST_ASSERT(parameters.Parse(command["parameters"].raw));
+    TEST_ASSERT_EQUAL(80, parameters["volume"].ToInt());
+}
+
+static void test_malformed() {
+    const char* const cases[] = {
+        "",
+        "[]",
+        "{",
+        R"({"a":1,})",
+        R"({"a" 1})",
+        R"({a:1})",
+        R"({"a":tru})",
+        R"({"a":"unterminated})",
+        R"({"a":{"b":1})",
+        R"({"a":1} trailing)",
+        "{\"a\":\"ctl\x01\"}",
+    };
+    for (const char* text : cases) {
+        JsonObject root;
+        if (root.Parse(text)) {
+            fprintf(stderr, "accepted: %s\n", text);
+            TEST_ASSERT(false);
+        }
+    }
+    JsonObject empty;
+    TEST_ASSERT(empty.Parse(" { } "));
+    TEST_ASSERT_EQUAL(0, empty.size());
+}
+
+// 超出 kMaxMembers 的成员不能被静默丢弃，否则排在后面的 type 会导致消息被当作未知类型
+static void test_too_many_members() {
+    std::string text = "{";
+    for (size_t i = 0; i < JsonObject::kMaxMembers; i++) {
+        text += "\"k" + std::to_string(i) + "\":" + std::to_string(i) + ",";
+    }
+    JsonObject full;
+    TEST_ASSERT(full.Parse(text.substr(0, text.size() - 1) + "}"));
+    TEST_ASSERT_EQUAL(JsonObject::kMaxMembers, full.size());
+
+    // 超出上限的成员被丢弃，消息仍然有效，前 kMaxMembers 个成员照常可用
+    JsonObject over;
+    std::string over_text = text + R"("type":"tts","state":"start"})";
+    TEST_ASSERT(over.Parse(over_text));
+    TEST_ASSERT_EQUAL(JsonObject::kMaxMembers, over.size());
+    TEST_ASSERT_EQUAL(0, over["k0"].ToInt(-1));
+    TEST_ASSERT_EQUAL(JsonObject::kMaxMembers - 1, over["k" + std::to_string(JsonObject::kMaxMembers - 1)].ToInt(-1));
+    TEST_ASSERT(!over["type"].IsString());
+
+    // 丢弃的成员仍要校验格式
+    TEST_ASSERT(!over.Parse(text + R"("type":tts})"));
+}
+
+int main() {
+    RUN_TEST(test_member_types);
+    RUN_TEST(test_to_int);
+    RUN_TEST(test_string_escapes);
+    RUN_TEST(test_nested_reparse);
+    RUN_TEST(test_malformed);
+    RUN_TEST(test_too_many_members);
+    return TEST_EXIT();
+}
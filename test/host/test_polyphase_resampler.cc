@@ -0,0 +1,161 @@
+#include "host_test.h"
+#include "audio_codecs/polyphase_resampler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+struct Ratio {
+    int input_sample_rate;
+    int output_sample_rate;
+};
+
+static const Ratio kRatios[] = {
+    {24000, 16000},
+    {48000, 16000},
+    {16000, 24000},
+    {16000, 44100},
+};
+
+static constexpr double kPi = 3.14159265358979323846;
+static constexpr double kAmplitude = 16384.0;
+static constexpr int kFrameMs = 30;
+static constexpr int kFrames = 20;
+
+static std::vector<int16_t> Sine(int sample_rate, double frequency, size_t samples, int channels = 1) {
+    std::vector<int16_t> pcm(samples * channels);
+    for (size_t i = 0; i < samples; i++) {
+        double t = double(i) / sample_rate;
+        for (int c = 0; c < channels; c++) {
+            pcm[i * channels + c] = (int16_t)lround(kAmplitude * sin(2 * kPi * frequency * (c + 1) * t));
+        }
+    }
+    return pcm;
+}
+
+// 按 30ms 一帧流式处理，返回全部输出
+static std::vector<int16_t> Resample(PolyphaseResampler& resampler, const std::vector<int16_t>& input,
+    size_t frame_frames, int channels) {
+    std::vector<int16_t> result;
+    std::vector<int16_t> output;
+    size_t total = input.size() / channels;
+    for (size_t offset = 0; offset < total; offset += frame_frames) {
+        size_t frames = std::min(frame_frames, total - offset);
+        size_t expected = resampler.GetOutputFrames(frames);
+        output.resize(expected * channels);
+        size_t produced = resampler.Process(input.data() + offset * channels, frames, output.data());
+        if (produced != expected) {
+            return {};
+        }
+        result.insert(result.end(), output.begin(), output.end());
+    }
+    return result;
+}
+
+// 用最小二乘拟合出同频正弦（与滤波器群延迟无关），残差即为噪声
+static double SineSnr(const std::vector<int16_t>& pcm, size_t skip, int sample_rate, double frequency) {
+    double ss = 0, sc = 0, cc = 0, ys = 0, yc = 0;
+    for (size_t n = skip; n < pcm.size(); n++) {
+        double s = sin(2 * kPi * frequency * n / sample_rate);
+        double c = cos(2 * kPi * frequency * n / sample_rate);
+        ss += s * s;
+        sc += s * c;
+        cc += c * c;
+        ys += pcm[n] * s;
+        yc += pcm[n] * c;
+    }
+    double det = ss * cc - sc * sc;
+    double a = (ys * cc - yc * sc) / det;
+    double b = (yc * ss - ys * sc) / det;
+    double signal = 0, noise = 0;
+    for (size_t n = skip; n < pcm.size(); n++) {
+        double fit = a * sin(2 * kPi * frequency * n / sample_rate) + b * cos(2 * kPi * frequency * n / sample_rate);
+        signal += fit * fit;
+        noise += (pcm[n] - fit) * (pcm[n] - fit);
+    }
+    return noise > 0 ? 10 * log10(signal / noise) : 200;
+}
+
+static void test_supported_ratios() {
+    for (auto& ratio : kRatios) {
+        TEST_ASSERT(PolyphaseResampler::IsSupported(ratio.input_sample_rate, ratio.output_sample_rate));
+    }
+    TEST_ASSERT(!PolyphaseResampler::IsSupported(16000, 16000));
+    TEST_ASSERT(!PolyphaseResampler::IsSupported(22050, 16000));
+}
+
+// 1kHz 正弦重采样后的信噪比，输出总帧数与比例一致
+static void test_sine_snr() {
+    for (auto& ratio : kRatios) {
+        PolyphaseResampler resampler;
+        TEST_ASSERT(resampler.Configure(ratio.input_sample_rate, ratio.output_sample_rate, 1));
+        size_t frame_frames = ratio.input_sample_rate / 1000 * kFrameMs;
+        auto input = Sine(ratio.input_sample_rate, 1000, frame_frames * kFrames);
+        auto output = Resample(resampler, input, frame_frames, 1);
+        size_t expected = size_t(double(input.size()) * ratio.output_sample_rate / ratio.input_sample_rate);
+        TEST_ASSERT(output.size() + 1 >= expected && output.size() <= expected + 1);
+        double snr = SineSnr(output, 128, ratio.output_sample_rate, 1000);
+        printf("  %5d -> %5d Hz: SNR %.1f dB\n", ratio.input_sample_rate, ratio.output_sample_rate, snr);
+        TEST_ASSERT(snr > 70);
+    }
+}
+
+// 分块大小不影响结果：逐帧处理与不规则分块处理逐样本相同
+static void test_streaming_is_block_size_independent() {
+    for (auto& ratio : kRatios) {
+        size_t frame_frames = ratio.input_sample_rate / 1000 * kFrameMs;
+        auto input = Sine(ratio.input_sample_rate, 440, frame_frames * kFrames);
+        PolyphaseResampler a;
+        a.Configure(ratio.input_sample_rate, ratio.output_sample_rate, 1);
+        auto expected = Resample(a, input, frame_frames, 1);
+
+        PolyphaseResampler b;
+        b.Configure(ratio.input_sample_rate, ratio.output_sample_rate, 1);
+        std::vector<int16_t> chunked;
+        std::vector<int16_t> output;
+        size_t offset = 0;
+        for (size_t step = 1; offset < input.size(); step = step * 7 % 97 + 1) {
+            size_t frames = std::min(step, input.size() - offset);
+            output.resize(b.GetOutputFrames(frames));
+            size_t produced = b.Process(input.data() + offset, frames, output.data());
+            TEST_ASSERT_EQUAL(output.size(), produced);
+            chunked.insert(chunked.end(), output.begin(), output.end());
+            offset += frames;
+        }
+        TEST_ASSERT(chunked == expected);
+    }
+}
+
+// 多声道交织处理与逐声道单独处理的结果逐样本相同
+static void test_interleaved_matches_per_channel() {
+    constexpr int kChannels = 3;
+    for (auto& ratio : kRatios) {
+        size_t frame_frames = ratio.input_sample_rate / 1000 * kFrameMs;
+        auto input = Sine(ratio.input_sample_rate, 1000, frame_frames * kFrames, kChannels);
+        PolyphaseResampler interleaved;
+        TEST_ASSERT(interleaved.Configure(ratio.input_sample_rate, ratio.output_sample_rate, kChannels));
+        auto output = Resample(interleaved, input, frame_frames, kChannels);
+        TEST_ASSERT(!output.empty());
+        for (int c = 0; c < kChannels; c++) {
+            std::vector<int16_t> channel(input.size() / kChannels);
+            for (size_t i = 0; i < channel.size(); i++) {
+                channel[i] = input[i * kChannels + c];
+            }
+            PolyphaseResampler mono;
+            mono.Configure(ratio.input_sample_rate, ratio.output_sample_rate, 1);
+            auto mono_output = Resample(mono, channel, frame_frames, 1);
+            TEST_ASSERT_EQUAL(output.size() / kChannels, mono_output.size());
+            for (size_t i = 0; i < mono_output.size(); i++) {
+                TEST_ASSERT_EQUAL(mono_output[i], output[i * kChannels + c]);
+            }
+        }
+    }
+}
+
+int main() {
+    RUN_TEST(test_supported_ratios);
+    RUN_TEST(test_sine_snr);
+    RUN_TEST(test_streaming_is_block_size_independent);
+    RUN_TEST(test_interleaved_matches_per_channel);
+    return TEST_EXIT();
+}
@@ -0,0 +1,167 @@
+#include "host_test.h"
+#include "protocols/protocol.h"
+
+#include <cstdlib>
+#include <new>
+#include <string>
+#include <vector>
+
+// 替换全局 operator new，统计被测代码实际发生的堆分配次数
+static size_t allocations = 0;
+
+void* operator new(size_t size) {
+    allocations++;
+    void* p = malloc(size == 0 ? 1 : size);
+    if (p == nullptr) {
+        throw std::bad_alloc();
+    }
+    return p;
+}
+
+void operator delete(void* p) noexcept {
+    free(p);
+}
+
+void operator delete(void* p, size_t) noexcept {
+    free(p);
+}
+
+// 只记录发送内容的协议，hello 通过与 WebSocket、MQTT+UDP 相同的方式生成
+class CaptureProtocol : public Protocol {
+public:
+    std::string last_text;
+
+    explicit CaptureProtocol(const std::string& session_id) {
+        session_id_ = session_id;
+        last_text.reserve(1024);
+    }
+
+    void Start() override {}
+    bool OpenAudioChannel() override { return true; }
+    void CloseAudioChannel() override {}
+    bool IsAudioChannelOpened() const override { return true; }
+    void SendAudio(const std::vector<uint8_t>& data, int64_t capture_time_us) override {}
+
+    void SendHello(int version, const char* transport) {
+        SendMessage([version, transport](JsonWriter& writer) {
+            WriteHello(writer, version, transport, 60);
+        });
+    }
+
+protected:
+    void SendText(const std::string& text) override { last_text = text; }
+};
+
+// 会话 ID 与唤醒词都带上需要转义的字符，直接拼接字符串时会生成非法 JSON
+static const std::string kSessionId = "8f3b\"2c1a\\";
+static const std::string kWakeWord = "你好\"小智\"\n";
+
+// 第一次发送让复用的缓冲区扩容到位，第二次发送必须不再分配内存
+template <typename Send>
+static bool SendTwice(Send send, JsonObject& root, const std::string& text) {
+    send();
+    size_t before = allocations;
+    send();
+    if (allocations != before) {
+        fprintf(stderr, "%zu allocations in steady state: %s\n", allocations - before, text.c_str());
+        return false;
+    }
+    return root.Parse(text);
+}
+
+static void test_hello_messages() {
+    CaptureProtocol protocol(kSessionId);
+    const struct {
+        int version;
+        const char* transport;
+    } cases[] = {{4, "websocket"}, {1, "websocket"}, {3, "udp"}};
+
+    for (auto& c : cases) {
+        JsonObject root;
+        TEST_ASSERT(SendTwice([&]() { protocol.SendHello(c.version, c.transport); }, root, protocol.last_text));
+        TEST_ASSERT(root["type"].Equals("hello"));
+        TEST_ASSERT_EQUAL(c.version, root["version"].ToInt());
+        TEST_ASSERT(root["transport"].Equals(c.transport));
+        TEST_ASSERT_EQUAL(JsonValue::kMissing, root["session_id"].type);
+
+        JsonObject audio_params;
+        TEST_ASSERT(audio_params.Parse(root["audio_params"].raw));
+        TEST_ASSERT(audio_params["format"].Equals("opus"));
+        TEST_ASSERT_EQUAL(16000, audio_params["sample_rate"].ToInt());
+        TEST_ASSERT_EQUAL(1, audio_params["channels"].ToInt());
+        TEST_ASSERT_EQUAL(60, audio_params["frame_duration"].ToInt());
+    }
+}
+
+static void test_listen_messages() {
+    CaptureProtocol protocol(kSessionId);
+    JsonObject root;
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendWakeWordDetected(kWakeWord); }, root, protocol.last_text));
+    TEST_ASSERT(root["session_id"].ToString() == kSessionId);
+    TEST_ASSERT(root["type"].Equals("listen"));
+    TEST_ASSERT(root["state"].Equals("detect"));
+    TEST_ASSERT(root["text"].ToString() == kWakeWord);
+
+    const struct {
+        ListeningMode mode;
+        const char* name;
+    } modes[] = {{kListeningModeAutoStop, "auto"}, {kListeningModeManualStop, "manual"}, {kListeningModeAlwaysOn, "realtime"}};
+    for (auto& m : modes) {
+        TEST_ASSERT(SendTwice([&]() { protocol.SendStartListening(m.mode); }, root, protocol.last_text));
+        TEST_ASSERT(root["session_id"].ToString() == kSessionId);
+        TEST_ASSERT(root["state"].Equals("start"));
+        TEST_ASSERT(root["mode"].Equals(m.name));
+    }
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendStopListening(); }, root, protocol.last_text));
+    TEST_ASSERT(root["type"].Equals("listen"));
+    TEST_ASSERT(root["state"].Equals("stop"));
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendSilenceMarker(); }, root, protocol.last_text));
+    TEST_ASSERT(root["type"].Equals("listen"));
+    TEST_ASSERT(root["state"].Equals("silence"));
+}
+
+static void test_abort_messages() {
+    CaptureProtocol protocol(kSessionId);
+    JsonObject root;
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendAbortSpeaking(kAbortReasonNone); }, root, protocol.last_text));
+    TEST_ASSERT(root["session_id"].ToString() == kSessionId);
+    TEST_ASSERT(root["type"].Equals("abort"));
+    TEST_ASSERT_EQUAL(JsonValue::kMissing, root["reason"].type);
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendAbortSpeaking(kAbortReasonWakeWordDetected); }, root, protocol.last_text));
+    TEST_ASSERT(root["reason"].Equals("wake_word_detected"));
+}
+
+// IoT 描述符、状态与时延统计是已经生成好的 JSON，按原样嵌入
+static void test_raw_payload_messages() {
+    CaptureProtocol protocol(kSessionId);
+    const std::string descriptors = R"([{"name":"Speaker","properties":{}}])";
+    const std::string states = R"([{"name":"Speaker","state":{"volume":70}}])";
+    const std::string report = R"({"capture":{"avg_us":120}})";
+    JsonObject root;
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendIotDescriptors(descriptors); }, root, protocol.last_text));
+    TEST_ASSERT(root["session_id"].ToString() == kSessionId);
+    TEST_ASSERT(root["type"].Equals("iot"));
+    TEST_ASSERT(root["descriptors"].raw == descriptors);
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendIotStates(states); }, root, protocol.last_text));
+    TEST_ASSERT(root["type"].Equals("iot"));
+    TEST_ASSERT(root["states"].raw == states);
+
+    TEST_ASSERT(SendTwice([&]() { protocol.SendLatencyReport(report); }, root, protocol.last_text));
+    TEST_ASSERT(root["type"].Equals("latency"));
+    TEST_ASSERT(root["stages"].raw == report);
+}
+
+int main() {
+    RUN_TEST(test_hello_messages);
+    RUN_TEST(test_listen_messages);
+    RUN_TEST(test_abort_messages);
+    RUN_TEST(test_raw_payload_messages);
+    return TEST_EXIT();
+}
@@ -0,0 +1,133 @@
+#include "host_test.h"
+#include "audio_codecs/tdm_channel_map.h"
+
+#include <vector>
+
+// ES7210 的时隙布局：时隙 0 为第一路麦克风，时隙 1 为回采参考，时隙 2、3 为其余麦克风
+static const int kMicSlots[] = {0, 2, 3};
+static const int kReferenceSlot = 1;
+
+static TdmChannelMap Map(int mics, bool reference) {
+    TdmChannelMap map;
+    map.Configure(kMicSlots, 3, mics, reference ? kReferenceSlot : -1);
+    return map;
+}
+
+// 按时隙升序生成交织的 TDM 读出数据，样本值为 时隙 * 1000 + 帧号
+static std::vector<int16_t> Interleave(const TdmChannelMap& map, int frames) {
+    std::vector<int16_t> data;
+    for (int f = 0; f < frames; f++) {
+        for (int i = 0; i < map.channels(); i++) {
+            data.push_back(map.read_slot(i) * 1000 + f);
+        }
+    }
+    return data;
+}
+
+// 重排后每帧应依次为 expected_slots 中各时隙的样本
+static void AssertFrames(const std::vector<int16_t>& data, const std::vector<int>& expected_slots, int frames) {
+    int channels = expected_slots.size();
+    for (int f = 0; f < frames; f++) {
+        for (int c = 0; c < channels; c++) {
+            TEST_ASSERT_EQUAL(expected_slots[c] * 1000 + f, data[f * channels + c]);
+        }
+    }
+}
+
+static void test_single_mic_without_reference() {
+    TdmChannelMap map = Map(1, false);
+    TEST_ASSERT_EQUAL(1, map.channels());
+    TEST_ASSERT_EQUAL(0, map.read_slot(0));
+    TEST_ASSERT(!map.needs_reorder());
+}
+
+static void test_single_mic_with_reference_keeps_order() {
+    // 时隙 0（麦克风）本来就在时隙 1（参考）之前，不需要重排
+    TdmChannelMap map = Map(1, true);
+    TEST_ASSERT_EQUAL(2, map.channels());
+    TEST_ASSERT_EQUAL(0, map.read_slot(0));
+    TEST_ASSERT_EQUAL(1, map.read_slot(1));
+    TEST_ASSERT(!map.needs_reorder());
+
+    std::vector<int16_t> data = Interleave(map, 8);
+    map.Reorder(data.data(), data.size());
+    AssertFrames(data, {0, 1}, 8);
+}
+
+static void test_two_mics_with_reference_moves_reference_last() {
+    // 读出顺序为 时隙 0、1、2，输出为 麦克风 0、麦克风 2、参考 1
+    TdmChannelMap map = Map(2, true);
+    TEST_ASSERT_EQUAL(2, map.mics());
+    TEST_ASSERT_EQUAL(3, map.channels());
+    TEST_ASSERT_EQUAL(0, map.read_slot(0));
+    TEST_ASSERT_EQUAL(1, map.read_slot(1));
+    TEST_ASSERT_EQUAL(2, map.read_slot(2));
+    TEST_ASSERT(map.needs_reorder());
+
+    std::vector<int16_t> data = Interleave(map, 16);
+    map.Reorder(data.data(), data.size());
+    AssertFrames(data, {0, 2, 1}, 16);
+}
+
+static void test_three_mics_with_reference() {
+    TdmChannelMap map = Map(3, true);
+    TEST_ASSERT_EQUAL(4, map.channels());
+    TEST_ASSERT(map.needs_reorder());
+
+    // 已知的交织输入：每帧依次为 时隙 0、1、2、3
+    std::vector<int16_t> data = {
+        0, 1000, 2000, 3000,
+        1, 1001, 2001, 3001,
+        2, 1002, 2002, 3002,
+    };
+    map.Reorder(data.data(), data.size());
+    std::vector<int16_t> expected = {
+        0, 2000, 3000, 1000,
+        1, 2001, 3001, 1001,
+        2, 2002, 3002, 1002,
+    };
+    TEST_ASSERT(data == expected);
+}
+
+static void test_mics_only_need_no_reorder() {
+    TdmChannelMap map = Map(3, false);
+    TEST_ASSERT_EQUAL(3, map.channels());
+    TEST_ASSERT_EQUAL(0, map.read_slot(0));
+    TEST_ASSERT_EQUAL(2, map.read_slot(1));
+    TEST_ASSERT_EQUAL(3, map.read_slot(2));
+    TEST_ASSERT(!map.needs_reorder());
+
+    std::vector<int16_t> data = Interleave(map, 4);
+    std::vector<int16_t> before = data;
+    map.Reorder(data.data(), data.size());
+    TEST_ASSERT(data == before);
+}
+
+static void test_mic_count_is_clamped() {
+    TEST_ASSERT_EQUAL(1, Map(0, true).mics());
+    TEST_ASSERT_EQUAL(3, Map(4, true).mics());
+    TEST_ASSERT_EQUAL(4, Map(4, true).channels());
+    TEST_ASSERT_EQUAL(3, Map(8, false).channels());
+}
+
+static void test_partial_tail_frame_untouched() {
+    TdmChannelMap map = Map(2, true);
+    std::vector<int16_t> data = Interleave(map, 2);
+    data.push_back(7);
+    data.push_back(8);
+    map.Reorder(data.data(), data.size());
+    AssertFrames(data, {0, 2, 1}, 2);
+    TEST_ASSERT_EQUAL(7, data[6]);
+    TEST_ASSERT_EQUAL(8, data[7]);
+}
+
+int main() {
+    RUN_TEST(test_single_mic_without_reference);
+    RUN_TEST(test_single_mic_with_reference_keeps_order);
+    RUN_TEST(test_two_mics_with_reference_moves_reference_last);
+    RUN_TEST(test_three_mics_with_reference);
+    RUN_TEST(test_mics_only_need_no_reorder);
+    RUN_TEST(test_mic_count_is_clamped);
+    RUN_TEST(test_partial_tail_frame_untouched);
+    return TEST_EXIT();
+}
@@ -0,0 +1,160 @@
+#include "host_test.h"
+#include "uplink_gate.h"
+
+#include <vector>
+
+// 1 kHz 采样率下 1 个样本即 1 ms：预录 50 ms，拖尾 30 ms，每帧 10 ms
+static const int kSampleRate = 1000;
+static const int kPrerollMs = 50;
+static const int kHangoverMs = 30;
+static const int kFrameSamples = 10;
+
+// 帧内每个样本都记为帧号，便于检查预录的内容和顺序
+static std::vector<int16_t> Frame(int index, int samples = kFrameSamples) {
+    return std::vector<int16_t>(samples, index);
+}
+
+static void Configure(UplinkGate& gate) {
+    gate.Configure(kSampleRate, kPrerollMs, kHangoverMs);
+    gate.Reset();
+}
+
+static void test_session_starts_open() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(false);
+    // 会话开头即使没有人声也要发送，直到拖尾耗尽
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(1)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(2)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionClose, gate.Process(Frame(3)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionGate, gate.Process(Frame(4)));
+
+    auto stats = gate.GetStats();
+    TEST_ASSERT_EQUAL(20, stats.passed_ms);
+    TEST_ASSERT_EQUAL(20, stats.gated_ms);
+    TEST_ASSERT_EQUAL(1, stats.closes);
+}
+
+static void test_voice_restarts_hangover() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(true);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(1)));
+    gate.SetVoiceActive(false);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(2)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(3)));
+    // 拖尾结束前再次检测到人声，静音计时从头开始
+    gate.SetVoiceActive(true);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(4)));
+    gate.SetVoiceActive(false);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(5)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(6)));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionClose, gate.Process(Frame(7)));
+    TEST_ASSERT_EQUAL(10, gate.GetStats().gated_ms);
+}
+
+static void test_open_sends_latest_preroll_first() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(false);
+    gate.Process(Frame(1));
+    gate.Process(Frame(2));
+    TEST_ASSERT_EQUAL(UplinkGate::kActionClose, gate.Process(Frame(3)));
+    for (int i = 4; i <= 10; i++) {
+        TEST_ASSERT_EQUAL(UplinkGate::kActionGate, gate.Process(Frame(i)));
+    }
+
+    gate.SetVoiceActive(true);
+    std::vector<int16_t> pcm = Frame(11);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionOpen, gate.Process(pcm));
+    gate.TakePreroll(pcm);
+
+    // 预录只保留最近 50 ms（第 6..10 帧），按时间顺序放在本帧之前
+    TEST_ASSERT_EQUAL(60, pcm.size());
+    for (int i = 0; i < 60; i++) {
+        TEST_ASSERT_EQUAL(6 + i / kFrameSamples, pcm[i]);
+    }
+
+    auto stats = gate.GetStats();
+    TEST_ASSERT_EQUAL(20 + 50 + 10, stats.passed_ms);
+    TEST_ASSERT_EQUAL(30, stats.gated_ms);
+    TEST_ASSERT_EQUAL(1, stats.closes);
+
+    // 预录取出后即清空，闸门保持打开
+    std::vector<int16_t> empty;
+    gate.TakePreroll(empty);
+    TEST_ASSERT_EQUAL(0, empty.size());
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(12)));
+}
+
+static void test_preroll_shorter_than_capacity() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(false);
+    gate.Process(Frame(1));
+    gate.Process(Frame(2));
+    gate.Process(Frame(3));
+
+    gate.SetVoiceActive(true);
+    std::vector<int16_t> pcm = Frame(4);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionOpen, gate.Process(pcm));
+    gate.TakePreroll(pcm);
+    TEST_ASSERT_EQUAL(20, pcm.size());
+    TEST_ASSERT_EQUAL(3, pcm[0]);
+    TEST_ASSERT_EQUAL(3, pcm[9]);
+    TEST_ASSERT_EQUAL(4, pcm[10]);
+}
+
+static void test_frame_longer_than_preroll_keeps_tail() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(false);
+    gate.Process(Frame(1, 30));
+    // 单帧 80 ms 超过预录容量，只保留最后 50 个样本
+    std::vector<int16_t> long_frame(80);
+    for (int i = 0; i < 80; i++) {
+        long_frame[i] = i;
+    }
+    TEST_ASSERT_EQUAL(UplinkGate::kActionGate, gate.Process(long_frame));
+
+    gate.SetVoiceActive(true);
+    std::vector<int16_t> pcm;
+    TEST_ASSERT_EQUAL(UplinkGate::kActionOpen, gate.Process(Frame(9)));
+    gate.TakePreroll(pcm);
+    TEST_ASSERT_EQUAL(50, pcm.size());
+    for (int i = 0; i < 50; i++) {
+        TEST_ASSERT_EQUAL(30 + i, pcm[i]);
+    }
+}
+
+static void test_reset_reopens_and_clears() {
+    UplinkGate gate;
+    Configure(gate);
+    gate.SetVoiceActive(false);
+    for (int i = 1; i <= 6; i++) {
+        gate.Process(Frame(i));
+    }
+    TEST_ASSERT_EQUAL(1, gate.GetStats().closes);
+
+    // 新的监听会话：闸门重新打开，之前的预录和统计都不保留
+    gate.Reset();
+    auto stats = gate.GetStats();
+    TEST_ASSERT_EQUAL(0, stats.passed_ms);
+    TEST_ASSERT_EQUAL(0, stats.gated_ms);
+    TEST_ASSERT_EQUAL(0, stats.closes);
+    TEST_ASSERT_EQUAL(UplinkGate::kActionPass, gate.Process(Frame(7)));
+
+    std::vector<int16_t> pcm;
+    gate.TakePreroll(pcm);
+    TEST_ASSERT_EQUAL(0, pcm.size());
+}
+
+int main() {
+    RUN_TEST(test_session_starts_open);
+    RUN_TEST(test_voice_restarts_hangover);
+    RUN_TEST(test_open_sends_latest_preroll_first);
+    RUN_TEST(test_preroll_shorter_than_capacity);
+    RUN_TEST(test_frame_longer_than_preroll_keeps_tail);
+    RUN_TEST(test_reset_reopens_and_clears);
+    return TEST_EXIT();
+}
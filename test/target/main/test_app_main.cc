@@ -0,0 +1,6 @@
+#include <unity.h>
+
+// 各测试文件中的 TEST_CASE 自动注册，这里只启动串口测试菜单
+extern "C" void app_main(void) {
+    unity_run_menu();
+}
@@ -0,0 +1,131 @@
+#include <unity.h>
+#include <esp_cpu.h>
+#include <esp_heap_caps.h>
+#include <esp_log.h>
+#include <cstring>
+
+#include "audio_kernels.h"
+
+#define TAG "TestAudioKernels"
+
+// 略多于 30ms 48kHz 双声道，帧数不是 8 的倍数，同时覆盖向量段与标量尾部
+static constexpr size_t kFrames = 1443;
+
+// 16 字节对齐的测试缓冲区，PIE 路径只在对齐时启用
+struct KernelBuffers {
+    int16_t* stereo;
+    int16_t* stereo_out;
+    int16_t* stereo_ref;
+    int16_t* left;
+    int16_t* right;
+    int16_t* left_ref;
+    int16_t* right_ref;
+    int32_t* wide;
+    int32_t* wide_out;
+    int32_t* wide_ref;
+    uint8_t* memory;
+
+    KernelBuffers() {
+        constexpr size_t kStereoBytes = (kFrames * 2 * sizeof(int16_t) + 15) & ~size_t(15);
+        constexpr size_t kMonoBytes = (kFrames * sizeof(int16_t) + 15) & ~size_t(15);
+        constexpr size_t kWideBytes = (kFrames * sizeof(int32_t) + 15) & ~size_t(15);
+        memory = static_cast<uint8_t*>(heap_caps_aligned_alloc(16, kStereoBytes * 3 + kMonoBytes * 4 + kWideBytes * 3,
+            MALLOC_CAP_INTERNAL | MALLOC_CAP_8BIT));
+        TEST_ASSERT_NOT_NULL(memory);
+        uint8_t* cursor = memory;
+        auto take = [&cursor](size_t bytes) {
+            auto p = cursor;
+            cursor += bytes;
+            return p;
+        };
+        stereo = reinterpret_cast<int16_t*>(take(kStereoBytes));
+        stereo_out = reinterpret_cast<int16_t*>(take(kStereoBytes));
+        stereo_ref = reinterpret_cast<int16_t*>(take(kStereoBytes));
+        left = reinterpret_cast<int16_t*>(take(kMonoBytes));
+        right = reinterpret_cast<int16_t*>(take(kMonoBytes));
+        left_ref = reinterpret_cast<int16_t*>(take(kMonoBytes));
+        right_ref = reinterpret_cast<int16_t*>(take(kMonoBytes));
+        wide = reinterpret_cast<int32_t*>(take(kWideBytes));
+        wide_out = reinterpret_cast<int32_t*>(take(kWideBytes));
+        wide_ref = reinterpret_cast<int32_t*>(take(kWideBytes));
+
+        // xorshift32 生成满量程数据，确保饱和分支都被覆盖
+        uint32_t seed = 0x2545F491;
+        auto next = [&seed]() {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            return seed;
+        };
+        for (size_t i = 0; i < kFrames * 2; i++) {
+            stereo[i] = static_cast<int16_t>(next());
+        }
+        for (size_t i = 0; i < kFrames; i++) {
+            wide[i] = static_cast<int32_t>(next());
+        }
+    }
+
+    ~KernelBuffers() {
+        heap_caps_free(memory);
+    }
+};
+
+static void LogCycles(const char* name, uint32_t cycles, size_t samples) {
+    ESP_LOGI(TAG, "%-14s %.2f cycles/sample", name, double(cycles) / samples);
+}
+
+TEST_CASE("Deinterleave and Interleave match reference", "[audio_kernels][bench]")
+{
+    KernelBuffers b;
+    uint32_t start = esp_cpu_get_cycle_count();
+    AudioKernels::Deinterleave(b.stereo, b.left, b.right, kFrames);
+    LogCycles("Deinterleave", esp_cpu_get_cycle_count() - start, kFrames * 2);
+    AudioKernels::DeinterleaveReference(b.stereo, b.left_ref, b.right_ref, kFrames);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.left_ref, b.left, kFrames);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.right_ref, b.right, kFrames);
+
+    start = esp_cpu_get_cycle_count();
+    AudioKernels::Interleave(b.left_ref, b.right_ref, b.stereo_out, kFrames);
+    LogCycles("Interleave", esp_cpu_get_cycle_count() - start, kFrames * 2);
+    AudioKernels::InterleaveReference(b.left_ref, b.right_ref, b.stereo_ref, kFrames);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.stereo_ref, b.stereo_out, kFrames * 2);
+}
+
+TEST_CASE("Int32ToInt16 and GainToInt32 match reference", "[audio_kernels][bench]")
+{
+    KernelBuffers b;
+    uint32_t start = esp_cpu_get_cycle_count();
+    AudioKernels::Int32ToInt16(b.wide, b.left, kFrames, 12);
+    LogCycles("Int32ToInt16", esp_cpu_get_cycle_count() - start, kFrames);
+    AudioKernels::Int32ToInt16Reference(b.wide, b.left_ref, kFrames, 12);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.left_ref, b.left, kFrames);
+
+    for (int32_t gain : {0, 12345, 65536}) {
+        start = esp_cpu_get_cycle_count();
+        AudioKernels::GainToInt32(b.stereo, b.wide_out, kFrames, gain);
+        LogCycles("GainToInt32", esp_cpu_get_cycle_count() - start, kFrames);
+        AudioKernels::GainToInt32Reference(b.stereo, b.wide_ref, kFrames, gain);
+        TEST_ASSERT_EQUAL_INT32_ARRAY(b.wide_ref, b.wide_out, kFrames);
+    }
+}
+
+TEST_CASE("Mix matches reference", "[audio_kernels][bench]")
+{
+    KernelBuffers b;
+    AudioKernels::DeinterleaveReference(b.stereo, b.left_ref, b.right_ref, kFrames);
+    uint32_t start = esp_cpu_get_cycle_count();
+    AudioKernels::Mix(b.left_ref, b.right_ref, b.left, kFrames);
+    LogCycles("Mix", esp_cpu_get_cycle_count() - start, kFrames);
+    AudioKernels::MixReference(b.left_ref, b.right_ref, b.right, kFrames);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.right, b.left, kFrames);
+}
+
+TEST_CASE("Unaligned buffers fall back to scalar path", "[audio_kernels]")
+{
+    KernelBuffers b;
+    // 偏移 2 字节破坏 16 字节对齐
+    AudioKernels::Deinterleave(b.stereo + 1, b.left + 1, b.right + 1, kFrames - 8);
+    AudioKernels::DeinterleaveReference(b.stereo + 1, b.left_ref + 1, b.right_ref + 1, kFrames - 8);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.left_ref + 1, b.left + 1, kFrames - 8);
+    TEST_ASSERT_EQUAL_INT16_ARRAY(b.right_ref + 1, b.right + 1, kFrames - 8);
+}
@@ -0,0 +1,83 @@
+#include <unity.h>
+#include <esp_log.h>
+#include <esp_timer.h>
+#include <cJSON.h>
+#include <cstdlib>
+#include <cstring>
+
+#include "json_scanner.h"
+
+#define TAG "TestJsonScanner"
+
+namespace {
+
+// cJSON 的内存钩子，统计解析期间的分配次数与字节数
+size_t alloc_count = 0;
+size_t alloc_bytes = 0;
+
+void* CountingMalloc(size_t size) {
+    alloc_count++;
+    alloc_bytes += size;
+    return malloc(size);
+}
+
+} // namespace
+
+// 一轮典型的语音回复：识别结果、表情、若干句 TTS（中文按 \uXXXX 转义）、结束
+// 两种方式都只做解析和分发需要的字段查找，不复制字符串；解析的正确性在 test/host 中校验
+TEST_CASE("JSON scanner vs cJSON per server message", "[json][bench]")
+{
+    static const char* const kMessages[] = {
+        R"({"type":"tts","state":"start","sample_rate":24000,"session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"stt","text":"\u4eca\u5929\u5929\u6c14\u600e\u4e48\u6837","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"llm","text":"😊","emotion":"happy","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"tts","state":"sentence_start","text":"\u4eca\u5929\u662f\u6674\u5929\uff0c\u6c14\u6e29\u4e8c\u5341\u4e94\u5ea6\u3002","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"tts","state":"sentence_end","text":"\u4eca\u5929\u662f\u6674\u5929\uff0c\u6c14\u6e29\u4e8c\u5341\u4e94\u5ea6\u3002","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"tts","state":"sentence_start","text":"\u9002\u5408\u51fa\u95e8\u6563\u6b65\u3002","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"tts","state":"sentence_end","text":"\u9002\u5408\u51fa\u95e8\u6563\u6b65\u3002","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+        R"({"type":"tts","state":"stop","session_id":"8f3b2c1a-5d7e-4c09-a1b2-3c4d5e6f7a8b"})",
+    };
+    constexpr int kRounds = 200;
+    constexpr int kMessageCount = sizeof(kMessages) / sizeof(kMessages[0]);
+    size_t lengths[kMessageCount];
+    for (int i = 0; i < kMessageCount; i++) {
+        lengths[i] = strlen(kMessages[i]);
+    }
+
+    int cjson_matched = 0;
+    cJSON_Hooks hooks = { CountingMalloc, free };
+    cJSON_InitHooks(&hooks);
+    alloc_count = 0;
+    alloc_bytes = 0;
+    int64_t start = esp_timer_get_time();
+    for (int r = 0; r < kRounds; r++) {
+        for (int i = 0; i < kMessageCount; i++) {
+            auto root = cJSON_ParseWithLength(kMessages[i], lengths[i]);
+            auto type = cJSON_GetObjectItem(root, "type");
+            auto state = cJSON_GetObjectItem(root, "state");
+            auto text = cJSON_GetObjectItem(root, "text");
+            cjson_matched += cJSON_IsString(type) && strcmp(type->valuestring, "tts") == 0 && cJSON_IsString(state) && text != nullptr;
+            cJSON_Delete(root);
+        }
+    }
+    int64_t cjson_us = esp_timer_get_time() - start;
+    cJSON_InitHooks(nullptr);
+
+    int scanner_matched = 0;
+    start = esp_timer_get_time();
+    for (int r = 0; r < kRounds; r++) {
+        for (int i = 0; i < kMessageCount; i++) {
+            JsonObject root;
+            TEST_ASSERT_TRUE(root.Parse(std::string_view(kMessages[i], lengths[i])));
+            scanner_matched += root["type"].Equals("tts") && root["state"].IsString() && root["text"].type != JsonValue::kMissing;
+        }
+    }
+    int64_t scanner_us = esp_timer_get_time() - start;
+
+    const int total = kRounds * kMessageCount;
+    ESP_LOGI(TAG, "cJSON:   %lld ns/message, %zu allocations (%zu bytes) per message",
+        cjson_us * 1000 / total, alloc_count / total, alloc_bytes / total);
+    ESP_LOGI(TAG, "Scanner: %lld ns/message, 0 allocations, %zu bytes on stack",
+        scanner_us * 1000 / total, sizeof(JsonObject));
+    TEST_ASSERT_EQUAL(cjson_matched, scanner_matched);
+}
@@ -0,0 +1,44 @@
+#include <unity.h>
+#include <esp_cpu.h>
+#include <esp_log.h>
+#include <cmath>
+#include <vector>
+
+#include "polyphase_resampler.h"
+
+#define TAG "TestResampler"
+
+// 每种比例按 30ms 一帧处理 1kHz 正弦，输出每帧的 CPU 周期数
+// 信噪比与多声道一致性在 test/host 中校验，这里只测设备上的耗时
+TEST_CASE("Polyphase resampler cycles per 30 ms frame", "[resampler][bench]")
+{
+    constexpr int kFrameMs = 30;
+    constexpr int kFrames = 20;
+    const int ratios[][2] = {{24000, 16000}, {48000, 16000}, {16000, 24000}, {16000, 44100}};
+
+    for (auto& ratio : ratios) {
+        for (int channels : {1, 2}) {
+            PolyphaseResampler resampler;
+            TEST_ASSERT_TRUE(resampler.Configure(ratio[0], ratio[1], channels));
+            size_t frame_frames = ratio[0] / 1000 * kFrameMs;
+            std::vector<int16_t> input(frame_frames * channels);
+            for (size_t i = 0; i < frame_frames; i++) {
+                for (int c = 0; c < channels; c++) {
+                    input[i * channels + c] = (int16_t)lround(16384.0 * sin(2 * M_PI * 1000.0 * i / ratio[0]));
+                }
+            }
+            std::vector<int16_t> output((resampler.GetOutputFrames(frame_frames) + 1) * channels);
+
+            uint32_t cycles = 0;
+            for (int f = 0; f < kFrames; f++) {
+                size_t expected = resampler.GetOutputFrames(frame_frames);
+                uint32_t start = esp_cpu_get_cycle_count();
+                size_t produced = resampler.Process(input.data(), frame_frames, output.data());
+                cycles += esp_cpu_get_cycle_count() - start;
+                TEST_ASSERT_EQUAL(expected, produced);
+            }
+            ESP_LOGI(TAG, "%5d -> %5d Hz, %d ch: %lu cycles per %d ms frame",
+                ratio[0], ratio[1], channels, cycles / kFrames, kFrameMs);
+        }
+    }
+}